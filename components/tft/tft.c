@@ -129,6 +129,10 @@ typedef struct {
 
 static dispWin_t dispWinTemp;
 
+// Optional additional clip area (absolute screen coordinates), applied on top of 'dispWin'
+static dispWin_t paintClip;
+static uint8_t paintClipSet = 0;
+
 static uint8_t *userfont = NULL;
 static int TFT_OFFSET = 0;
 static propFont	fontChar;
@@ -154,11 +158,39 @@ int TFT_compare_colors(color_t c1, color_t c2)
 	return 0;
 }
 
+// Clip the area x1,y1 - x2,y2 (inclusive) to the paint clip area, if set
+// Returns 0 if nothing of the area remains
+//----------------------------------------------------------------
+static int _paint_clip(int *x1, int *y1, int *x2, int *y2) {
+	if (paintClipSet) {
+		if (*x1 < paintClip.x1) *x1 = paintClip.x1;
+		if (*y1 < paintClip.y1) *y1 = paintClip.y1;
+		if (*x2 > paintClip.x2) *x2 = paintClip.x2;
+		if (*y2 > paintClip.y2) *y2 = paintClip.y2;
+	}
+	return (*x1 <= *x2) && (*y1 <= *y2);
+}
+
+// Returns 1 if the area at x,y of size w,h lies entirely within the paint clip area (or none is set)
+//-------------------------------------------------------
+static int _paint_clip_contains(int x, int y, int w, int h) {
+	return (!paintClipSet) || ((x >= paintClip.x1) && (y >= paintClip.y1)
+			&& ((x + w - 1) <= paintClip.x2) && ((y + h - 1) <= paintClip.y2));
+}
+
+// Push a rectangle of a single color, clipped to the paint clip area
+//----------------------------------------------------------------------------
+static void _pushColorRepClipped(int x1, int y1, int x2, int y2, color_t color) {
+	if (!_paint_clip(&x1, &y1, &x2, &y2)) return;
+	TFT_pushColorRep(x1, y1, x2, y2, color, (uint32_t)((x2 - x1 + 1) * (y2 - y1 + 1)));
+}
+
 // draw color pixel on screen
 //------------------------------------------------------------------------
 static void _drawPixel(int16_t x, int16_t y, color_t color, uint8_t sel) {
 
 	if ((x < dispWin.x1) || (y < dispWin.y1) || (x > dispWin.x2) || (y > dispWin.y2)) return;
+	if ((paintClipSet) && ((x < paintClip.x1) || (y < paintClip.y1) || (x > paintClip.x2) || (y > paintClip.y2))) return;
 	drawPixel(x, y, color, sel);
 }
 
@@ -187,7 +219,7 @@ static void _drawFastVLine(int16_t x, int16_t y, int16_t h, color_t color) {
 	if (h < 0) h = 0;
 	if ((y + h) > (dispWin.y2+1)) h = dispWin.y2 - y + 1;
 	if (h == 0) h = 1;
-	TFT_pushColorRep(x, y, x, y+h-1, color, (uint32_t)h);
+	_pushColorRepClipped(x, y, x, y+h-1, color);
 }
 
 //--------------------------------------------------------------------------
@@ -202,7 +234,7 @@ static void _drawFastHLine(int16_t x, int16_t y, int16_t w, color_t color) {
 	if ((x + w) > (dispWin.x2+1)) w = dispWin.x2 - x + 1;
 	if (w == 0) w = 1;
 
-	TFT_pushColorRep(x, y, x+w-1, y, color, (uint32_t)w);
+	_pushColorRepClipped(x, y, x+w-1, y, color);
 }
 
 //======================================================================
@@ -304,7 +336,7 @@ static void _fillRect(int16_t x, int16_t y, int16_t w, int16_t h, color_t color)
 	if ((y + h) > (dispWin.y2+1)) h = dispWin.y2 - y + 1;
 	if (w == 0) w = 1;
 	if (h == 0) h = 1;
-	TFT_pushColorRep(x, y, x+w-1, y+h-1, color, (uint32_t)(h*w));
+	_pushColorRepClipped(x, y, x+w-1, y+h-1, color);
 }
 
 //============================================================================
@@ -1509,6 +1541,8 @@ void TFT_setFont(uint8_t font, const char *font_file)
   }
   else {
 	  if (font == USER_FONT) {
+		  // a user font may be reloaded at the same address
+		  _glyph_cache_invalidate();
 		  if (load_file_font(font_file, 0) != 0) cfont.font = tft_DefaultFont;
 		  else cfont.font = userfont;
 	  }
@@ -1563,6 +1597,203 @@ void TFT_setFont(uint8_t font, const char *font_file)
 // Character visible pixels rectangle is (xOffset, yOffset) (xOffset+Width-1, yOffset+Height-1)
 //---------------------------------------------------------------------------------------------
 
+// ==== Glyph cache & text strip ===========================================================
+// Opaque proportional font glyphs are rendered once for a given font, fg/bg colour pair and
+// grayscale mode, and kept in a (direct-mapped) glyph cache.  When printing, consecutive glyphs on a line
+// are copied into a DMA-capable text strip which is sent to the display in one transaction,
+// rather than allocating, decoding and sending each character individually.
+// ========================================================================================
+#define GLYPH_CACHE_SLOTS 64
+#define GLYPH_CACHE_MAX_BYTES (16 * 1024)
+#define TEXT_STRIP_MAX_PIXELS 1536
+
+typedef struct {
+	const uint8_t *font;
+	color_t fg;
+	color_t bg;
+	uint8_t gray_scale;		// grayscale mode the glyph was rendered in
+	uint8_t charCode;
+	uint8_t width;			// glyph cell width
+	uint8_t height;			// glyph cell height (font height)
+	uint16_t capacity;		// allocated pixels
+	disp_pixel_t *pixels;	// in display pixel format
+} glyph_cache_entry_t;
+
+typedef struct {
+	disp_pixel_t *buf;		// DMA capable, TEXT_STRIP_MAX_PIXELS
+	int x, y;				// display position of the strip
+	int width, height;		// used pixels
+	int stride;				// row length in buf
+} text_strip_t;
+
+static glyph_cache_entry_t glyph_cache[GLYPH_CACHE_SLOTS];
+static uint32_t glyph_cache_bytes = 0;
+static text_strip_t text_strip;
+
+static inline uint32_t _color_key(color_t color) {
+	return ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | color.b;
+}
+
+static inline int _same_color(color_t a, color_t b) {
+	return (a.r == b.r) && (a.g == b.g) && (a.b == b.b);
+}
+
+// Invalidate all cached glyphs (but keep the buffers for reuse)
+//-----------------------------------
+static void _glyph_cache_invalidate() {
+	for (int n = 0; n < GLYPH_CACHE_SLOTS; n++) {
+		glyph_cache[n].font = NULL;
+	}
+}
+
+// Render the glyph in 'fontChar' into 'buf' (row length 'stride') with the current colours
+//--------------------------------------------------------------------------------
+static void _render_glyph(disp_pixel_t *buf, int stride, int char_width, int height) {
+	uint8_t ch = 0;
+	uint8_t mask = 0x80;
+	uint16_t dataPtr = fontChar.dataPtr;
+	const disp_pixel_t fg = color_to_pixel(_fg);
+	const disp_pixel_t bg = color_to_pixel(_bg);
+
+	// fill with background color
+	for (int j = 0; j < height; j++) {
+		for (int i = 0; i < char_width; i++) {
+			buf[(j * stride) + i] = bg;
+		}
+	}
+	// set character pixels to foreground color
+	for (int j = 0; j < fontChar.height; j++) {
+		for (int i = 0; i < fontChar.width; i++) {
+			if (((i + (j*fontChar.width)) % 8) == 0) {
+				mask = 0x80;
+				ch = cfont.font[dataPtr++];
+			}
+			if ((ch & mask) != 0) {
+				buf[((j + fontChar.adjYOffset) * stride) + fontChar.xOffset + i] = fg;
+			}
+			mask >>= 1;
+		}
+	}
+}
+
+// Get the glyph in 'fontChar' rendered with the current colours (and grayscale mode), from the
+// cache if present.  Returns NULL if the glyph cannot be cached.
+//-------------------------------------------------------------------
+static const glyph_cache_entry_t *_get_cached_glyph(int char_width) {
+	uint32_t h = ((uintptr_t)cfont.font >> 2) ^ (fontChar.charCode * 0x9E3779B1);
+	h ^= _color_key(_fg) * 0x85EBCA6B;
+	h ^= _color_key(_bg) * 0xC2B2AE35;
+	h ^= gray_scale ? 0x27D4EB2F : 0;
+	glyph_cache_entry_t *glyph = &glyph_cache[(h ^ (h >> 16)) % GLYPH_CACHE_SLOTS];
+
+	if ((glyph->font == cfont.font) && (glyph->charCode == fontChar.charCode) && (glyph->height == cfont.y_size)
+			&& _same_color(glyph->fg, _fg) && _same_color(glyph->bg, _bg) && (glyph->gray_scale == gray_scale)) {
+		return glyph;
+	}
+
+	// Miss - (re)use the slot, growing its buffer if required and within budget
+	const uint32_t len = char_width * cfont.y_size;
+	if ((char_width > 0xFF) || (cfont.y_size > 0xFF)) return NULL;
+	if (len > glyph->capacity) {
+		const uint32_t extra = (len - glyph->capacity) * sizeof(disp_pixel_t);
+		if ((glyph_cache_bytes + extra) > GLYPH_CACHE_MAX_BYTES) return NULL;
+		disp_pixel_t *pixels = heap_caps_realloc(glyph->pixels, len * sizeof(disp_pixel_t), MALLOC_CAP_8BIT);
+		if (pixels == NULL) return NULL;
+		glyph->pixels = pixels;
+		glyph->capacity = len;
+		glyph_cache_bytes += extra;
+	}
+
+	_render_glyph(glyph->pixels, char_width, char_width, cfont.y_size);
+	glyph->font = cfont.font;
+	glyph->charCode = fontChar.charCode;
+	glyph->fg = _fg;
+	glyph->bg = _bg;
+	glyph->gray_scale = gray_scale;
+	glyph->width = char_width;
+	glyph->height = cfont.y_size;
+	return glyph;
+}
+
+// Send any pending text strip to the display
+//-----------------------------
+static void _text_strip_flush() {
+	if (text_strip.width == 0) return;
+
+	// clip to the paint clip area
+	int x1 = text_strip.x, y1 = text_strip.y;
+	int x2 = text_strip.x + text_strip.width - 1, y2 = text_strip.y + text_strip.height - 1;
+	if (!_paint_clip(&x1, &y1, &x2, &y2)) {
+		text_strip.width = 0;
+		return;
+	}
+
+	// compact the (clipped) rows if the strip was not filled
+	const int ncols = x2 - x1 + 1;
+	const int nrows = y2 - y1 + 1;
+	if ((ncols < text_strip.stride) || (y1 > text_strip.y)) {
+		for (int j = 0; j < nrows; j++) {
+			memmove(text_strip.buf + (j * ncols),
+					text_strip.buf + ((y1 - text_strip.y + j) * text_strip.stride) + (x1 - text_strip.x),
+					ncols * sizeof(disp_pixel_t));
+		}
+	}
+
+	// send to display in one transaction
+	disp_select();
+	send_pixels(x1, y1, x2, y2, ncols * nrows, text_strip.buf);
+	disp_deselect();
+	text_strip.width = 0;
+}
+
+// Add the glyph in 'fontChar' at x,y to the text strip, flushing the strip first if the glyph
+// does not directly follow the glyphs already in it.  Returns 0 if the glyph cannot be stripped.
+//---------------------------------------------------------
+static int _text_strip_add(int x, int y, int char_width) {
+	const int height = cfont.y_size;
+	if ((char_width * height) > TEXT_STRIP_MAX_PIXELS) return 0;
+
+	if (text_strip.buf == NULL) {
+		text_strip.buf = heap_caps_malloc(TEXT_STRIP_MAX_PIXELS * sizeof(disp_pixel_t), MALLOC_CAP_DMA);
+		if (text_strip.buf == NULL) return 0;
+	}
+
+	// A glyph may directly follow the last, or follow it after a (single pixel) gap
+	int gap = x - (text_strip.x + text_strip.width);
+	if ((text_strip.width == 0) || (y != text_strip.y) || (height != text_strip.height)
+			|| (gap < 0) || (gap > 1) || ((text_strip.width + gap + char_width) > text_strip.stride)) {
+		_text_strip_flush();
+		text_strip.x = x;
+		text_strip.y = y;
+		text_strip.height = height;
+		text_strip.stride = TEXT_STRIP_MAX_PIXELS / height;
+		gap = 0;
+	}
+
+	disp_pixel_t *dest = text_strip.buf + text_strip.width;
+	if (gap) {
+		const disp_pixel_t bg = color_to_pixel(_bg);
+		for (int j = 0; j < height; j++) {
+			dest[j * text_strip.stride] = bg;
+		}
+		dest += gap;
+	}
+
+	const glyph_cache_entry_t *glyph = _get_cached_glyph(char_width);
+	if (glyph) {
+		for (int j = 0; j < height; j++) {
+			memcpy(dest + (j * text_strip.stride), glyph->pixels + (j * char_width), char_width * sizeof(disp_pixel_t));
+		}
+	}
+	else {
+		// not cacheable, render directly into the strip
+		_render_glyph(dest, text_strip.stride, char_width, height);
+	}
+	text_strip.width += gap + char_width;
+
+	return 1;
+}
+
 // print non-rotated proportional character
 // character is already in fontChar
 //----------------------------------------------
@@ -1572,7 +1803,13 @@ static int printProportionalChar(int x, int y) {
 
 	char_width = ((fontChar.width > fontChar.xDelta) ? fontChar.width : fontChar.xDelta);
 
-	if ((font_buffered_char) && (!font_transparent)) {
+	// NOTE: the text strip is not used for grayscale, as sending the data converts it in place
+	if ((font_buffered_char) && (!font_transparent) && (!gray_scale)) {
+		if (_text_strip_add(x, y, char_width)) return char_width;
+	}
+
+	// NOTE: glyphs only partly within the paint clip area are drawn pixel by pixel, below
+	if ((font_buffered_char) && (!font_transparent) && (_paint_clip_contains(x, y, char_width, cfont.y_size))) {
 		int len, bufPos;
 
 		// === buffer Glyph data for faster sending ===
@@ -1660,7 +1897,7 @@ static void printChar(uint8_t c, int x, int y) {
 	// get character position in buffer
 	temp = ((c-cfont.offset)*((fz)*cfont.y_size))+4;
 
-	if ((font_buffered_char) && (!font_transparent)) {
+	if ((font_buffered_char) && (!font_transparent) && (_paint_clip_contains(x, y, cfont.x_size, cfont.y_size))) {
 		// === buffer Glyph data for faster sending ===
 		len = cfont.x_size * cfont.y_size;
 		color_t *color_line = heap_caps_malloc(len*3, MALLOC_CAP_DMA);
@@ -1815,6 +2052,46 @@ int TFT_getStringWidth(const char* str)
 	return strWidth;
 }
 
+// Render a single line string of proportional font characters, with the current font and
+// colours, into the offscreen pixel buffer 'buf' of 'width' x font height pixels.
+// If 'char_x' is passed it is set to the x position of each character in the buffer (and
+// the string width at the end).  Returns the rendered string width, or -1 if not supported.
+// Passing 'buf' as NULL just returns the width required.
+//========================================================================================
+int TFT_render_string(const char *st, disp_pixel_t *buf, int width, uint16_t *char_x)
+{
+	// Only non-rotated proportional fonts are supported
+	if ((cfont.bitmap != 1) || (cfont.x_size != 0) || (font_rotate != 0)) return -1;
+
+	const disp_pixel_t bg = color_to_pixel(_bg);
+	const int height = cfont.y_size;
+	int x = 0;
+	for (const char *ch = st; *ch != 0; ch++) {
+		if (char_x) *char_x++ = x;
+		if (!getCharPtr(*ch)) continue;
+
+		const int char_width = ((fontChar.width > fontChar.xDelta) ? fontChar.width : fontChar.xDelta);
+		if (buf && ((x + char_width) <= width)) {
+			const glyph_cache_entry_t *glyph = _get_cached_glyph(char_width);
+			for (int j = 0; j < height; j++) {
+				disp_pixel_t *dest = buf + (j * width) + x;
+				if (glyph) {
+					memcpy(dest, glyph->pixels + (j * char_width), char_width * sizeof(disp_pixel_t));
+				}
+				// gap before the next character
+				if ((x + char_width) < width) dest[char_width] = bg;
+			}
+			if (!glyph) _render_glyph(buf + x, width, char_width, height);
+		}
+		x += char_width + 1;
+	}
+
+	// No trailing gap
+	if (x > 0) --x;
+	if (char_x) *char_x = x;
+	return x;
+}
+
 //===============================================
 void TFT_clearStringRect(int x, int y, char *str)
 {
@@ -2008,6 +2285,7 @@ void TFT_print(const char *st, int x, int y) {
 		ch = st[i]; // get string character
 
 		if (ch == 0x0D) { // === '\r', erase to eol ====
+			_text_strip_flush();
 			if ((!font_transparent) && (font_rotate==0)) _fillRect(TFT_X, TFT_Y,  dispWin.x2+1-TFT_X, tmph, _bg);
 		}
 
@@ -2062,6 +2340,7 @@ void TFT_print(const char *st, int x, int y) {
 			}
 		}
 	}
+	_text_strip_flush();
 }
 
 // This is faster than printing with setclipwin
@@ -2126,6 +2405,7 @@ void TFT_print_in_area(const char *st, int x, int y, dispWin_t areaWin) {
 		ch = st[i]; // get string character
 
 		if (ch == 0x0D) { // === '\r', erase to eol ====
+			_text_strip_flush();
 			if ((!font_transparent) && (font_rotate==0)) _fillRect(TFT_X, TFT_Y,  areaWin.x2+1-TFT_X, tmph, _bg);
 		}
 
@@ -2180,6 +2460,7 @@ void TFT_print_in_area(const char *st, int x, int y, dispWin_t areaWin) {
 			}
 		}
 	}
+	_text_strip_flush();
 }
 
 // ================ Service functions ==========================================
@@ -2315,6 +2596,17 @@ void TFT_resetclipwin()
 	dispWin.y1 = 0;
 }
 
+//=============================================
+void TFT_setPaintClip(const dispWin_t *clip)
+{
+	if (clip) {
+		paintClip = *clip;
+		paintClipSet = 1;
+	} else {
+		paintClipSet = 0;
+	}
+}
+
 //==========================================================================
 void set_7seg_font_atrib(uint8_t l, uint8_t w, int outline, color_t color) {
 	if (cfont.bitmap != 2) return;
@@ -2886,6 +3178,10 @@ exit:
 	return err;
 }
 
+#define _16_TO_R(x) (0xFF - ((x >> 8) & 0b11111000))
+#define _16_TO_G(x) (0xFF - ((x >> 3) & 0b11111100))
+#define _16_TO_B(x) (0xFF - ((x << 3) & 0b11111111))
+
 static inline bool get_pixel(uint16_t x, uint16_t y, uint16_t width, const Icon *icon) {
     uint32_t val = ((uint32_t) width) * y + x;
 
@@ -2895,6 +3191,79 @@ static inline bool get_pixel(uint16_t x, uint16_t y, uint16_t width, const Icon
     return (icon->data[elem] >> bit) & 1;
 }
 
+// Pixels per chunk when sending images - two chunks are used, so one can be prepared while the other is sent
+#define IMAGE_CHUNK_PIXELS 1024
+
+// DMA capable buffer for the two chunks - allocated on first use and kept, as images (eg. scrolling
+// text) may be sent every frame.
+static disp_pixel_t *image_chunk_buf = NULL;
+
+// Callback to write a row of an image (clipped to the given columns) into 'dest', in display pixel format
+typedef void (*image_row_fn_t)(const void *ctx, uint32_t row, uint32_t col, uint32_t ncols, disp_pixel_t *dest);
+
+// Send an image at x,y of the given size to the display, several rows at a time.
+// The image is clipped to 'dispWin' and to any paint clip area.
+//-------------------------------------------------------------------------------------------------
+static void _send_image_rows(int x, int y, uint32_t width, uint32_t height, image_row_fn_t get_row, const void *ctx) {
+    // clipping
+    int x1 = max(x, dispWin.x1);
+    int y1 = max(y, dispWin.y1);
+    int x2 = min(x + (int)width - 1, dispWin.x2);
+    int y2 = min(y + (int)height - 1, dispWin.y2);
+    if (!_paint_clip(&x1, &y1, &x2, &y2)) return;
+
+    const uint32_t ncols = x2 - x1 + 1;
+    const uint32_t nrows = y2 - y1 + 1;
+    const uint32_t rows_per_chunk = max(1, min(nrows, IMAGE_CHUNK_PIXELS / ncols));
+
+    // NOTE: only a single row wider than a chunk needs a larger (temporary) buffer
+    disp_pixel_t *buf;
+    if ((rows_per_chunk * ncols) <= IMAGE_CHUNK_PIXELS) {
+        if (image_chunk_buf == NULL) {
+            image_chunk_buf = heap_caps_malloc(2 * IMAGE_CHUNK_PIXELS * sizeof(disp_pixel_t), MALLOC_CAP_DMA);
+            assert(image_chunk_buf);
+        }
+        buf = image_chunk_buf;
+    } else {
+        buf = heap_caps_malloc(2 * ncols * sizeof(disp_pixel_t), MALLOC_CAP_DMA);
+        assert(buf);
+    }
+    disp_pixel_t *chunk = buf;
+
+    disp_select();
+    for (uint32_t row = 0; row < nrows; row += rows_per_chunk) {
+        const uint32_t chunk_rows = min(rows_per_chunk, nrows - row);
+        for (uint32_t n = 0; n < chunk_rows; n++) {
+            get_row(ctx, (y1 - y) + row + n, x1 - x, ncols, chunk + (n * ncols));
+        }
+
+        // send this chunk (after the last has been sent), and prepare the next in the other half of the buffer
+        wait_trans_finish(0);
+        send_pixels(x1, y1 + row, x2, y1 + row + chunk_rows - 1, chunk_rows * ncols, chunk);
+        chunk = (chunk == buf) ? buf + (rows_per_chunk * ncols) : buf;
+    }
+    disp_deselect();
+    if (buf != image_chunk_buf) free(buf);
+}
+
+typedef struct {
+    const Icon *icon;
+    uint16_t start_x;
+    uint16_t start_y;
+    disp_pixel_t fg;
+    disp_pixel_t bg;
+} icon_rows_ctx_t;
+
+//-------------------------------------------------------------------------------------------------------
+static void _icon_row(const void *ctx, uint32_t row, uint32_t col, uint32_t ncols, disp_pixel_t *dest) {
+    const icon_rows_ctx_t *icon_ctx = (const icon_rows_ctx_t *)ctx;
+    const Icon *icon = icon_ctx->icon;
+    for (uint32_t i = 0; i < ncols; i++) {
+        dest[i] = get_pixel(icon_ctx->start_x + col + i, icon_ctx->start_y + row, icon->width, icon)
+            ? icon_ctx->fg : icon_ctx->bg;
+    }
+}
+
 int TFT_icon(const Icon *imgbuf, int x, int y, color_t color, dispWin_t area, const color_t* bg_color) {
     assert(imgbuf);
 
@@ -2925,25 +3294,73 @@ int TFT_icon(const Icon *imgbuf, int x, int y, color_t color, dispWin_t area, co
         y = y + area.y1;
     }
 
-    disp_select();
+    if (bg_color) {
+        // opaque - expand the icon bits into display pixels and send several rows at a time
+        const icon_rows_ctx_t ctx = {
+            .icon = imgbuf,
+            .start_x = start_x,
+            .start_y = start_y,
+            .fg = color_to_pixel(color),
+            .bg = color_to_pixel(*bg_color)
+        };
+        _send_image_rows(x, y, draw_width, draw_height, _icon_row, &ctx);
+        return 0;
+    }
+
+    // transparent - draw each horizontal run of set pixels
     for (uint16_t loop_y = 0; loop_y < draw_height; loop_y++) {
-        for (uint16_t loop_x = 0; loop_x < draw_width; loop_x++) {
-            if (get_pixel(loop_x + start_x, loop_y + start_y, width, imgbuf)) {
-                _drawPixel(x + loop_x, y + loop_y, color, false);
-            } else if (bg_color) {
-                _drawPixel(x + loop_x, y + loop_y, *bg_color, false);
+        uint16_t loop_x = 0;
+        while (loop_x < draw_width) {
+            if (!get_pixel(loop_x + start_x, loop_y + start_y, width, imgbuf)) {
+                ++loop_x;
+                continue;
+            }
+            const uint16_t run_start = loop_x;
+            while (loop_x < draw_width && get_pixel(loop_x + start_x, loop_y + start_y, width, imgbuf)) {
+                ++loop_x;
             }
+            _drawFastHLine(x + run_start, y + loop_y, loop_x - run_start, color);
         }
-
     }
-    disp_deselect();
 
     return 0;
 }
 
-#define _16_TO_R(x) (0xFF - ((x >> 8) & 0b11111000))
-#define _16_TO_G(x) (0xFF - ((x >> 3) & 0b11111100))
-#define _16_TO_B(x) (0xFF - ((x << 3) & 0b11111111))
+// Display pixel for each grayscale level, calculated once
+static disp_pixel_t picture_gray_pixels[256];
+static int8_t picture_gray_pixels_gray_scale = -1;
+
+//----------------------------------------------------------------------------------------------------------
+static void _picture_row(const void *ctx, uint32_t row, uint32_t col, uint32_t ncols, disp_pixel_t *dest) {
+    const Picture *imgbuf = (const Picture *)ctx;
+    const uint32_t start = (imgbuf->width * row) + col;
+
+    if (imgbuf->bytes_per_pixel == 1) { // Grayscale
+        for (uint32_t i = 0; i < ncols; i++) {
+            dest[i] = picture_gray_pixels[imgbuf->data_8[start + i]];
+        }
+    } else if (imgbuf->bytes_per_pixel == 2) { // RGB565
+        for (uint32_t i = 0; i < ncols; i++) {
+            const uint16_t rgb565 = imgbuf->data[start + i];
+#ifdef DISP_COLOR_BITS_16
+            if (!gray_scale) {
+                // sent as-is, except the display colours are inverted and big-endian
+                const uint16_t inverted = ~rgb565;
+                dest[i] = (inverted >> 8) | (inverted << 8);
+                continue;
+            }
+#endif
+            const color_t color = { _16_TO_R(rgb565), _16_TO_G(rgb565), _16_TO_B(rgb565) };
+            dest[i] = color_to_pixel(color);
+        }
+    } else { // RGB
+        for (uint32_t i = 0; i < ncols; i++) {
+            const uint8_t *rgb = imgbuf->data_8 + ((start + i) * 3);
+            const color_t color = { 0xFF - rgb[0], 0xFF - rgb[1], 0xFF - rgb[2] };
+            dest[i] = color_to_pixel(color);
+        }
+    }
+}
 
 int TFT_picture(const Picture *imgbuf, int x, int y, dispWin_t area) {
     assert(imgbuf);
@@ -2970,37 +3387,57 @@ int TFT_picture(const Picture *imgbuf, int x, int y, dispWin_t area) {
         y = y + area.y1;
     }
 
-    color_t *color_line = heap_caps_malloc(draw_width*3, MALLOC_CAP_DMA);
-    assert(color_line);
-    disp_select();
-
-    for (uint32_t loop_y = 0; loop_y < draw_height; loop_y++) {
-        for (uint32_t loop_x = 0; loop_x < draw_width; loop_x++) {
-            uint32_t index = width * loop_y + loop_x;
-
-            if (imgbuf->bytes_per_pixel == 1) { // Grayscale
-                color_line[loop_x].r = 0xFF - imgbuf->data_8[index];
-                color_line[loop_x].g = 0xFF - imgbuf->data_8[index];
-                color_line[loop_x].b = 0xFF - imgbuf->data_8[index];
-            } else if (imgbuf->bytes_per_pixel == 2) { // RGB565
-                color_line[loop_x].r = _16_TO_R(imgbuf->data[index]);
-                color_line[loop_x].g = _16_TO_G(imgbuf->data[index]);
-                color_line[loop_x].b = _16_TO_B(imgbuf->data[index]);
-            } else { // RGB
-                color_line[loop_x].r = 0xFF - imgbuf->data_8[index * 3];
-                color_line[loop_x].g = 0xFF - imgbuf->data_8[index * 3 + 1];
-                color_line[loop_x].b = 0xFF - imgbuf->data_8[index * 3 + 2];
-            }
+    if (imgbuf->bytes_per_pixel == 1 && picture_gray_pixels_gray_scale != gray_scale) {
+        for (uint32_t level = 0; level < 256; level++) {
+            const color_t color = { 0xFF - level, 0xFF - level, 0xFF - level };
+            picture_gray_pixels[level] = color_to_pixel(color);
         }
-
-        send_data(x, y + loop_y, x + draw_width, y + loop_y + 1, draw_width, color_line);
+        picture_gray_pixels_gray_scale = gray_scale;
     }
-    free(color_line);
-    disp_deselect();
+
+    _send_image_rows(x, y, draw_width, draw_height, _picture_row, imgbuf);
 
     return 0;
 }
 
+typedef struct {
+    const disp_pixel_t *src;
+    int src_width;
+    int src_x;
+    disp_pixel_t bg;
+} blit_rows_ctx_t;
+
+//-------------------------------------------------------------------------------------------------------
+static void _blit_row(const void *ctx, uint32_t row, uint32_t col, uint32_t ncols, disp_pixel_t *dest) {
+    const blit_rows_ctx_t *blit_ctx = (const blit_rows_ctx_t *)ctx;
+    const int src_col = blit_ctx->src_x + col;
+    const int ncopy = max(0, min((int)ncols, blit_ctx->src_width - src_col));
+    if (ncopy) {
+        memcpy(dest, blit_ctx->src + (row * blit_ctx->src_width) + src_col, ncopy * sizeof(disp_pixel_t));
+    }
+    for (uint32_t i = ncopy; i < ncols; i++) {
+        dest[i] = blit_ctx->bg;
+    }
+}
+
+// Copy a 'w' pixel wide window, starting at column 'src_x', of the offscreen pixel buffer 'src'
+// (eg. from TFT_render_string()) to the display at x,y.  Any part of the window beyond the right
+// edge of the buffer is filled with 'bg'.  The buffer need not be DMA capable (eg. may be in SPIRAM).
+//=======================================================================================================
+void TFT_blit(const disp_pixel_t *src, int src_width, int src_height, int src_x, int x, int y, int w, color_t bg)
+{
+    assert(src);
+    if ((w <= 0) || (src_height <= 0) || (src_x < 0)) return;
+
+    const blit_rows_ctx_t ctx = {
+        .src = src,
+        .src_width = src_width,
+        .src_x = src_x,
+        .bg = color_to_pixel(bg)
+    };
+    _send_image_rows(x, y, w, src_height, _blit_row, &ctx);
+}
+
 // ============= Touch panel functions =========================================
 
 #if USE_TOUCH == TOUCH_TYPE_XPT2046
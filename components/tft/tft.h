@@ -559,6 +559,18 @@ void TFT_saveClipWin();
 //------------------------
 void TFT_restoreClipWin();
 
+/*
+ * Set (or clear, if NULL) an additional clip area, in absolute screen coordinates
+ * While set, all writing to screen is also clipped to that area - unlike the clip window
+ * it does not change the origin of the x & y coordinates passed to the drawing functions.
+ *
+ * Params:
+ *		clip:	upper left & bottom right points (inclusive) of the area, or NULL
+ *
+ */
+//------------------------------------------
+void TFT_setPaintClip(const dispWin_t *clip);
+
 /*
  * Set the screen rotation
  * Also resets the clip window and clears the screen with current background color
@@ -606,6 +618,37 @@ int TFT_compare_colors(color_t c1, color_t c2);
 //--------------------------------
 int TFT_getStringWidth(const char* str);
 
+/*
+ * Render a single line string (proportional fonts only) with the current font and colours
+ * into an offscreen pixel buffer of 'width' x font height pixels.
+ * Optionally sets 'char_x' to the x position of each character (and the total width at the end).
+ *
+ * Params:
+ *         st:	string to render
+ *        buf:	pixel buffer, or NULL to just return the width required
+ *      width:	width of 'buf' in pixels
+ *     char_x:	optional array of strlen(st)+1 char positions
+ *
+ * Returns the string width in pixels, or -1 if the current font is not supported
+ */
+//-----------------------------------------------------------------------------
+int TFT_render_string(const char *st, disp_pixel_t *buf, int width, uint16_t *char_x);
+
+/*
+ * Copy a window of an offscreen pixel buffer to the display
+ *
+ * Params:
+ *          src:	offscreen pixel buffer (need not be DMA capable)
+ *    src_width:	width of the buffer
+ *   src_height:	height of the buffer (and of the window drawn)
+ *        src_x:	first buffer column to copy
+ *          x,y:	display position
+ *            w:	width of the window drawn
+ *           bg:	color used for any part of the window beyond the end of the buffer
+ */
+//------------------------------------------------------------------------------------------------------
+void TFT_blit(const disp_pixel_t *src, int src_width, int src_height, int src_x, int x, int y, int w, color_t bg);
+
 
 /*
  * Fills the rectangle occupied by string with current background color
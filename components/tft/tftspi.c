@@ -39,7 +39,7 @@ spi_lobo_device_handle_t ts_spi = NULL;
 // ====================================================
 
 
-static color_t *trans_cline = NULL;
+static disp_pixel_t *trans_cline = NULL;
 static uint8_t _dma_sending = 0;
 
 // RGB to GRAYSCALE constants
@@ -238,6 +238,19 @@ static color_t IRAM_ATTR color2gs(color_t color)
     return _color;
 }
 
+// Convert color to the pixel format sent to the display (converting to gray scale if set)
+//--------------------------------------------------------
+disp_pixel_t IRAM_ATTR color_to_pixel(color_t color)
+{
+	if (gray_scale) color = color2gs(color);
+#ifdef DISP_COLOR_BITS_16
+	const uint16_t rgb565 = ((uint16_t)(color.r & 0xF8) << 8) | ((uint16_t)(color.g & 0xFC) << 3) | (color.b >> 3);
+	return (rgb565 >> 8) | (rgb565 << 8);
+#else
+	return color;
+#endif
+}
+
 // Set display pixel at given coordinates to given color
 //------------------------------------------------------------------------
 void IRAM_ATTR drawPixel(int16_t x, int16_t y, color_t color, uint8_t sel)
@@ -250,8 +263,7 @@ void IRAM_ATTR drawPixel(int16_t x, int16_t y, color_t color, uint8_t sel)
 	else wait_trans_finish(1);
 
 	uint32_t wd = 0;
-    color_t _color = color;
-	if (gray_scale) _color = color2gs(color);
+	const disp_pixel_t pixel = color_to_pixel(color);
 
     taskDISABLE_INTERRUPTS();
 	disp_spi_transfer_addrwin(x, x+1, y, y+1);
@@ -263,15 +275,13 @@ void IRAM_ATTR drawPixel(int16_t x, int16_t y, color_t color, uint8_t sel)
 	disp_spi->host->hw->cmd.usr = 1;		// Start transfer
 	while (disp_spi->host->hw->cmd.usr);	// Wait for SPI bus ready
 
-	wd = (uint32_t)_color.r;
-	wd |= (uint32_t)_color.g << 8;
-	wd |= (uint32_t)_color.b << 16;
+	memcpy(&wd, &pixel, sizeof(pixel));
 
     // Set DC to 1 (data mode);
 	gpio_set_level(PIN_NUM_DC, 1);
 
 	disp_spi->host->hw->data_buf[0] = wd;
-	disp_spi->host->hw->mosi_dlen.usr_mosi_dbitlen = 23;
+	disp_spi->host->hw->mosi_dlen.usr_mosi_dbitlen = (sizeof(pixel) * 8) - 1;
 	disp_spi->host->hw->cmd.usr = 1;		// Start transfer
 	while (disp_spi->host->hw->cmd.usr);	// Wait for SPI bus ready
 
@@ -297,53 +307,39 @@ static void IRAM_ATTR _dma_send(uint8_t *data, uint32_t size)
 	disp_spi->host->hw->cmd.usr = 1;
 }
 
-//---------------------------------------------------------------------------
-static void IRAM_ATTR _direct_send(color_t *color, uint32_t len, uint8_t rep)
+// Number of bits that can be sent directly from the SPI data buffer (ie. without DMA)
+#define DIRECT_SEND_MAX_BITS 512
+
+//-------------------------------------------------------------------------------------
+static void IRAM_ATTR _direct_send(const disp_pixel_t *pixels, uint32_t len, uint8_t rep)
 {
-	uint32_t cidx = 0;	// color buffer index
+	const uint8_t *data = (const uint8_t *)pixels;
 	uint32_t wd = 0;
 	int idx = 0;
 	int bits = 0;
 	int wbits = 0;
 
     taskDISABLE_INTERRUPTS();
-	color_t _color = color[0];
-	if ((rep) && (gray_scale)) _color = color2gs(color[0]);
-
 	while (len) {
-		// ** Get color data from color buffer **
-		if (rep == 0) {
-			if (gray_scale) _color = color2gs(color[cidx]);
-			else _color = color[cidx];
-		}
-
-		wd |= (uint32_t)_color.r << wbits;
-		wbits += 8;
-		if (wbits == 32) {
-			bits += wbits;
-			wbits = 0;
-			disp_spi->host->hw->data_buf[idx++] = wd;
-			wd = 0;
-		}
-		wd |= (uint32_t)_color.g << wbits;
-		wbits += 8;
-		if (wbits == 32) {
-			bits += wbits;
-			wbits = 0;
-			disp_spi->host->hw->data_buf[idx++] = wd;
-			wd = 0;
-		}
-		wd |= (uint32_t)_color.b << wbits;
-		wbits += 8;
-		if (wbits == 32) {
-			bits += wbits;
-			wbits = 0;
-			disp_spi->host->hw->data_buf[idx++] = wd;
-			wd = 0;
+		// ** Get pixel data bytes from pixel buffer **
+		for (int n = 0; n < sizeof(disp_pixel_t); n++) {
+			wd |= (uint32_t)data[n] << wbits;
+			wbits += 8;
+			if (wbits == 32) {
+				bits += wbits;
+				wbits = 0;
+				disp_spi->host->hw->data_buf[idx++] = wd;
+				wd = 0;
+			}
 		}
-    	len--;					// Decrement colors counter
-        if (rep == 0) cidx++;	// if not repeating color, increment color buffer index
+    	len--;										// Decrement pixels counter
+        if (rep == 0) data += sizeof(disp_pixel_t);	// if not repeating pixel, increment pixel buffer index
     }
+	if (wbits) {
+		// partial last word
+		bits += wbits;
+		disp_spi->host->hw->data_buf[idx] = wd;
+	}
 	if (bits) {
 		while (disp_spi->host->hw->cmd.usr);						// Wait for SPI bus ready
 		disp_spi->host->hw->mosi_dlen.usr_mosi_dbitlen = bits-1;	// set number of bits to be sent
@@ -352,6 +348,62 @@ static void IRAM_ATTR _direct_send(color_t *color, uint32_t len, uint8_t rep)
     taskENABLE_INTERRUPTS();
 }
 
+// Send RAM WRITE command, and leave the display in data mode
+//-------------------------------------
+static void IRAM_ATTR _send_ramwr(void)
+{
+    gpio_set_level(PIN_NUM_DC, 0);
+    disp_spi->host->hw->data_buf[0] = (uint32_t)TFT_RAMWR;
+	disp_spi->host->hw->mosi_dlen.usr_mosi_dbitlen = 7;
+	disp_spi->host->hw->cmd.usr = 1;		// Start transfer
+	while (disp_spi->host->hw->cmd.usr);	// Wait for SPI bus ready
+
+	gpio_set_level(PIN_NUM_DC, 1);			// Set DC to 1 (data mode);
+}
+
+// Send 'len' pixels from the given (DMA capable) buffer
+// ** RAM WRITE command must already be sent **
+//-----------------------------------------------------------------------
+static void IRAM_ATTR _push_pixels(const disp_pixel_t *pixels, uint32_t len)
+{
+	if ((len * sizeof(disp_pixel_t) * 8) <= DIRECT_SEND_MAX_BITS) {
+		_direct_send(pixels, len, 0);
+	}
+	else {
+	    _dma_send((uint8_t *)pixels, len * sizeof(disp_pixel_t));
+	}
+}
+
+// Send 'pixel' to the display 'len' times
+// ** RAM WRITE command must already be sent **
+//------------------------------------------------------------------------
+static void IRAM_ATTR _push_pixel_rep(const disp_pixel_t pixel, uint32_t len)
+{
+	if ((len * sizeof(disp_pixel_t) * 8) <= DIRECT_SEND_MAX_BITS) {
+		_direct_send(&pixel, len, 1);
+		return;
+	}
+
+	// ==== Repeat pixel, more than 512 bits total ====
+	const uint32_t buf_pixels = ((len > (_width*2)) ? (_width*2) : len);
+
+	// Prepare pixel buffer of maximum 2 lines
+	trans_cline = heap_caps_malloc(buf_pixels * sizeof(disp_pixel_t), MALLOC_CAP_DMA);
+	if (trans_cline == NULL) return;
+
+	for (uint32_t i=0; i<buf_pixels; i++) {
+		trans_cline[i] = pixel;
+	}
+
+	// Send 'len' pixels
+	int to_send = len;
+	while (to_send > 0) {
+		wait_trans_finish(0);
+		_dma_send((uint8_t *)trans_cline, ((to_send > buf_pixels) ? buf_pixels : to_send) * sizeof(disp_pixel_t));
+		to_send -= buf_pixels;
+	}
+}
+
 // ================================================================
 // === Main function to send data to display ======================
 // If  rep==true:  repeat sending color data to display 'len' times
@@ -364,70 +416,47 @@ static void IRAM_ATTR _TFT_pushColorRep(color_t *color, uint32_t len, uint8_t re
 	if (len == 0) return;
 	if (!(disp_spi->cfg.flags & LB_SPI_DEVICE_HALFDUPLEX)) return;
 
-	// Send RAM WRITE command
-    gpio_set_level(PIN_NUM_DC, 0);
-    disp_spi->host->hw->data_buf[0] = (uint32_t)TFT_RAMWR;
-	disp_spi->host->hw->mosi_dlen.usr_mosi_dbitlen = 7;
-	disp_spi->host->hw->cmd.usr = 1;		// Start transfer
-	while (disp_spi->host->hw->cmd.usr);	// Wait for SPI bus ready
-
-	gpio_set_level(PIN_NUM_DC, 1);								// Set DC to 1 (data mode);
-
-	if ((len*24) <= 512) {
-
-		_direct_send(color, len, rep);
+	_send_ramwr();
 
+	if (rep) {
+		_push_pixel_rep(color_to_pixel(color[0]), len);
 	}
-	else if (rep == 0)  {
-		// ==== use DMA transfer ====
+	else {
+#ifdef DISP_COLOR_BITS_16
+		// ==== Convert to display pixels and send, a chunk at a time ====
+		// Uses two halves of the buffer, so the next chunk is converted while the last is sent
+		const uint32_t chunk_pixels = ((len > _width) ? _width : len);
+		if ((chunk_pixels * sizeof(disp_pixel_t) * 8) <= DIRECT_SEND_MAX_BITS) {
+			disp_pixel_t pixels[DIRECT_SEND_MAX_BITS / (sizeof(disp_pixel_t) * 8)];
+			for (uint32_t i=0; i<len; i++) {
+				pixels[i] = color_to_pixel(color[i]);
+			}
+			_direct_send(pixels, len, 0);
+		}
+		else {
+			trans_cline = heap_caps_malloc(2 * chunk_pixels * sizeof(disp_pixel_t), MALLOC_CAP_DMA);
+			if (trans_cline == NULL) return;
+
+			disp_pixel_t *chunk = trans_cline;
+			for (uint32_t sent = 0; sent < len; sent += chunk_pixels) {
+				const uint32_t to_send = ((len - sent) > chunk_pixels) ? chunk_pixels : (len - sent);
+				for (uint32_t i=0; i<to_send; i++) {
+					chunk[i] = color_to_pixel(color[sent + i]);
+				}
+				wait_trans_finish(0);
+				_dma_send((uint8_t *)chunk, to_send * sizeof(disp_pixel_t));
+				chunk = (chunk == trans_cline) ? trans_cline + chunk_pixels : trans_cline;
+			}
+		}
+#else
 		// ** Prepare data
 		if (gray_scale) {
 			for (int n=0; n<len; n++) {
 				color[n] = color2gs(color[n]);
 			}
 	    }
-
-	    _dma_send((uint8_t *)color, len*3);
-	}
-	else {
-		// ==== Repeat color, more than 512 bits total ====
-
-		color_t _color;
-		uint32_t buf_colors;
-		int buf_bytes, to_send;
-
-		/*
-		to_send = len;
-		while (to_send > 0) {
-			wait_trans_finish(0);
-			_direct_send(color, ((to_send > 21) ? 21 : to_send), rep);
-			to_send -= 21;
-		}
-		*/
-
-		buf_colors = ((len > (_width*2)) ? (_width*2) : len);
-		buf_bytes = buf_colors * 3;
-
-		// Prepare color buffer of maximum 2 color lines
-		trans_cline = heap_caps_malloc(buf_bytes, MALLOC_CAP_DMA);
-		if (trans_cline == NULL) return;
-
-		// Prepare fill color
-		if (gray_scale) _color = color2gs(color[0]);
-		else _color = color[0];
-
-		// Fill color buffer with fill color
-		for (uint32_t i=0; i<buf_colors; i++) {
-			trans_cline[i] = _color;
-		}
-
-		// Send 'len' colors
-		to_send = len;
-		while (to_send > 0) {
-			wait_trans_finish(0);
-			_dma_send((uint8_t *)trans_cline, ((to_send > buf_colors) ? buf_bytes : (to_send*3)));
-			to_send -= buf_colors;
-		}
+		_push_pixels(color, len);
+#endif
 	}
 
 	if (wait) wait_trans_finish(1);
@@ -457,6 +486,22 @@ void IRAM_ATTR send_data(int x1, int y1, int x2, int y2, uint32_t len, color_t *
 	_TFT_pushColorRep(buf, len, 0, 0);
 }
 
+// Write 'len' pixels (already in the display pixel format) to TFT 'window' (x1,y2),(x2,y2)
+// from given DMA capable buffer, which must not be modified until the transfer completes.
+// ** Device must already be selected **
+//-------------------------------------------------------------------------------------------
+void IRAM_ATTR send_pixels(int x1, int y1, int x2, int y2, uint32_t len, disp_pixel_t *buf)
+{
+	// ** Send address window **
+	disp_spi_transfer_addrwin(x1, x2, y1, y2);
+
+	if (len == 0) return;
+	if (!(disp_spi->cfg.flags & LB_SPI_DEVICE_HALFDUPLEX)) return;
+
+	_send_ramwr();
+	_push_pixels(buf, len);
+}
+
 // Reads 'len' pixels/colors from the TFT's GRAM 'window'
 // 'buf' is an array of bytes with 1st byte reserved for reading 1 dummy byte
 // and the rest is actually an array of color_t values
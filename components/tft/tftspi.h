@@ -103,6 +103,19 @@ typedef struct __attribute__((__packed__)) {
 	uint8_t b;
 } color_t ;
 
+// ==== Pixel format sent to the display ====
+// 16-bit RGB565 (2 bytes per pixel) where the controller supports it over SPI,
+// otherwise 18-bit (3 bytes per pixel, as color_t)
+#if defined(CONFIG_DISP_COLOR_BITS_16) && ((DEFAULT_DISP_TYPE == DISP_TYPE_ST7789V) || (DEFAULT_DISP_TYPE == DISP_TYPE_ILI9341))
+#define DISP_COLOR_BITS_16	0x55
+#define DISP_PIXEL_FORMAT	DISP_COLOR_BITS_16
+// RGB565 in display (big-endian) byte order
+typedef uint16_t disp_pixel_t;
+#else
+#define DISP_PIXEL_FORMAT	DISP_COLOR_BITS_24
+typedef color_t disp_pixel_t;
+#endif
+
 // ==== Display commands constants ====
 #define TFT_INVOFF     0x20
 #define TFT_INVONN     0x21
@@ -231,7 +244,7 @@ static const uint8_t ST7789V_init[] = {
   TFT_CMD_GMCTRP1, 14, 0xD0, 0x00, 0x05, 0x0E, 0x15, 0x0D, 0x37, 0x43, 0x47, 0x09, 0x15, 0x12, 0x16, 0x19,
   TFT_CMD_GMCTRN1, 14, 0xD0, 0x00, 0x05, 0x0D, 0x0C, 0x06, 0x2D, 0x44, 0x40, 0x0E, 0x1C, 0x18, 0x16, 0x19,
   TFT_MADCTL, 1, (MADCTL_MX | TFT_RGB_BGR),			// Memory Access Control (orientation)
-  TFT_CMD_PIXFMT, 1, DISP_COLOR_BITS_24,            // *** INTERFACE PIXEL FORMAT: 0x66 -> 18 bit; 0x55 -> 16 bit
+  TFT_CMD_PIXFMT, 1, DISP_PIXEL_FORMAT,             // *** INTERFACE PIXEL FORMAT: 0x66 -> 18 bit; 0x55 -> 16 bit
   TFT_CMD_SLPOUT, TFT_CMD_DELAY, 120,				//  Sleep out,	//  120 ms delay
   TFT_DISPON, TFT_CMD_DELAY, 120,
 };
@@ -260,7 +273,7 @@ static const uint8_t ILI9341_init[] = {
   TFT_MADCTL, 1,									// Memory Access Control (orientation)
   (MADCTL_MX | TFT_RGB_BGR),
   // *** INTERFACE PIXEL FORMAT: 0x66 -> 18 bit; 0x55 -> 16 bit
-  TFT_CMD_PIXFMT, 1, DISP_COLOR_BITS_24,
+  TFT_CMD_PIXFMT, 1, DISP_PIXEL_FORMAT,
 #ifdef CONFIG_DISP_INVERT_COLORS
   TFT_INVONN, 0,
 #else
@@ -511,6 +524,8 @@ void disp_spi_transfer_cmd(int8_t cmd);
 void disp_spi_transfer_cmd_data(int8_t cmd, uint8_t *data, uint32_t len);
 void drawPixel(int16_t x, int16_t y, color_t color, uint8_t sel);
 void send_data(int x1, int y1, int x2, int y2, uint32_t len, color_t *buf);
+void send_pixels(int x1, int y1, int x2, int y2, uint32_t len, disp_pixel_t *buf);
+disp_pixel_t color_to_pixel(color_t color);
 void TFT_pushColorRep(int x1, int y1, int x2, int y2, color_t data, uint32_t len);
 int read_data(int x1, int y1, int x2, int y2, int len, uint8_t *buf, uint8_t set_sp);
 color_t readPixel(int16_t x, int16_t y);
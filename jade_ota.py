@@ -284,7 +284,8 @@ def ota(jade, fwcompressed, fwlength, fwhash, patchlen=None, pushmnemonic=False)
         last_written = written
 
     result = jade.ota_update(fwcompressed, fwlength, chunksize, fwhash,
-                             patchlen=patchlen, cb=_log_progress)
+                             patchlen=patchlen, cb=_log_progress,
+                             window=info.get('JADE_OTA_MAX_WINDOW'))
     assert result is True
 
     logger.info(f'Total ota time in secs: {time.time() - start_time}')
@@ -348,6 +348,79 @@ class JadeAPI:
         """
         return self._jadeRpc('get_version_info')
 
+    def get_perf_stats(self):
+        """
+        RPC call to fetch performance telemetry collected by the hw since it last booted.
+        NOTE: Only available once the hw is unlocked.
+
+        Returns
+        -------
+        dict
+            Contains:
+            'uptime_ms' - time since boot
+            'methods' - per-method stats for the most frequently called methods, containing the
+                number of 'calls', and the total time (in microseconds) spent receiving the message
+                ('recv_us'), awaiting dispatch ('dispatch_us'), processing ('compute_us'), awaiting
+                user input ('wait_us') and sending replies ('send_us'), as well as the longest
+                processing time ('compute_max_us') and a histogram of processing times
+                ('compute_hist' - counts for <1ms, <4ms, <16ms, <64ms, <256ms, <1024ms and longer)
+            'heap' - current and minimum-ever free heap, for dram and spiram
+            'stack_hwm' - stack high-water marks of running tasks, by task name
+            'ringbuffers' - size and peak usage of the message ringbuffers
+            See also format_perf_stats().
+        """
+        return self._jadeRpc('get_perf_stats')
+
+    @staticmethod
+    def format_perf_stats(stats):
+        """
+        Helper to format the result of get_perf_stats() as a human-readable table.
+
+        Parameters
+        ----------
+        stats : dict
+            The result of a get_perf_stats() call.
+
+        Returns
+        -------
+        str
+            Multi-line text describing the stats.
+        """
+        hist_labels = ['<1ms', '<4ms', '<16ms', '<64ms', '<256ms', '<1s', '>=1s']
+
+        def _ms(us, calls=1):
+            return '{0:.1f}'.format(us / 1000 / max(calls, 1))
+
+        lines = ['Uptime: {0:.1f}s'.format(stats['uptime_ms'] / 1000), '']
+
+        lines.append('{0:<26}{1:>7}{2:>10}{3:>10}{4:>10}{5:>10}{6:>10}{7:>10}'.format(
+            'method', 'calls', 'recv', 'dispatch', 'compute', 'max', 'wait', 'send'))
+        for method, m in stats['methods'].items():
+            calls = m['calls']
+            lines.append('{0:<26}{1:>7}{2:>10}{3:>10}{4:>10}{5:>10}{6:>10}{7:>10}'.format(
+                method, calls, _ms(m['recv_us'], calls), _ms(m['dispatch_us'], calls),
+                _ms(m['compute_us'], calls), _ms(m['compute_max_us']), _ms(m['wait_us'], calls),
+                _ms(m['send_us'], calls)))
+            hist = ', '.join(f'{label}: {count}' for label, count in zip(hist_labels, m['compute_hist'])
+                             if count)
+            lines.append(f'    compute histogram: {hist}')
+        lines.append('(average ms per call, except max)')
+        lines.append('')
+
+        heap = stats['heap']
+        lines.append('Heap: dram free {0} (min {1}), spiram free {2} (min {3})'.format(
+            heap['dram_free'], heap['dram_min_free'], heap['spiram_free'], heap['spiram_min_free']))
+
+        lines.append('Stack high-water marks:')
+        for task, hwm in stats['stack_hwm'].items():
+            lines.append(f'    {task:<20}{hwm:>8}')
+
+        lines.append('Ringbuffer peak usage:')
+        for ringbuf, usage in stats['ringbuffers'].items():
+            lines.append(f"    {ringbuf:<20}{usage['peak']:>8} / {usage['size']}")
+
+        return '\n'.join(lines)
+
     def add_entropy(self, entropy):
         """
         RPC call to add client entropy into the unit RNG entropy pool.
@@ -397,7 +470,8 @@ class JadeAPI:
         """
         return self._jadeRpc('logout')
 
-    def ota_update(self, fwcmp, fwlen, chunksize, fwhash=None, patchlen=None, cb=None):
+    def ota_update(self, fwcmp, fwlen, chunksize, fwhash=None, patchlen=None, cb=None, window=None,
+                   resume=False):
         """
         RPC call to attempt to update the unit's firmware.
 
@@ -430,6 +504,18 @@ class JadeAPI:
             If passed, this function is invoked each time a fw chunk is successfully uploaded and
             ack'd by the hw, to notify of upload progress.
             Defaults to None, and nothing is called to report upload progress.
+        window : int, optional
+            The number of chunks to keep 'in flight' - ie. sent to the hw before their receipt is
+            acknowledged.  The hw acks cumulatively, so not every chunk receives its own reply.
+            The maximum supported window is given in the version info data, under the key
+            'JADE_OTA_MAX_WINDOW' - if absent, the hw does not support windowed uploads.
+            Defaults to None, implying each chunk is sent and ack'd in turn.
+        resume : bool, optional
+            Whether to first try to continue an interrupted upload of this same firmware (eg. after
+            the connection was lost) - the hw reports how much data it has already processed, and
+            the upload continues from that point.  If the hw has no matching upload in progress, a
+            new upload is started.  Other parameters must be as passed to the interrupted call.
+            Defaults to False, implying a new upload is always started.
 
         Returns
         -------
@@ -457,11 +543,20 @@ class JadeAPI:
             ota_method = 'ota_delta'
             params['patchsize'] = patchlen
 
-        result = self._jadeRpc(ota_method, params)
-        assert result is True
+        if window:
+            params['window'] = window
+
+        written = self._ota_resume(params) if resume else None
+        if written is None:
+            result = self._jadeRpc(ota_method, params)
+            assert result is True
+            written = 0
+
+        if window:
+            self._ota_send_windowed(fwcmp, chunksize, window, cb, written)
+            return self._jadeRpc('ota_complete')
 
         # Write binary chunks
-        written = 0
         while written < cmplen:
             remaining = cmplen - written
             length = min(remaining, chunksize)
@@ -476,6 +571,68 @@ class JadeAPI:
         # All binary data uploaded
         return self._jadeRpc('ota_complete')
 
+    def _ota_resume(self, params):
+        """
+        Helper to ask the hw where to continue an interrupted upload of the firmware described
+        by 'params' (as passed to the initial 'ota' or 'ota_delta' call).
+        Returns the offset into the compressed firmware from which the upload should continue, or
+        None if the hw has no matching upload in progress (so a new upload should be started).
+        """
+        # Discard any replies to messages sent before the upload was interrupted
+        self.drain()
+        try:
+            offset = self._jadeRpc('ota_resume', params)
+            logger.info(f'Resuming upload at offset {offset}')
+            return offset
+        except JadeError as e:
+            logger.warn(f'Unable to resume upload: {e.message}')
+            return None
+
+    def _ota_send_windowed(self, fwcmp, chunksize, window, cb=None, offset=0):
+        """
+        Helper to upload the compressed firmware keeping up to 'window' chunks in flight.
+        Each chunk carries a sequence number, and the hw replies with the sequence number of the
+        last chunk it has processed - acknowledging that chunk and all those before it.
+        The upload starts at the passed offset into the compressed firmware (eg. when resuming).
+        """
+        cmplen = len(fwcmp)
+        baseid = random.randint(100000, 899999)
+        inflight = collections.deque()  # (seq, id, length) of unacknowledged chunks
+        written = offset
+        acked = offset
+        seq = 0
+
+        try:
+            while acked < cmplen:
+                # Send the next chunk if there is space in the window
+                if written < cmplen and len(inflight) < window:
+                    length = min(cmplen - written, chunksize)
+                    chunk = bytes(fwcmp[written:written + length])
+                    request = self.jade.build_request(str(baseid + seq), 'ota_data',
+                                                      {'seq': seq, 'data': chunk})
+                    self.jade.write_request(request)
+                    inflight.append((seq, request['id'], length))
+                    written += length
+                    seq += 1
+                    continue
+
+                # Window full (or all sent) - await the next ack
+                reply = self.jade.read_response()
+                assert any(reply.get('id') == id for _, id, _ in inflight) or \
+                    (reply.get('id') == '00' and 'error' in reply)
+                ackseq = self._get_result_or_raise_error(reply)
+
+                while inflight and inflight[0][0] <= ackseq:
+                    _, _, length = inflight.popleft()
+                    acked += length
+
+                if (cb):
+                    cb(acked, cmplen)
+        except JadeError:
+            # Discard replies to any other chunks in flight
+            self.drain()
+            raise
+
     def run_remote_selfcheck(self):
         """
         RPC call to run in-built tests.
@@ -489,6 +646,73 @@ class JadeAPI:
         """
         return self._jadeRpc('debug_selfcheck', long_timeout=True)
 
+    def get_trace(self):
+        """
+        RPC call to fetch the timeline trace events recorded by the hw.
+        Recording is paused while the events are fetched (over several messages), and restarts
+        (with an empty trace) once all events have been returned.
+        See also trace_to_chrome().
+        NOTE: Only available in a DEBUG build of the firmware.
+
+        Returns
+        -------
+        dict
+            Contains:
+            'tasks' - list of task names, indexed by the 'task' in each event
+            'events' - list of events, oldest first, each a list:
+                [timestamp (microseconds, lower 32-bits only), task, core, phase ('B' or 'E'), name]
+        """
+        events = []
+        while True:
+            page = self._jadeRpc('debug_get_trace', {'index': len(events)})
+            events.extend(page['events'])
+            if not page['events'] or len(events) >= page['total']:
+                return {'tasks': page['tasks'], 'events': events}
+
+    @staticmethod
+    def trace_to_chrome(trace):
+        """
+        Helper to convert the result of get_trace() into the Chrome trace event format, which can
+        be loaded into chrome://tracing or https://ui.perfetto.dev once dumped as json.
+
+        Parameters
+        ----------
+        trace : dict
+            The trace data as returned by get_trace()
+
+        Returns
+        -------
+        dict
+            The trace in Chrome trace event format (ie. with 'traceEvents' list)
+        """
+        tasks = trace['tasks']
+        chrome_events = [{'name': 'process_name', 'ph': 'M', 'pid': 0, 'args': {'name': 'Jade'}}]
+        for tid, task in enumerate(tasks):
+            chrome_events.append({'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': tid, 'args': {'name': task}})
+
+        # Timestamps are the lower 32-bits of the hw microsecond timer, so unwrap as required.
+        # Drop any 'end' events whose 'begin' was lost (eg. overwritten when the trace ring wrapped).
+        wraps, last_ts = 0, None
+        open_events = {}
+        for ts, tid, core, phase, name in trace['events']:
+            if last_ts is not None and ts < last_ts - (1 << 31):
+                wraps += 1
+            last_ts = ts
+
+            stack = open_events.setdefault(tid, [])
+            if phase == 'B':
+                stack.append(name)
+            elif name in stack:
+                while stack.pop() != name:
+                    pass
+            else:
+                continue
+
+            chrome_events.append({'name': name, 'ph': phase, 'ts': ts + (wraps << 32),
+                                  'pid': 0, 'tid': tid, 'args': {'core': core}})
+
+        return {'traceEvents': chrome_events, 'displayTimeUnit': 'ms'}
+
     def capture_image_data(self, check_qr=False):
         """
         RPC call to capture raw image data from the camera.
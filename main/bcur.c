@@ -1,5 +1,6 @@
 #include "bcur.h"
 #include "jade_assert.h"
+#include "jade_tasks.h"
 #include "qrcode.h"
 #include "qrscan.h"
 #include "ui.h"
@@ -10,6 +11,11 @@
 #include <cdecoder.h>
 #include <cencoder.h>
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
 // PSBT serialisation functions
 bool deserialise_psbt(const uint8_t* bytes, size_t bytes_len, struct wally_psbt** psbt_out);
 bool serialise_psbt(const struct wally_psbt* psbt, uint8_t** output, size_t* output_len);
@@ -535,7 +541,9 @@ void bcur_build_cbor_crypto_account(const script_variant_t script_variant, const
 // Support scanning a bc-ur qr-code - single-frame or animated/multi-frame.
 // Adds a scanned bc-ur qr the bcur decoder - only returns true when the decoder is complete.
 // ie. collates multiple frames until the entire bc-ur data is complete.
-// If the qr-code scanned is not a bc-ur part, return success immediately.
+// If the qr-code scanned is not a bc-ur part, return success immediately - unless we are
+// part-way through collecting a multi-frame bc-ur code, in which case it is ignored.
+// NOTE: may be called for several distinct qr-codes found in the same camera image.
 // Updates associated progress-bar as parts are scanned.
 static bool collect_any_bcur(qr_data_t* qr_data)
 {
@@ -547,6 +555,12 @@ static bool collect_any_bcur(qr_data_t* qr_data)
 
     if (qr_data->len < sizeof(BCUR_PREFIX)
         || strncasecmp((const char*)qr_data->data, BCUR_PREFIX, sizeof(BCUR_PREFIX) - 1)) {
+        if (urreceived_parts_count_decoder(qr_data->ctx)) {
+            // Not bc-ur, but we are collecting bc-ur fragments - ignore
+            JADE_LOGW("Ignoring non-bcur qr-code while collecting bcur fragments");
+            return false;
+        }
+
         // Not bc-ur - return immediately
         update_progress_bar(qr_data->progress_bar, 1, 1);
         return true;
@@ -718,6 +732,250 @@ void bcur_create_qr_icons(const uint8_t* payload, const size_t len, const char*
     *num_icons = num_fragments;
 }
 
+// The number of pre-rendered qr icons held when streaming bc-ur fragments.
+// One is being displayed, the others are rendered ahead of time.
+#define BCUR_ICON_STREAM_CACHE_SIZE 4
+
+// Streaming generator of bc-ur fragment qr icons - fragments are rendered on demand
+// by a background task into a small ring of icons, as the display cycles through them.
+struct _bcur_icon_stream_t {
+    uint8_t encoder[URENCODER_SIZE];
+    char* bcur_type;
+    uint8_t* payload;
+    size_t payload_len;
+    uint16_t max_fragment_size;
+
+    // Underlying qrcode data/work area - opaque
+    uint8_t* qrbuffer;
+    uint8_t qr_version;
+
+    // Longest fragment which fits the qr - beyond this the encoder is restarted
+    uint16_t fragment_capacity;
+
+    // Ring of icons, and the queues of indices of free and ready-to-display slots
+    Icon icons[BCUR_ICON_STREAM_CACHE_SIZE];
+    uint8_t displayed;
+    QueueHandle_t free_slots;
+    QueueHandle_t ready_slots;
+
+    // Background rendering task, and stop flag/signal
+    TaskHandle_t task;
+    SemaphoreHandle_t stopped;
+    volatile bool stop;
+};
+
+// Render the next bc-ur fragment from the stream's encoder into the passed icon
+// Returns true if the encoder had to be restarted from the first fragment.
+static bool bcur_icon_stream_render_next(bcur_icon_stream_t* stream, Icon* icon)
+{
+    JADE_ASSERT(stream);
+    JADE_ASSERT(icon);
+
+    const bool force_uppercase = true; // fetch bcur fragment as uppercase to conform to 'alphanumeric' qr mode
+    const uint16_t qrcode_alphanumeric_capacity = stream->fragment_capacity;
+    bool restarted = false;
+
+    char* fragment = NULL;
+    urnext_part_encoder(stream->encoder, force_uppercase, &fragment);
+    size_t fragment_len = strlen(fragment);
+
+    // The fountain-code sequence is unbounded, but as the sequence numbers get longer the fragments
+    // may eventually exceed the qr capacity - in which case restart the encoder from the beginning.
+    if (fragment_len > qrcode_alphanumeric_capacity) {
+        JADE_LOGI("Fragment length %u exceeds capacity %u - restarting encoder", fragment_len,
+            qrcode_alphanumeric_capacity);
+        urfree_encoded_encoder(fragment);
+        urfree_placement_encoder(stream->encoder);
+        urcreate_placement_encoder(stream->encoder, sizeof(stream->encoder), stream->bcur_type, stream->payload,
+            stream->payload_len, stream->max_fragment_size, 0, 8);
+        urnext_part_encoder(stream->encoder, force_uppercase, &fragment);
+        fragment_len = strlen(fragment);
+        restarted = true;
+    }
+    JADE_LOGD("Making qr-code icon with data (length: %u): %s", fragment_len, fragment);
+    JADE_ASSERT(fragment_len <= qrcode_alphanumeric_capacity);
+
+    QRCode qrcode;
+    const int qret = qrcode_initText(&qrcode, stream->qrbuffer, stream->qr_version, BCUR_QR_ECC, fragment);
+    JADE_ASSERT(qret == 0);
+    urfree_encoded_encoder(fragment);
+
+    // Convert fragment to Icon - reusing any existing icon buffer
+    if (icon->data) {
+        qrcode_redrawIcon(&qrcode, icon, QR_SCALE_FACTOR[stream->qr_version]);
+    } else {
+        qrcode_toIcon(&qrcode, icon, QR_SCALE_FACTOR[stream->qr_version]);
+    }
+    return restarted;
+}
+
+// Task to render fragments into any free icon slots, ahead of them being displayed
+static void bcur_icon_stream_task(void* ctx)
+{
+    JADE_ASSERT(ctx);
+    bcur_icon_stream_t* const stream = (bcur_icon_stream_t*)ctx;
+
+    while (!stream->stop) {
+        uint8_t slot;
+        if (xQueueReceive(stream->free_slots, &slot, 100 / portTICK_PERIOD_MS) != pdTRUE) {
+            continue;
+        }
+        JADE_ASSERT(slot < BCUR_ICON_STREAM_CACHE_SIZE);
+        bcur_icon_stream_render_next(stream, stream->icons + slot);
+
+        // Can never block as the queue can hold all the slots
+        const BaseType_t ret = xQueueSend(stream->ready_slots, &slot, 0);
+        JADE_ASSERT(ret == pdTRUE);
+    }
+
+    // Signal we are done, and await our death
+    xSemaphoreGive(stream->stopped);
+    for (;;) {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+
+// Create a stream and its encoder, but do not render any fragments
+// Returns the number of 'pure' fragments in the encoding.
+static size_t bcur_icon_stream_init(const uint8_t* payload, const size_t len, const char* bcur_type,
+    const uint8_t qr_version, bcur_icon_stream_t** stream_out)
+{
+    JADE_ASSERT(payload);
+    JADE_ASSERT(len);
+    JADE_ASSERT(bcur_type);
+    JADE_ASSERT(qr_version >= 4);
+    JADE_ASSERT(qr_version <= 12);
+    JADE_INIT_OUT_PPTR(stream_out);
+
+    // See bcur_create_qr_icons() above for fragment size considerations
+    const uint16_t qrcode_alphanumeric_capacity = QR_ALPHANUMERIC_CAPACITY[qr_version];
+    const uint16_t bcur_max_fragment_size = BCUR_MAX_FRAGMENT_SIZE(qrcode_alphanumeric_capacity, bcur_type);
+    JADE_ASSERT(bcur_max_fragment_size < qrcode_alphanumeric_capacity); // didn't 'under'flow
+
+    bcur_icon_stream_t* const stream = JADE_CALLOC(1, sizeof(bcur_icon_stream_t));
+    stream->bcur_type = strdup(bcur_type);
+    JADE_ASSERT(stream->bcur_type);
+    stream->payload = JADE_MALLOC_PREFER_SPIRAM(len);
+    memcpy(stream->payload, payload, len);
+    stream->payload_len = len;
+    stream->max_fragment_size = bcur_max_fragment_size;
+    stream->qr_version = qr_version;
+    stream->qrbuffer = JADE_MALLOC(qrcode_getBufferSize(qr_version));
+    stream->fragment_capacity = qrcode_alphanumeric_capacity;
+
+    // Encode the message as bc-ur
+    JADE_LOGI("BC-UR streaming payload length %u as type %s, qr-code version %u, max fragment size %u", len,
+        bcur_type, qr_version, bcur_max_fragment_size);
+    urcreate_placement_encoder(stream->encoder, sizeof(stream->encoder), bcur_type, payload, len,
+        bcur_max_fragment_size, 0, 8);
+
+    *stream_out = stream;
+    return urseqlen_encoder(stream->encoder);
+}
+
+// Creates a stream of qr icons for the BC-UR encoding of the passed payload, with the given 'type'.
+// The first icon is rendered immediately and returned, subsequent fragments are rendered in the
+// background as they are consumed - see bcur_icon_stream_next().
+// NOTE: input is expected to be a valid CBOR message, although this is not validated
+// NOTE: the stream must be freed with bcur_free_icon_stream(), which also frees all icon data.
+// NOTE Only supports qr-versions from 4 to 12  (4, 6 and 12 fit nicely on a Jade screen).
+void bcur_create_qr_icon_stream(const uint8_t* payload, const size_t len, const char* bcur_type,
+    const uint8_t qr_version, bcur_icon_stream_t** stream_out, Icon* first_icon, size_t* num_fragments)
+{
+    JADE_INIT_OUT_PPTR(stream_out);
+    JADE_ASSERT(first_icon);
+    JADE_INIT_OUT_SIZE(num_fragments);
+
+    bcur_icon_stream_t* stream = NULL;
+    const size_t num_pure_fragments = bcur_icon_stream_init(payload, len, bcur_type, qr_version, &stream);
+    JADE_ASSERT(stream);
+
+    // Render the first fragment immediately - this is the icon initially displayed
+    stream->displayed = 0;
+    bcur_icon_stream_render_next(stream, stream->icons + stream->displayed);
+    *first_icon = stream->icons[stream->displayed];
+
+    // If there is only a single fragment there is no need to stream any further icons
+    if (num_pure_fragments > 1) {
+        stream->free_slots = xQueueCreate(BCUR_ICON_STREAM_CACHE_SIZE, sizeof(uint8_t));
+        JADE_ASSERT(stream->free_slots);
+        stream->ready_slots = xQueueCreate(BCUR_ICON_STREAM_CACHE_SIZE, sizeof(uint8_t));
+        JADE_ASSERT(stream->ready_slots);
+        stream->stopped = xSemaphoreCreateBinary();
+        JADE_ASSERT(stream->stopped);
+
+        for (uint8_t slot = 1; slot < BCUR_ICON_STREAM_CACHE_SIZE; ++slot) {
+            const BaseType_t ret = xQueueSend(stream->free_slots, &slot, 0);
+            JADE_ASSERT(ret == pdTRUE);
+        }
+
+        const BaseType_t retval = xTaskCreatePinnedToCore(&bcur_icon_stream_task, "bcur_icons", 8 * 1024, stream,
+            JADE_TASK_PRIO_QR_RENDER, &stream->task, JADE_CORE_SECONDARY);
+        JADE_ASSERT_MSG(
+            retval == pdPASS, "Failed to create bcur_icons task, xTaskCreatePinnedToCore() returned %d", retval);
+    }
+
+    *stream_out = stream;
+    *num_fragments = num_pure_fragments;
+}
+
+// Fetch the next icon from the stream, if one has been rendered.
+// Returns false if no new icon is ready, in which case the current icon should continue to be displayed.
+// NOTE: the icon data is owned by the stream, and remains valid until the next call to this function.
+// (Signature matches 'gui_icon_generator_fn_t' so can be used directly as a gui icon generator.)
+bool bcur_icon_stream_next(void* ctx, Icon* icon)
+{
+    JADE_ASSERT(ctx);
+    JADE_ASSERT(icon);
+
+    bcur_icon_stream_t* const stream = (bcur_icon_stream_t*)ctx;
+    if (!stream->task) {
+        // Single fragment only
+        return false;
+    }
+
+    uint8_t slot;
+    if (xQueueReceive(stream->ready_slots, &slot, 0) != pdTRUE) {
+        JADE_LOGD("No bcur fragment icon ready");
+        return false;
+    }
+
+    // Hand the previously displayed icon slot back to be re-rendered
+    const BaseType_t ret = xQueueSend(stream->free_slots, &stream->displayed, 0);
+    JADE_ASSERT(ret == pdTRUE);
+
+    stream->displayed = slot;
+    *icon = stream->icons[slot];
+    return true;
+}
+
+// Stop any background rendering, and free the stream and all icon data
+void bcur_free_icon_stream(void* ctx)
+{
+    JADE_ASSERT(ctx);
+    bcur_icon_stream_t* const stream = (bcur_icon_stream_t*)ctx;
+
+    if (stream->task) {
+        stream->stop = true;
+        xSemaphoreTake(stream->stopped, portMAX_DELAY);
+        vTaskDelete(stream->task);
+
+        vSemaphoreDelete(stream->stopped);
+        vQueueDelete(stream->ready_slots);
+        vQueueDelete(stream->free_slots);
+    }
+
+    for (size_t i = 0; i < BCUR_ICON_STREAM_CACHE_SIZE; ++i) {
+        free(stream->icons[i].data);
+    }
+
+    urfree_placement_encoder(stream->encoder);
+    free(stream->qrbuffer);
+    free(stream->payload);
+    free(stream->bcur_type);
+    free(stream);
+}
+
 #ifdef CONFIG_DEBUG_MODE
 // NOTE: iterative test for the BCUR_MAX_FRAGMENT_SIZE() macro which yields the input
 // 'max fragment size' (of payload data) to produce output bcur-encoded fragments close to
@@ -770,4 +1028,48 @@ bool bcur_check_fragment_sizes(void)
     }
     return !overflowed;
 }
+
+// Test the icon stream restarts its encoder when fragments outgrow the qr capacity.
+// The capacity is set to the length of the first fragment, so the longer sequence number
+// of the tenth fragment (ie. '/10-' vs '/9-') should trigger a restart.
+bool bcur_check_icon_stream_restart(void)
+{
+    const char* type = BCUR_TYPE_CRYPTO_PSBT;
+    const uint8_t qr_version = 6;
+    uint8_t payload[512];
+    memset(payload, 0xa5, sizeof(payload));
+
+    // Measure the first fragment
+    bcur_icon_stream_t* stream = NULL;
+    const size_t num_pure_fragments = bcur_icon_stream_init(payload, sizeof(payload), type, qr_version, &stream);
+    JADE_ASSERT(stream);
+    if (num_pure_fragments < 2 || num_pure_fragments > 9) {
+        JADE_LOGE("Unexpected number of pure fragments: %u", num_pure_fragments);
+        bcur_free_icon_stream(stream);
+        return false;
+    }
+
+    uint8_t encoder[URENCODER_SIZE];
+    urcreate_placement_encoder(
+        encoder, sizeof(encoder), type, payload, sizeof(payload), stream->max_fragment_size, 0, 8);
+    char* fragment = NULL;
+    urnext_part_encoder(encoder, true, &fragment);
+    stream->fragment_capacity = strlen(fragment);
+    urfree_encoded_encoder(fragment);
+    urfree_placement_encoder(encoder);
+
+    // Render fragments synchronously (no background task) - expect a restart every nine fragments
+    size_t num_restarts = 0;
+    for (size_t i = 0; i < 30; ++i) {
+        const bool restarted = bcur_icon_stream_render_next(stream, stream->icons);
+        if (restarted != (i % 9 == 0 && i > 0)) {
+            JADE_LOGE("Unexpected encoder restart state %u for fragment %u", restarted, i);
+            bcur_free_icon_stream(stream);
+            return false;
+        }
+        num_restarts += restarted;
+    }
+    bcur_free_icon_stream(stream);
+    return num_restarts == 3;
+}
 #endif
@@ -51,4 +51,15 @@ bool bcur_scan_qr(const char* title, const char* prompt_text, char** output_type
 void bcur_create_qr_icons(
     const uint8_t* payload, size_t len, const char* bcur_type, uint8_t qr_version, Icon** icons, size_t* num_icons);
 
+// Encodes the passed payload as BC-UR fragments with the given 'type', rendered as QR codes on demand.
+// The first icon is returned immediately, subsequent icons are rendered in the background on the
+// secondary core, and fetched with bcur_icon_stream_next() - the fountain-code sequence is unbounded.
+// 'num_fragments' is the number of 'pure' fragments - if one, no further icons are generated.
+// NOTE: all icon data is owned by the stream - caller must free with bcur_free_icon_stream().
+typedef struct _bcur_icon_stream_t bcur_icon_stream_t;
+void bcur_create_qr_icon_stream(const uint8_t* payload, size_t len, const char* bcur_type, uint8_t qr_version,
+    bcur_icon_stream_t** stream_out, Icon* first_icon, size_t* num_fragments);
+bool bcur_icon_stream_next(void* ctx, Icon* icon);
+void bcur_free_icon_stream(void* ctx);
+
 #endif /* BCUR_H_ */
@@ -2,6 +2,7 @@
 
 #include "button_events.h"
 #include "camera.h"
+#include "camera_exposure.h"
 #include "idletimer.h"
 #include "jade_assert.h"
 #include "jade_tasks.h"
@@ -141,6 +142,136 @@ static void jade_camera_stop(void)
     power_camera_off();
 }
 
+// Frame quality gating - when scanning (ie. processing every frame) frames which are obviously unusable
+// (blank, washed-out or badly blurred) are not passed to the (expensive) processing callback.
+// Statistics are gathered over a subsampled grid of pixels, and are also used to nudge the sensor's
+// auto-exposure/gain targets when frames are consistently too dark or too bright.
+#define CAMERA_QUALITY_SAMPLE_STEP 4
+#define CAMERA_QUALITY_HISTOGRAM_BINS 64
+#define CAMERA_QUALITY_PERCENTILE 5
+
+// Minimum spread between the dark and light percentiles, and minimum normalised gradient energy (as a
+// percentage of the contrast squared) - a sharp qr code is typically well above this, a blurred one below.
+#define CAMERA_QUALITY_MIN_CONTRAST 32
+#define CAMERA_QUALITY_MIN_SHARPNESS 2
+
+// Never skip more than this many consecutive frames, in case the thresholds are too strict for a scene
+#define CAMERA_QUALITY_MAX_SKIPPED_FRAMES 4
+
+_Static_assert(CAMERA_GAINCEILING_MAX == GAINCEILING_128X, "Unexpected camera gainceiling range");
+
+typedef struct {
+    uint8_t skipped_frames;
+    camera_exposure_state_t exposure;
+} camera_quality_state_t;
+
+typedef struct {
+    uint8_t mean;
+    uint8_t contrast;
+    uint32_t sharpness;
+} frame_quality_t;
+
+static void assess_frame_quality(const camera_fb_t* fb, frame_quality_t* quality)
+{
+    JADE_ASSERT(fb);
+    JADE_ASSERT(quality);
+
+    uint16_t histogram[CAMERA_QUALITY_HISTOGRAM_BINS] = { 0 };
+    uint32_t total = 0;
+    uint32_t gradient_energy = 0;
+    uint16_t num_samples = 0;
+
+    // Sample pixels on a sparse grid, with the gradient to the next pixel right and down
+    for (size_t y = 0; y < fb->height - 1; y += CAMERA_QUALITY_SAMPLE_STEP) {
+        const uint8_t* const row = fb->buf + y * fb->width;
+        for (size_t x = 0; x < fb->width - 1; x += CAMERA_QUALITY_SAMPLE_STEP) {
+            const uint8_t pixel = row[x];
+            const int16_t dx = row[x + 1] - pixel;
+            const int16_t dy = row[x + fb->width] - pixel;
+
+            ++histogram[pixel * CAMERA_QUALITY_HISTOGRAM_BINS / 256];
+            total += pixel;
+            gradient_energy += dx * dx + dy * dy;
+            ++num_samples;
+        }
+    }
+    JADE_ASSERT(num_samples);
+
+    // Contrast is the spread between the dark and light percentiles
+    const uint16_t tail = num_samples * CAMERA_QUALITY_PERCENTILE / 100;
+    uint8_t dark_bin = 0, light_bin = CAMERA_QUALITY_HISTOGRAM_BINS - 1;
+    for (uint16_t count = histogram[dark_bin]; count <= tail && dark_bin < light_bin;) {
+        count += histogram[++dark_bin];
+    }
+    for (uint16_t count = histogram[light_bin]; count <= tail && light_bin > dark_bin;) {
+        count += histogram[--light_bin];
+    }
+
+    quality->mean = total / num_samples;
+    quality->contrast = (light_bin - dark_bin) * (256 / CAMERA_QUALITY_HISTOGRAM_BINS);
+
+    // Sharpness is the mean gradient energy, normalised by the contrast - blur spreads edges over more pixels,
+    // so reduces the energy (whereas the simple mean gradient would be roughly unchanged).
+    const uint32_t contrast_sq = quality->contrast * quality->contrast;
+    quality->sharpness = contrast_sq ? (100 * (gradient_energy / num_samples)) / contrast_sq : 0;
+}
+
+// Nudge the sensor auto-exposure level and gain ceiling if the image has been consistently too dark or
+// too bright - see camera_exposure_update().
+static void adapt_exposure(camera_quality_state_t* state, const frame_quality_t* quality)
+{
+    JADE_ASSERT(state);
+    JADE_ASSERT(quality);
+
+    const camera_exposure_change_t change = camera_exposure_update(&state->exposure, quality->mean);
+    if (change == CAMERA_EXPOSURE_NO_CHANGE) {
+        return;
+    }
+
+    sensor_t* const camera_sensor = esp_camera_sensor_get();
+    JADE_ASSERT(camera_sensor);
+
+    if (change == CAMERA_EXPOSURE_SET_AE_LEVEL && camera_sensor->set_ae_level) {
+        const int ret = camera_sensor->set_ae_level(camera_sensor, state->exposure.ae_level);
+        JADE_LOGI("Image mean %u - setting camera ae level to %d, returned %d", quality->mean,
+            state->exposure.ae_level, ret);
+    } else if (change == CAMERA_EXPOSURE_SET_GAINCEILING && camera_sensor->set_gainceiling) {
+        const int ret = camera_sensor->set_gainceiling(camera_sensor, state->exposure.gainceiling);
+        JADE_LOGI("Image mean %u - setting camera gain ceiling to %u, returned %d", quality->mean,
+            state->exposure.gainceiling, ret);
+    }
+}
+
+// Whether the frame is worth passing to the processing callback
+static bool frame_worth_processing(camera_quality_state_t* state, const camera_fb_t* fb)
+{
+    JADE_ASSERT(state);
+    JADE_ASSERT(fb);
+
+#ifdef CONFIG_DEBUG_MODE
+    // Any fixed debug image is always processed
+    if (debug_image_data) {
+        return true;
+    }
+#endif
+
+    frame_quality_t quality;
+    assess_frame_quality(fb, &quality);
+    adapt_exposure(state, &quality);
+
+    const bool usable
+        = quality.contrast >= CAMERA_QUALITY_MIN_CONTRAST && quality.sharpness >= CAMERA_QUALITY_MIN_SHARPNESS;
+    if (usable || state->skipped_frames >= CAMERA_QUALITY_MAX_SKIPPED_FRAMES) {
+        state->skipped_frames = 0;
+        return true;
+    }
+
+    JADE_LOGD("Skipping frame - mean %u, contrast %u, sharpness %lu", quality.mean, quality.contrast,
+        quality.sharpness);
+    ++state->skipped_frames;
+    return false;
+}
+
 static inline bool invoke_user_cb_fn(const camera_task_config_t* camera_config, const camera_fb_t* fb)
 {
 #ifdef CONFIG_DEBUG_MODE
@@ -219,6 +350,13 @@ static void jade_camera_task(void* data)
         gui_activity_register_event(act, GUI_BUTTON_EVENT, ESP_EVENT_ANY_ID, sync_wait_event_handler, event_data);
     }
 
+    // Frame quality/exposure tracking, when processing every frame
+    // (Starts from the sensor's current ae-level and gain ceiling)
+    camera_quality_state_t quality_state = { .skipped_frames = 0 };
+    const sensor_t* const camera_sensor = esp_camera_sensor_get();
+    JADE_ASSERT(camera_sensor);
+    camera_exposure_init(&quality_state.exposure, camera_sensor->status.ae_level, camera_sensor->status.gainceiling);
+
     // Loop periodically refreshes screen image from camera, and waits for button event
     bool done = false;
     while (!done) {
@@ -251,10 +389,10 @@ static void jade_camera_task(void* data)
                 gui_set_current_activity(act);
             }
 
-            // If we have no 'click' button, we run the processing callback on every frame
+            // If we have no 'click' button, we run the processing callback on every usable frame
             // (We still test to see if the 'Exit' button is pressed though)
             if (!camera_config->text_button) {
-                done = invoke_user_cb_fn(camera_config, fb)
+                done = (frame_worth_processing(&quality_state, fb) && invoke_user_cb_fn(camera_config, fb))
                     || (sync_wait_event(
                             GUI_BUTTON_EVENT, BTN_CAMERA_EXIT, event_data, NULL, NULL, NULL, 10 / portTICK_PERIOD_MS)
                         == ESP_OK);
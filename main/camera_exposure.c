@@ -0,0 +1,65 @@
+#include "camera_exposure.h"
+#include "jade_assert.h"
+
+#include <stdbool.h>
+
+void camera_exposure_init(camera_exposure_state_t* state, const int8_t ae_level, const uint8_t gainceiling)
+{
+    JADE_ASSERT(state);
+
+    state->streak = 0;
+    state->ae_level = ae_level;
+    if (state->ae_level < CAMERA_AE_LEVEL_MIN) {
+        state->ae_level = CAMERA_AE_LEVEL_MIN;
+    } else if (state->ae_level > CAMERA_AE_LEVEL_MAX) {
+        state->ae_level = CAMERA_AE_LEVEL_MAX;
+    }
+    state->gainceiling = gainceiling < CAMERA_GAINCEILING_MAX ? gainceiling : CAMERA_GAINCEILING_MAX;
+    state->initial_gainceiling = state->gainceiling;
+}
+
+// When too dark, raise the ae-level to its maximum before raising the gain ceiling (which adds noise).
+// When too bright, first undo any gain ceiling raised, then lower the ae-level.
+camera_exposure_change_t camera_exposure_update(camera_exposure_state_t* state, const uint8_t mean)
+{
+    JADE_ASSERT(state);
+
+    if (mean < CAMERA_EXPOSURE_DARK_MEAN) {
+        state->streak = state->streak < 0 ? state->streak - 1 : -1;
+    } else if (mean > CAMERA_EXPOSURE_BRIGHT_MEAN) {
+        state->streak = state->streak > 0 ? state->streak + 1 : 1;
+    } else {
+        state->streak = 0;
+    }
+
+    if (state->streak > -CAMERA_EXPOSURE_ADJUST_FRAMES && state->streak < CAMERA_EXPOSURE_ADJUST_FRAMES) {
+        // Not (yet) consistently too dark or too bright
+        return CAMERA_EXPOSURE_NO_CHANGE;
+    }
+
+    const bool too_dark = state->streak < 0;
+    state->streak = 0;
+
+    if (too_dark) {
+        if (state->ae_level < CAMERA_AE_LEVEL_MAX) {
+            ++state->ae_level;
+            return CAMERA_EXPOSURE_SET_AE_LEVEL;
+        }
+        if (state->gainceiling < CAMERA_GAINCEILING_MAX) {
+            ++state->gainceiling;
+            return CAMERA_EXPOSURE_SET_GAINCEILING;
+        }
+    } else {
+        if (state->gainceiling > state->initial_gainceiling) {
+            --state->gainceiling;
+            return CAMERA_EXPOSURE_SET_GAINCEILING;
+        }
+        if (state->ae_level > CAMERA_AE_LEVEL_MIN) {
+            --state->ae_level;
+            return CAMERA_EXPOSURE_SET_AE_LEVEL;
+        }
+    }
+
+    // Already at the limit
+    return CAMERA_EXPOSURE_NO_CHANGE;
+}
@@ -0,0 +1,47 @@
+#ifndef CAMERA_EXPOSURE_H_
+#define CAMERA_EXPOSURE_H_
+
+#include <stdint.h>
+
+// Exposure control when scanning - the sensor's auto-exposure level (and then its gain ceiling) is nudged
+// when frames are consistently too dark or too bright.  Kept free of any sensor/driver calls so the
+// switching/hysteresis logic can be tested in isolation - the caller applies any change returned.
+
+// Mean brightness below/above these values counts as too dark/bright.  A quarter and three-quarters of
+// the 8-bit range - a wide dead band around the sensor's own mid-grey auto-exposure target, so that a
+// single adjustment does not push the mean straight into the opposite band (which would oscillate).
+#define CAMERA_EXPOSURE_DARK_MEAN 64
+#define CAMERA_EXPOSURE_BRIGHT_MEAN 192
+
+// Consecutive out-of-band frames required before adjusting, so transients (eg. a hand passing in front
+// of the lens, or the sensor's own auto-exposure still settling) do not trigger changes.
+#define CAMERA_EXPOSURE_ADJUST_FRAMES 8
+
+// The range of ae-level accepted by the esp32-camera sensor drivers' set_ae_level()
+#define CAMERA_AE_LEVEL_MIN -2
+#define CAMERA_AE_LEVEL_MAX 2
+
+// The highest gain ceiling index - GAINCEILING_128X in the esp32-camera 'gainceiling_t' enum
+#define CAMERA_GAINCEILING_MAX 6
+
+typedef enum {
+    CAMERA_EXPOSURE_NO_CHANGE,
+    CAMERA_EXPOSURE_SET_AE_LEVEL,
+    CAMERA_EXPOSURE_SET_GAINCEILING
+} camera_exposure_change_t;
+
+typedef struct {
+    int8_t streak; // -ve for consecutive dark frames, +ve for consecutive bright frames
+    int8_t ae_level;
+    uint8_t gainceiling;
+    uint8_t initial_gainceiling;
+} camera_exposure_state_t;
+
+// Initialise from the sensor's current settings
+void camera_exposure_init(camera_exposure_state_t* state, int8_t ae_level, uint8_t gainceiling);
+
+// Update with the mean brightness of the latest frame, and return any change to apply to the sensor
+// (in which case the new ae_level/gainceiling value is in the state).
+camera_exposure_change_t camera_exposure_update(camera_exposure_state_t* state, uint8_t mean);
+
+#endif /* CAMERA_EXPOSURE_H_ */
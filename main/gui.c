@@ -11,10 +11,12 @@
 #include "idletimer.h"
 #include "jade_assert.h"
 #include "jade_tasks.h"
+#include "jade_wally_verify.h"
 #include "power.h"
 #include "qrcode.h"
 #include "random.h"
 #include "storage.h"
+#include "trace.h"
 #include "utils/event.h"
 #include "utils/malloc_ext.h"
 
@@ -29,6 +31,8 @@ typedef struct _activity_holder_t activity_holder_t;
 struct _activity_holder_t {
     gui_activity_t activity;
     activity_holder_t* next;
+    // cached activities are not freed with other managed activities (unless evicted)
+    bool cached;
 };
 
 typedef struct {
@@ -54,6 +58,46 @@ static RingbufHandle_t switch_activities_queue = NULL;
 // Click/select event (ie. which button counts as 'click'/select)
 static gui_event_t gui_click_event = GUI_FRONT_CLICK_EVENT;
 
+// Damaged regions of the current activity, accumulated (under the activities_mutex) and then
+// repainted together on the next gui tick.  Overlapping regions are merged, and if the regions
+// become too fragmented they are collapsed into their bounding rectangle.
+#define GUI_MAX_DAMAGE_RECTS 8
+typedef struct {
+    dispWin_t rects[GUI_MAX_DAMAGE_RECTS];
+    uint8_t num_rects;
+} damage_t;
+static damage_t damage = { .num_rects = 0 };
+
+// The damaged area being repainted (under the paint_mutex) - all painting is clipped to this region.
+// NULL when not repainting damage, in which case painting is unclipped.
+static const dispWin_t* repaint_clip = NULL;
+
+// Entries in the cache of reusable activities (see gui_activity_cache_*() functions below)
+// If free DRAM falls below the threshold, cached activities not in use are evicted.
+#define GUI_ACTIVITY_CACHE_MIN_FREE_DRAM (32 * 1024)
+static gui_activity_cache_entry_t* activity_cache_entries = NULL;
+static bool activity_cache_evict_requested = false;
+
+// The activities currently being built, and the tasks building them (one per task, as several tasks
+// may build activities at once).  The nodes, node data and strings made by such a task are allocated
+// from its activity's arena (and freed with it), anything else is allocated from the heap as usual.
+// An activity is being built from when it is made until it is first shown, freed, or the same task
+// makes another activity.
+// Only read/written under the 'building_activity_lock' spinlock.
+#define GUI_ACTIVITY_ARENA_CHUNK_SIZE 2048
+#define GUI_MAX_BUILDING_TASKS 4
+static portMUX_TYPE building_activity_lock = portMUX_INITIALIZER_UNLOCKED;
+static struct {
+    TaskHandle_t task;
+    gui_activity_t* activity;
+} building_activities[GUI_MAX_BUILDING_TASKS];
+
+// How often the status bar polls the connection state, and how many polls between battery updates.
+// While nothing changes the poll interval doubles, up to the maximum, so static screens are rarely woken.
+#define GUI_STATUS_BAR_POLL_MIN_MS 500
+#define GUI_STATUS_BAR_POLL_MAX_MS 2000
+#define GUI_STATUS_BAR_BATTERY_POLLS 6
+
 // status bar
 struct {
     gui_view_node_t* root;
@@ -67,6 +111,8 @@ struct {
     bool last_usb_val;
     bool last_ble_val;
     uint8_t battery_update_counter;
+    TickType_t next_poll;
+    TickType_t poll_interval;
 
     TaskHandle_t task_handle;
 
@@ -75,11 +121,135 @@ struct {
 
 // Utils
 static inline uint16_t min(uint16_t a, uint16_t b) { return a < b ? a : b; }
+static inline uint16_t max(uint16_t a, uint16_t b) { return a > b ? a : b; }
+
+static inline bool rects_intersect(const dispWin_t* a, const dispWin_t* b)
+{
+    return a->x1 < b->x2 && b->x1 < a->x2 && a->y1 < b->y2 && b->y1 < a->y2;
+}
+
+// As above, but also true for rectangles which share an edge (and so can be merged)
+static inline bool rects_touch(const dispWin_t* a, const dispWin_t* b)
+{
+    return a->x1 <= b->x2 && b->x1 <= a->x2 && a->y1 <= b->y2 && b->y1 <= a->y2;
+}
+
+static inline void rect_union(dispWin_t* a, const dispWin_t* b)
+{
+    a->x1 = min(a->x1, b->x1);
+    a->y1 = min(a->y1, b->y1);
+    a->x2 = max(a->x2, b->x2);
+    a->y2 = max(a->y2, b->y2);
+}
 
 static void gui_task(void* args);
 
+// Number of ticks in a gui frame - the timing unit of updatables (eg. scrolling text, animations)
+static inline TickType_t gui_frame_ticks(void) { return 1000 / GUI_TARGET_FRAMERATE / portTICK_PERIOD_MS; }
+
+// Is the given tick count due/passed (handling tick-count wrap)
+static inline bool tick_due(const TickType_t deadline, const TickType_t now) { return (int32_t)(now - deadline) >= 0; }
+
+// Wake the gui task to handle new activities, damaged areas, status-bar changes etc.
+static inline void gui_wake(void)
+{
+    if (gui_task_handle) {
+        xTaskNotifyGive(gui_task_handle);
+    }
+}
+
+// The activity being built by the calling task, if any
+static gui_activity_t* get_building_activity(void)
+{
+    const TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    gui_activity_t* activity = NULL;
+    portENTER_CRITICAL(&building_activity_lock);
+    for (size_t i = 0; i < GUI_MAX_BUILDING_TASKS; ++i) {
+        if (building_activities[i].activity && building_activities[i].task == task) {
+            activity = building_activities[i].activity;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&building_activity_lock);
+    return activity;
+}
+
+// Set the activity being built by the calling task, replacing any it was building previously.
+// Returns false if too many tasks are building activities, in which case the activity is built from the heap.
+static bool set_building_activity(gui_activity_t* activity)
+{
+    JADE_ASSERT(activity);
+
+    const TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    size_t slot = GUI_MAX_BUILDING_TASKS;
+    portENTER_CRITICAL(&building_activity_lock);
+    for (size_t i = 0; i < GUI_MAX_BUILDING_TASKS; ++i) {
+        if (building_activities[i].activity && building_activities[i].task == task) {
+            slot = i;
+            break;
+        }
+        if (!building_activities[i].activity && slot == GUI_MAX_BUILDING_TASKS) {
+            slot = i;
+        }
+    }
+    if (slot < GUI_MAX_BUILDING_TASKS) {
+        building_activities[slot].task = task;
+        building_activities[slot].activity = activity;
+    }
+    portEXIT_CRITICAL(&building_activity_lock);
+    return slot < GUI_MAX_BUILDING_TASKS;
+}
+
+// The activity is no longer being built (eg. as it is being freed) by whichever task was building it
+static void clear_building_activity(const gui_activity_t* activity)
+{
+    JADE_ASSERT(activity);
+
+    portENTER_CRITICAL(&building_activity_lock);
+    for (size_t i = 0; i < GUI_MAX_BUILDING_TASKS; ++i) {
+        if (building_activities[i].activity == activity) {
+            building_activities[i].activity = NULL;
+            building_activities[i].task = NULL;
+        }
+    }
+    portEXIT_CRITICAL(&building_activity_lock);
+}
+
+// Allocate zeroed memory for the given activity - from its arena if it is being built by this task
+static void* activity_calloc(gui_activity_t* activity, const size_t size)
+{
+    if (activity && activity == get_building_activity()) {
+        return arena_calloc(&activity->arena, 1, size);
+    }
+    return JADE_CALLOC(1, size);
+}
+
+// Duplicate a string for the given activity - into its arena if it is being built by this task
+static char* activity_strdup(gui_activity_t* activity, const char* str)
+{
+    JADE_ASSERT(str);
+    const size_t len = strlen(str) + 1;
+    char* const ptr = activity_calloc(activity, len);
+    memcpy(ptr, str, len);
+    return ptr;
+}
+
+// Allocate zeroed memory for a node being made - from the arena of the activity being built by this task, if any
+static inline void* building_calloc(const size_t size) { return activity_calloc(get_building_activity(), size); }
+
+// Free memory allocated for the given activity - anything in its arena is released with the activity
+static void activity_free(gui_activity_t* activity, void* ptr)
+{
+    if (ptr && !(activity && arena_owns(&activity->arena, ptr))) {
+        free(ptr);
+    }
+}
+
 static void make_status_bar(void)
 {
+    // The status bar outlives all activities, so must not be allocated from any activity's arena
+    JADE_ASSERT(!get_building_activity());
+
     gui_view_node_t* root;
     gui_make_fill(&root, TFT_BLACK);
     root->parent = NULL;
@@ -123,6 +293,7 @@ static void make_status_bar(void)
     status_bar.updated = false;
     status_bar.last_battery_val = 0xFF;
     status_bar.battery_update_counter = 0;
+    status_bar.poll_interval = GUI_STATUS_BAR_POLL_MIN_MS / portTICK_PERIOD_MS;
 }
 
 gui_event_t gui_get_click_event(void) { return gui_click_event; }
@@ -152,8 +323,13 @@ void gui_init(void)
     }
     JADE_ASSERT(gui_click_event == GUI_FRONT_CLICK_EVENT || gui_click_event == GUI_WHEEL_CLICK_EVENT);
 
-    // create a blank activity
+    // Create status-bar - before any activity is made, so its nodes are allocated from the heap
+    // (and not from the arena of an activity, to be released with it)
+    make_status_bar();
+
+    // create a blank activity - nothing further is built into it
     gui_make_activity(&current_activity, false, NULL);
+    clear_building_activity(current_activity);
 
     // create the default event loop used by btns
     const esp_err_t rc = esp_event_loop_create_default();
@@ -163,9 +339,6 @@ void gui_init(void)
     switch_activities_queue = xRingbufferCreate(32, RINGBUF_TYPE_NOSPLIT);
     JADE_ASSERT(switch_activities_queue);
 
-    // Create status-bar
-    make_status_bar();
-
     // Create (high priority) gui task
     BaseType_t retval = xTaskCreatePinnedToCore(
         gui_task, "gui", 3 * 1024, NULL, JADE_TASK_PRIO_GUI, &gui_task_handle, JADE_CORE_SECONDARY);
@@ -450,7 +623,7 @@ static void push_selectable(gui_activity_t* activity, gui_view_node_t* node, uin
     JADE_ASSERT(node);
     JADE_ASSERT(is_kind_selectable(node->kind));
 
-    selectable_t* us = JADE_CALLOC(1, sizeof(selectable_t));
+    selectable_t* us = activity_calloc(activity, sizeof(selectable_t));
 
     us->node = node;
     us->x = x;
@@ -495,12 +668,13 @@ static void push_updatable(
     JADE_ASSERT(node);
 
     // allocate & fill all the fields
-    updatable_t* us = JADE_CALLOC(1, sizeof(updatable_t));
+    updatable_t* us = activity_calloc(activity, sizeof(updatable_t));
 
     us->node = node;
 
     us->callback = callback;
     us->extra_args = extra_args;
+    us->next_update = xTaskGetTickCount();
 
     // first one!
     if (!activity->updatables) {
@@ -513,6 +687,28 @@ static void push_updatable(
         }
         current->next = us;
     }
+
+    // If the activity is already being shown, wake the gui task to run the new updatable
+    if (activity == current_activity) {
+        gui_wake();
+    }
+}
+
+// Resume any idle updatables for the passed node, waking the gui task if the node's activity is being shown
+static void resume_updatables(gui_view_node_t* node)
+{
+    JADE_ASSERT(node);
+    JADE_ASSERT(node->activity);
+
+    for (updatable_t* current = node->activity->updatables; current; current = current->next) {
+        if (current->node == node && current->idle) {
+            current->next_update = xTaskGetTickCount();
+            current->idle = false;
+            if (node->activity == current_activity) {
+                gui_wake();
+            }
+        }
+    }
 }
 
 // Create a new/initialised activity
@@ -524,6 +720,7 @@ static void push_updatable(
 // If not 'managed', just create and return the activity - the caller must free by calling
 // free_unmanaged_activity() explicitly - this may be required for long-lived activities
 // (eg. the main dashboard screen) or for particularly large activities which need freeing asap.
+// Frequently shown managed activities can instead be cached for reuse - see gui_activity_cache_add().
 void gui_make_activity_ex(gui_activity_t** ppact, const bool has_status_bar, const char* title, const bool managed)
 {
     JADE_INIT_OUT_PPTR(ppact);
@@ -556,15 +753,20 @@ void gui_make_activity_ex(gui_activity_t** ppact, const bool has_status_bar, con
     }
     activity->status_bar = has_status_bar;
 
+    // Subsequent nodes made by this task are allocated from this activity's arena
+    arena_init(&activity->arena, GUI_ACTIVITY_ARENA_CHUNK_SIZE);
+    if (!set_building_activity(activity)) {
+        JADE_LOGW("Too many tasks building gui activities - activity at %p allocated from the heap", activity);
+    }
+
     if (title) {
-        activity->title = strdup(title);
-        JADE_ASSERT(activity->title);
+        activity->title = activity_strdup(activity, title);
     }
 
     gui_view_node_t* bg;
     gui_make_fill(&bg, TFT_BLACK);
+    JADE_ASSERT(bg->activity == activity);
     activity->root_node = bg;
-    activity->root_node->activity = activity;
 }
 
 // Create a new/initialised activity, and add to the stack of existing activities
@@ -573,6 +775,119 @@ void gui_make_activity(gui_activity_t** ppact, const bool has_status_bar, const
     gui_make_activity_ex(ppact, has_status_bar, title, true);
 }
 
+// Find the holder of a managed activity - NULL if not a managed activity
+// NOTE: must be called with the activities_mutex held
+static activity_holder_t* get_activity_holder(const gui_activity_t* activity)
+{
+    for (activity_holder_t* holder = existing_activities; holder; holder = holder->next) {
+        if (&holder->activity == activity) {
+            return holder;
+        }
+    }
+    return NULL;
+}
+
+// Clear a cache entry, leaving its activities to be freed along with other managed activities
+// NOTE: must be called with the activities_mutex held
+static void evict_cache_entry(gui_activity_cache_entry_t* entry)
+{
+    JADE_ASSERT(entry);
+    JADE_ASSERT(!entry->held);
+
+    for (size_t i = 0; i < entry->num_activities; ++i) {
+        activity_holder_t* const holder = get_activity_holder(entry->activities[i]);
+        JADE_ASSERT(holder);
+        holder->cached = false;
+        entry->activities[i] = NULL;
+    }
+    entry->num_activities = 0;
+}
+
+// Evict all cache entries not held and not containing the passed activity
+// NOTE: must be called with the activities_mutex held
+static void evict_cache_entries(const gui_activity_t* retain)
+{
+    for (gui_activity_cache_entry_t* entry = activity_cache_entries; entry; entry = entry->next) {
+        bool retained = entry->held;
+        for (size_t i = 0; i < entry->num_activities && !retained; ++i) {
+            retained = entry->activities[i] == retain;
+        }
+        if (!retained && entry->num_activities) {
+            JADE_LOGI("Evicting %u cached gui activities", entry->num_activities);
+            evict_cache_entry(entry);
+        }
+    }
+}
+
+// Cache of frequently shown activities, which are built once and then rebound to fresh data each
+// time they are shown.  Returns true if the entry holds activities built for the passed key - if so
+// they can be reused.  If not, the caller should build the activities and add them to the entry.
+// NOTE: any activities previously cached for a different key are evicted.
+bool gui_activity_cache_lookup(gui_activity_cache_entry_t* entry, const uint32_t key)
+{
+    JADE_ASSERT(entry);
+
+    JADE_SEMAPHORE_TAKE(activities_mutex);
+    const bool hit = entry->num_activities && entry->key == key;
+    if (!hit && entry->num_activities) {
+        evict_cache_entry(entry);
+    }
+    JADE_SEMAPHORE_GIVE(activities_mutex);
+
+    return hit;
+}
+
+// Add a newly made (managed) activity to the cache entry for the passed key.
+// Cached activities are not freed by gui_set_current_activity_ex(), but may be evicted when memory is low.
+// NOTE: once evicted, cached activities have the same lifetime as any other managed activity - so an entry
+// whose activities must survive beyond the next gui_set_current_activity_ex() should be 'held' while in use.
+void gui_activity_cache_add(gui_activity_cache_entry_t* entry, const uint32_t key, gui_activity_t* activity)
+{
+    JADE_ASSERT(entry);
+    JADE_ASSERT(activity);
+
+    JADE_SEMAPHORE_TAKE(activities_mutex);
+    JADE_ASSERT(!entry->num_activities || entry->key == key);
+    JADE_ASSERT(entry->num_activities < GUI_ACTIVITY_CACHE_ENTRY_MAX_ACTIVITIES);
+
+    activity_holder_t* const holder = get_activity_holder(activity);
+    JADE_ASSERT_MSG(holder, "Only managed activities can be cached");
+    holder->cached = true;
+
+    entry->key = key;
+    entry->activities[entry->num_activities++] = activity;
+
+    // Add the entry to the list of cache entries, if not already present
+    gui_activity_cache_entry_t* existing = activity_cache_entries;
+    while (existing && existing != entry) {
+        existing = existing->next;
+    }
+    if (!existing) {
+        entry->next = activity_cache_entries;
+        activity_cache_entries = entry;
+    }
+    JADE_SEMAPHORE_GIVE(activities_mutex);
+}
+
+// Mark a cache entry as in-use (or not) - held entries are never evicted
+void gui_activity_cache_hold(gui_activity_cache_entry_t* entry, const bool hold)
+{
+    JADE_ASSERT(entry);
+
+    JADE_SEMAPHORE_TAKE(activities_mutex);
+    entry->held = hold;
+    JADE_SEMAPHORE_GIVE(activities_mutex);
+}
+
+// Evict all cached activities not held or current, at the next gui_set_current_activity_ex()
+// eg. before some memory intensive operation
+void gui_activity_cache_evict(void)
+{
+    JADE_SEMAPHORE_TAKE(activities_mutex);
+    activity_cache_evict_requested = true;
+    JADE_SEMAPHORE_GIVE(activities_mutex);
+}
+
 // free a linked list of selectable_t
 static void free_selectables(gui_activity_t* activity)
 {
@@ -581,11 +896,11 @@ static void free_selectables(gui_activity_t* activity)
     selectable_t* const begin = activity->selectables;
     if (begin) {
         selectable_t* current = begin->next;
-        free(begin);
+        activity_free(activity, begin);
 
         while (current != begin) {
             selectable_t* const next = current->next;
-            free(current);
+            activity_free(activity, current);
             current = next;
         }
     }
@@ -599,7 +914,7 @@ static void free_updatables(gui_activity_t* activity)
     updatable_t* current = activity->updatables;
     while (current) {
         updatable_t* const next = current->next;
-        free(current);
+        activity_free(activity, current);
         current = next;
     }
 }
@@ -612,7 +927,7 @@ static void free_activity_events(gui_activity_t* activity)
     activity_event_t* current = activity->activity_events;
     while (current) {
         activity_event_t* const next = current->next;
-        free(current);
+        activity_free(activity, current);
         current = next;
     }
 }
@@ -626,7 +941,7 @@ static void free_wait_data_items(gui_activity_t* activity)
     while (current) {
         wait_data_t* const next = current->next;
         free_wait_event_data(current->event_data);
-        free(current);
+        activity_free(activity, current);
         current = next;
     }
 }
@@ -644,10 +959,13 @@ static void free_activity_internals(gui_activity_t* activity)
     free_wait_data_items(activity);
 
     free_view_node(activity->root_node);
+    activity_free(activity, activity->title);
 
-    if (activity->title) {
-        free(activity->title);
-    }
+    // No further allocations from this activity's arena
+    clear_building_activity(activity);
+
+    // Release all the nodes, data and strings allocated from the arena in one go
+    arena_release(&activity->arena);
 }
 
 // Free an activity-holder and all of the activity contents (title, selectables/updatables etc.)
@@ -732,7 +1050,8 @@ static void set_tree_activity(gui_view_node_t* node, gui_activity_t* activity)
     JADE_ASSERT(node);
     // JADE_ASSERT(activity); TODO: does it make sense to allow to set a NULL activity? we use it for the status bar
 
-    JADE_ASSERT(!node->activity);
+    // Nodes made while building an activity are allocated from (and so can only be attached within) that activity
+    JADE_ASSERT(!node->activity || node->activity == activity);
 
     // set our
     node->activity = activity;
@@ -779,14 +1098,14 @@ void free_view_node(gui_view_node_t* node)
 
     // call the destructor if it's set
     if (node->free_callback) {
-        node->free_callback(node->data);
+        node->free_callback(node);
     }
 
     // free any borders
-    free(node->borders);
+    activity_free(node->activity, node->borders);
 
     // free the extra data struct
-    free(node->data);
+    activity_free(node->activity, node->data);
 
     if (node->child) {
         free_view_node(node->child);
@@ -796,61 +1115,84 @@ void free_view_node(gui_view_node_t* node)
         free_view_node(node->sibling);
     }
 
-    free(node);
+    activity_free(node->activity, node);
 }
 
 // destructor for {v,h}split nodes
-static void free_view_node_split_data(void* vdata)
+static void free_view_node_split_data(gui_view_node_t* node)
 {
-    JADE_ASSERT(vdata);
-    struct view_node_split_data* data = vdata;
-    free(data->values);
+    JADE_ASSERT(node);
+    JADE_ASSERT(node->split);
+    activity_free(node->activity, node->split->values);
 }
 
 // destructor for text nodes
-static void free_view_node_text_data(void* vdata)
+// free any offscreen rendering of scrolling text
+static void free_text_scroll_strip(struct view_node_text_scroll_data* scroll)
 {
-    JADE_ASSERT(vdata);
-    struct view_node_text_data* data = vdata;
+    JADE_ASSERT(scroll);
+    free(scroll->strip);
+    free(scroll->strip_char_x);
+    scroll->strip = NULL;
+    scroll->strip_char_x = NULL;
+    scroll->strip_width = 0;
+}
+
+static void free_view_node_text_data(gui_view_node_t* node)
+{
+    JADE_ASSERT(node);
+    JADE_ASSERT(node->text);
+    struct view_node_text_data* data = node->text;
 
     // free the char* that we allocated
-    free(data->text);
+    activity_free(node->activity, data->text);
 
     // also the scroll struct if present
     if (data->scroll) {
-        free(data->scroll);
+        free_text_scroll_strip(data->scroll);
+        activity_free(node->activity, data->scroll);
     }
 
     // and also the noise struct if present
-    if (data->noise) {
-        free(data->noise);
-    }
+    activity_free(node->activity, data->noise);
 }
 
 // destructor for text nodes
-static void free_view_node_icon_data(void* vdata)
+static void free_view_node_icon_data(gui_view_node_t* node)
 {
-    JADE_ASSERT(vdata);
-    struct view_node_icon_data* data = vdata;
+    JADE_ASSERT(node);
+    JADE_ASSERT(node->icon);
+    struct view_node_icon_data* data = node->icon;
 
     // free the animation struct if present
     if (data->animation) {
-        // NOTE: we owned the animation frames
-        for (int i = 0; i < data->animation->num_icons; ++i) {
-            // Free the icon data
-            free(data->animation->icons[i].data);
+        // NOTE: we owned the animation frames, or the generator of them
+        if (data->animation->generator) {
+            if (data->animation->free_generator_ctx) {
+                data->animation->free_generator_ctx(data->animation->generator_ctx);
+            }
+        } else {
+            for (int i = 0; i < data->animation->num_icons; ++i) {
+                // Free the icon data
+                free(data->animation->icons[i].data);
+            }
+            free(data->animation->icons);
         }
-        free(data->animation->icons);
-        free(data->animation);
+        activity_free(node->activity, data->animation);
     }
 }
 
 // make the underlying view node, common across all the gui_make_* functions
-static void make_view_node(gui_view_node_t** ptr, enum view_node_kind kind, void* data, free_callback_t free_callback)
+// NOTE: nodes made while building an activity belong to that activity from the outset, as they
+// (and their data) are allocated from its arena.
+static void make_view_node(
+    gui_view_node_t** ptr, enum view_node_kind kind, void* data, view_node_free_callback_t free_callback)
 {
     JADE_INIT_OUT_PPTR(ptr);
 
-    *ptr = JADE_CALLOC(1, sizeof(gui_view_node_t));
+    gui_activity_t* const activity = get_building_activity();
+    *ptr = activity_calloc(activity, sizeof(gui_view_node_t));
+    (*ptr)->activity = activity;
 
     (*ptr)->render_data.is_first_time = true;
 
@@ -870,13 +1212,13 @@ static void make_split_node(
     JADE_INIT_OUT_PPTR(ptr);
     JADE_ASSERT(split_kind == HSPLIT || split_kind == VSPLIT);
 
-    struct view_node_split_data* data = JADE_CALLOC(1, sizeof(struct view_node_split_data));
+    struct view_node_split_data* data = building_calloc(sizeof(struct view_node_split_data));
 
     data->kind = kind;
     data->parts = parts;
 
     // copy the values
-    data->values = JADE_CALLOC(1, sizeof(uint8_t) * parts);
+    data->values = building_calloc(sizeof(uint8_t) * parts);
 
     for (uint8_t i = 0; i < parts; i++) {
         data->values[i] = va_arg(values, uint32_t);
@@ -910,7 +1252,7 @@ void gui_make_button(gui_view_node_t** ptr, color_t color, uint32_t event_id, vo
 {
     JADE_INIT_OUT_PPTR(ptr);
 
-    struct view_node_button_data* data = JADE_CALLOC(1, sizeof(struct view_node_button_data));
+    struct view_node_button_data* data = building_calloc(sizeof(struct view_node_button_data));
 
     // by default same color
     data->color = color;
@@ -926,7 +1268,7 @@ void gui_make_fill(gui_view_node_t** ptr, color_t color)
 {
     JADE_INIT_OUT_PPTR(ptr);
 
-    struct view_node_fill_data* data = JADE_CALLOC(1, sizeof(struct view_node_fill_data));
+    struct view_node_fill_data* data = building_calloc(sizeof(struct view_node_fill_data));
 
     // by default same color
     data->color = color;
@@ -945,11 +1287,11 @@ void gui_make_text_font(gui_view_node_t** ptr, const char* text, color_t color,
     JADE_INIT_OUT_PPTR(ptr);
     JADE_ASSERT(text);
 
-    struct view_node_text_data* data = JADE_CALLOC(1, sizeof(struct view_node_text_data));
+    struct view_node_text_data* data = building_calloc(sizeof(struct view_node_text_data));
 
     // max chars limited to GUI_MAX_TEXT_LENGTH
     const size_t len = min(GUI_MAX_TEXT_LENGTH, strlen(text) + 1);
-    data->text = JADE_MALLOC(len);
+    data->text = building_calloc(len);
     const int ret = snprintf(data->text, len, "%s", text); // cut to len
     JADE_ASSERT(ret >= 0); // truncation is acceptable here, as is empty string
 
@@ -979,7 +1321,7 @@ void gui_make_icon(gui_view_node_t** ptr, const Icon* icon, color_t color, const
     JADE_INIT_OUT_PPTR(ptr);
     JADE_ASSERT(icon);
 
-    struct view_node_icon_data* data = JADE_CALLOC(1, sizeof(struct view_node_icon_data));
+    struct view_node_icon_data* data = building_calloc(sizeof(struct view_node_icon_data));
 
     data->icon = *icon;
 
@@ -1001,31 +1343,47 @@ void gui_make_icon(gui_view_node_t** ptr, const Icon* icon, color_t color, const
     make_view_node(ptr, ICON, data, free_view_node_icon_data);
 }
 
-static bool icon_animation_frame_callback(gui_view_node_t* node, void* extra_args)
+static bool icon_animation_frame_callback(gui_view_node_t* node, void* extra_args, uint32_t* wait_frames)
 {
+    JADE_ASSERT(wait_frames);
+
     // no node, invalid node, not yet renreded...
     if (!node || node->kind != ICON || node->render_data.is_first_time) {
+        *wait_frames = 0;
         return false;
     }
 
     // animation not applicable
     struct view_node_icon_animation_data* animation_data = node->icon->animation;
-    if (!animation_data || !animation_data->frames_per_icon || animation_data->num_icons <= 1) {
+    if (!animation_data || !animation_data->frames_per_icon
+        || (!animation_data->generator && animation_data->num_icons <= 1)) {
+        *wait_frames = GUI_UPDATABLE_IDLE;
         return false;
     }
 
+    // Rather than being called every frame to count down the frames between icons,
+    // ask to be called again only when the wait is over.
     if (animation_data->current_frame > 0) {
-        // do nothing this frame, just count
-        --animation_data->current_frame;
+        *wait_frames = animation_data->current_frame - 1;
+        animation_data->current_frame = 0;
         return false;
     }
 
     // Update main icon
-    animation_data->current_icon = (animation_data->current_icon + 1) % animation_data->num_icons;
-    node->icon->icon = animation_data->icons[animation_data->current_icon];
+    if (animation_data->generator) {
+        // If the generator has no new frame ready, try again next frame
+        if (!animation_data->generator(animation_data->generator_ctx, &node->icon->icon)) {
+            *wait_frames = 0;
+            return false;
+        }
+    } else {
+        animation_data->current_icon = (animation_data->current_icon + 1) % animation_data->num_icons;
+        node->icon->icon = animation_data->icons[animation_data->current_icon];
+    }
 
-    // Reset frame counter
-    animation_data->current_frame = animation_data->frames_per_icon;
+    // Wait the given number of frames before the next icon
+    *wait_frames = animation_data->frames_per_icon;
+    animation_data->current_frame = 0;
 
     // Redraw icon
     return true;
@@ -1040,7 +1398,8 @@ void gui_set_icon_animation(gui_view_node_t* node, Icon* icons, const size_t num
     JADE_ASSERT(num_icons);
     JADE_ASSERT(frames_per_icon || num_icons == 1);
 
-    struct view_node_icon_animation_data* animation_data = JADE_CALLOC(1, sizeof(struct view_node_icon_animation_data));
+    struct view_node_icon_animation_data* animation_data
+        = activity_calloc(node->activity, sizeof(struct view_node_icon_animation_data));
 
     animation_data->icons = icons;
     animation_data->num_icons = num_icons;
@@ -1058,11 +1417,41 @@ void gui_set_icon_animation(gui_view_node_t* node, Icon* icons, const size_t num
     }
 }
 
+// Animate an icon with frames fetched on demand from the passed generator.
+// If 'frames_per_icon' is zero the icon is static, and the generator is never polled.
+// NOTE: takes ownership of the generator ctx, which is freed with 'free_ctx' (if passed)
+// when the node is freed.
+void gui_set_icon_generator(gui_view_node_t* node, gui_icon_generator_fn_t generator, void* ctx,
+    free_callback_t free_ctx, const size_t frames_per_icon)
+{
+    JADE_ASSERT(node);
+    JADE_ASSERT(node->kind == ICON);
+    JADE_ASSERT(!node->icon->animation);
+    JADE_ASSERT(generator);
+
+    struct view_node_icon_animation_data* animation_data
+        = activity_calloc(node->activity, sizeof(struct view_node_icon_animation_data));
+
+    animation_data->generator = generator;
+    animation_data->generator_ctx = ctx;
+    animation_data->free_generator_ctx = free_ctx;
+
+    animation_data->frames_per_icon = frames_per_icon;
+    animation_data->current_frame = frames_per_icon;
+
+    node->icon->animation = animation_data;
+
+    // If animated, push this to the list of updatable elements so that the image gets periodically updated.
+    if (frames_per_icon) {
+        push_updatable(node->activity, node, icon_animation_frame_callback, NULL);
+    }
+}
+
 void gui_make_picture(gui_view_node_t** ptr, const Picture* picture)
 {
     JADE_INIT_OUT_PPTR(ptr);
 
-    struct view_node_picture_data* data = JADE_CALLOC(1, sizeof(struct view_node_picture_data));
+    struct view_node_picture_data* data = building_calloc(sizeof(struct view_node_picture_data));
 
     data->picture = picture;
 
@@ -1198,7 +1587,7 @@ void gui_set_borders(gui_view_node_t* node, color_t color, uint8_t thickness, ui
     JADE_ASSERT(node);
 
     if (!node->borders) {
-        node->borders = JADE_MALLOC(sizeof(gui_border_t));
+        node->borders = activity_calloc(node->activity, sizeof(gui_border_t));
     }
     // by default same color
     node->borders->color = color;
@@ -1291,29 +1680,19 @@ static inline bool can_text_fit(const char* text, uint32_t font, dispWin_t cs)
     return TFT_getStringWidth(text) <= cs.x2 - cs.x1;
 }
 
-// move to the next frame of a scrolling text node
-static bool text_scroll_frame_callback(gui_view_node_t* node, void* extra_args)
+// Advance the text scroll by one step, setting the number of frames to wait before the next step
+// (or zero if the text fits and there is nothing to scroll).
+static bool text_scroll_step(gui_view_node_t* node)
 {
-    // no node, invalid node, not yet renreded...
-    if (!node || node->kind != TEXT || node->render_data.is_first_time) {
-        return false;
-    }
-
-    // do nothing this frame
-    if (node->text->scroll->wait > 0) {
-        node->text->scroll->wait--;
-        return false;
-    }
-
     // the string can fit entirely in its box, no need to scroll. we might need to reset stuff though, if the text has
     // changed
     if (can_text_fit(node->render_data.resolved_text, node->text->font, node->render_data.padded_constraints)) {
         uint8_t old_offset = node->text->scroll->offset;
 
-        // set offset to zero and wait a little before checking again
+        // set offset to zero - no further steps are needed unless the text is changed
         node->text->scroll->going_back = false;
         node->text->scroll->offset = 0;
-        node->text->scroll->wait = GUI_SCROLL_WAIT_END;
+        node->text->scroll->wait = 0;
 
         // only repaint on screen if the offset was not zero
         return old_offset != 0;
@@ -1355,13 +1734,40 @@ static bool text_scroll_frame_callback(gui_view_node_t* node, void* extra_args)
     return true;
 }
 
+// move to the next frame of a scrolling text node
+static bool text_scroll_frame_callback(gui_view_node_t* node, void* extra_args, uint32_t* wait_frames)
+{
+    JADE_ASSERT(wait_frames);
+
+    // no node, invalid node, not yet renreded...
+    if (!node || node->kind != TEXT || node->render_data.is_first_time) {
+        *wait_frames = 0;
+        return false;
+    }
+
+    // Rather than being called every frame to count down the 'wait' frames, ask to
+    // be called again only when the wait is over (eg. the initial wait before scrolling starts).
+    if (node->text->scroll->wait) {
+        *wait_frames = node->text->scroll->wait;
+        node->text->scroll->wait = 0;
+        return false;
+    }
+
+    // If the text fits there is nothing to scroll, so go idle until the text is changed
+    const bool repaint = text_scroll_step(node);
+    *wait_frames = node->text->scroll->wait ? node->text->scroll->wait : GUI_UPDATABLE_IDLE;
+    node->text->scroll->wait = 0;
+    return repaint;
+}
+
 void gui_set_text_scroll(gui_view_node_t* node, color_t background_color)
 {
     JADE_ASSERT(node);
     JADE_ASSERT(node->kind == TEXT);
     JADE_ASSERT(!node->text->scroll); // the node is already scrolling...
 
-    struct view_node_text_scroll_data* scroll_data = JADE_CALLOC(1, sizeof(struct view_node_text_scroll_data));
+    struct view_node_text_scroll_data* scroll_data
+        = activity_calloc(node->activity, sizeof(struct view_node_text_scroll_data));
 
     // wait a little before it starts moving
     scroll_data->offset = 0;
@@ -1380,7 +1786,8 @@ void gui_set_text_noise(gui_view_node_t* node, color_t background_color)
     JADE_ASSERT(node->kind == TEXT);
     JADE_ASSERT(!node->text->scroll); // if the node is scrolling we will not allow adding noise ...
 
-    struct view_node_text_noise_data* noise_data = JADE_MALLOC(sizeof(struct view_node_text_noise_data));
+    struct view_node_text_noise_data* noise_data
+        = activity_calloc(node->activity, sizeof(struct view_node_text_noise_data));
     noise_data->background_color = background_color;
 
     node->text->noise = noise_data;
@@ -1430,6 +1837,75 @@ static inline gui_view_node_t* gui_get_root_node(gui_view_node_t* node)
     return root;
 }
 
+// Mark a node of the current activity as damaged, so its area is repainted on the next gui tick.
+// NOTE: caller must hold the activities_mutex
+static void gui_damage_node(gui_view_node_t* node)
+{
+    JADE_ASSERT(node);
+
+    // If not yet rendered, or already damaged, nothing to do
+    if (node->render_data.is_first_time || node->render_data.is_dirty) {
+        return;
+    }
+
+    // If the node has no area there is nothing to repaint (and it would never be reached by the repaint)
+    dispWin_t rect = node->render_data.original_constraints;
+    if (rect.x1 >= rect.x2 || rect.y1 >= rect.y2) {
+        return;
+    }
+    node->render_data.is_dirty = true;
+
+    // Merge with any overlapping (or adjacent) damaged areas already recorded
+    for (uint8_t i = 0; i < damage.num_rects;) {
+        if (rects_touch(&damage.rects[i], &rect)) {
+            rect_union(&rect, &damage.rects[i]);
+            damage.rects[i] = damage.rects[--damage.num_rects];
+            i = 0; // the enlarged area may now touch areas already checked
+        } else {
+            ++i;
+        }
+    }
+
+    // If too fragmented, collapse into a single bounding rectangle
+    if (damage.num_rects == GUI_MAX_DAMAGE_RECTS) {
+        for (uint8_t i = 0; i < damage.num_rects; ++i) {
+            rect_union(&rect, &damage.rects[i]);
+        }
+        damage.num_rects = 0;
+    }
+    damage.rects[damage.num_rects++] = rect;
+
+    // Wake the gui task to repaint
+    gui_wake();
+}
+
+// Repaint the damaged areas of the current activity - for each area only the nodes which intersect it are
+// visited (reusing their existing layout), and all painting is clipped to the area.
+static void repaint_damage(void)
+{
+    JADE_SEMAPHORE_TAKE(activities_mutex);
+
+    if (damage.num_rects && current_activity && current_activity->root_node) {
+        JADE_TRACE_BEGIN("gui_repaint");
+        JADE_SEMAPHORE_TAKE(paint_mutex);
+        for (uint8_t i = 0; i < damage.num_rects; ++i) {
+            // NOTE: the tft clip area is inclusive, the damaged area is not
+            const dispWin_t* const rect = damage.rects + i;
+            const dispWin_t clip = { .x1 = rect->x1, .y1 = rect->y1, .x2 = rect->x2 - 1, .y2 = rect->y2 - 1 };
+            repaint_clip = rect;
+            TFT_setPaintClip(&clip);
+            gui_repaint(current_activity->root_node, false);
+        }
+        TFT_setPaintClip(NULL);
+        repaint_clip = NULL;
+        JADE_SEMAPHORE_GIVE(paint_mutex);
+        JADE_TRACE_END("gui_repaint");
+    }
+    damage.num_rects = 0;
+
+    JADE_SEMAPHORE_GIVE(activities_mutex);
+}
+
 // Helper function to just update the text node internal text data - does not repaint,
 // so several nodes can be updated then a single repaint issued - eg. the status bar
 static void gui_update_text_node_text(gui_view_node_t* node, const char* text)
@@ -1443,10 +1919,17 @@ static void gui_update_text_node_text(gui_view_node_t* node, const char* text)
     const int ret = snprintf(new_text, len, "%s", text);
     JADE_ASSERT(ret >= 0); // truncation is acceptable here, as is empty string
 
-    // free the old text node and replace with the new pointer
-    free(node->text->text);
+    // wipe and free the old text (which may be sensitive, eg. a typed passphrase) and replace with the new pointer
+    JADE_WALLY_VERIFY(wally_bzero(node->text->text, strlen(node->text->text)));
+    activity_free(node->activity, node->text->text);
     node->text->text = new_text;
 
+    // any offscreen rendering of the old text is now stale, and the new text may need scrolling
+    if (node->text->scroll) {
+        free_text_scroll_strip(node->text->scroll);
+        resume_updatables(node);
+    }
+
     // resolve text references
     gui_resolve_text(node);
 }
@@ -1467,15 +1950,10 @@ void gui_update_text(gui_view_node_t* node, const char* text)
     // Update the text node text
     gui_update_text_node_text(node, text);
 
-    // If part of current activity, draw it immediately
+    // If part of current activity, mark the node damaged so it is redrawn on the next gui tick.
+    // The background behind the node is also repainted, so that the old string is cleared.
     if (current_activity && current_activity->root_node && current_activity->root_node == root) {
-        // repaint the parent (so that the old string is cleared). Usually a parent should
-        // be present, because it's unlikely that a root node is of type "text"
-        if (node->parent) {
-            gui_repaint(node->parent, true);
-        } else {
-            gui_repaint(node, true);
-        }
+        gui_damage_node(node);
     }
 
     // Release the activity mutex
@@ -1499,13 +1977,12 @@ void gui_update_icon(gui_view_node_t* node, const Icon icon, const bool repaint_
     // Update icon
     node->icon->icon = icon;
 
-    // If part of current activity, draw it immediately
+    // If part of current activity, redraw it (now, or on the next gui tick)
     if (current_activity && current_activity->root_node && current_activity->root_node == root) {
-        // Maybe repaint the parent (so that the old icon is cleared). Usually a parent should
-        // be present, because it's unlikely that a root node is of type "icon"
+        // Maybe repaint the background (so that the old icon is cleared) on the next gui tick.
         if (repaint_parent && node->parent) {
-            // Redraw parent (ie. background), then children
-            gui_repaint(node->parent, true);
+            // Mark damaged - background and node are redrawn
+            gui_damage_node(node);
         } else {
             // Simply redraw over the top - eg. if icon same size or larger and not transparent
             gui_repaint(node, true);
@@ -1532,13 +2009,12 @@ void gui_update_picture(gui_view_node_t* node, const Picture* picture, const boo
     // Update picture
     node->picture->picture = picture;
 
-    // If part of current activity, draw it immediately
+    // If part of current activity, redraw it (now, or on the next gui tick)
     if (current_activity && current_activity->root_node && current_activity->root_node == root) {
-        // Maybe repaint the parent (so that the old picture is cleared). Usually a parent should
-        // be present, because it's unlikely that a root node is of type "icon"
+        // Maybe repaint the background (so that the old picture is cleared) on the next gui tick.
         if (repaint_parent && node->parent) {
-            // Redraw parent (ie. background), then children
-            gui_repaint(node->parent, true);
+            // Mark damaged - background and node are redrawn
+            gui_damage_node(node);
         } else {
             // Simply redraw over the top - eg. if picture same size or larger
             gui_repaint(node, true);
@@ -1615,6 +2091,17 @@ static void render_node(gui_view_node_t* node, dispWin_t constraints, uint8_t de
     gui_repaint(node, !node->parent);
 }
 
+// Render a child node - when repainting damage the layout is unchanged, so any child already laid-out
+// is repainted using its existing render data rather than being laid-out again.
+static inline void render_child(gui_view_node_t* child, dispWin_t constraints, uint8_t depth)
+{
+    if (repaint_clip && !child->render_data.is_first_time) {
+        gui_repaint(child, false);
+    } else {
+        render_node(child, constraints, depth);
+    }
+}
+
 static void render_button(gui_view_node_t* node, dispWin_t cs, uint8_t depth)
 {
     TFT_fillRect(cs.x1, cs.y1, cs.x2 - cs.x1, cs.y2 - cs.y1,
@@ -1622,7 +2109,7 @@ static void render_button(gui_view_node_t* node, dispWin_t cs, uint8_t depth)
 
     gui_view_node_t* ptr = node->child;
     if (ptr) {
-        render_node(ptr, cs, depth + 1);
+        render_child(ptr, cs, depth + 1);
     }
 }
 
@@ -1650,7 +2137,7 @@ static void render_vsplit(gui_view_node_t* node, dispWin_t constraints, uint8_t
             .y2 = min(y + step, max_y),
         };
 
-        render_node(ptr, child_constraints, depth + 1);
+        render_child(ptr, child_constraints, depth + 1);
 
         count++;
         y = child_constraints.y2;
@@ -1677,7 +2164,7 @@ static void render_hsplit(gui_view_node_t* node, dispWin_t constraints, uint8_t
         dispWin_t child_constraints
             = { .x1 = x, .x2 = min(x + step, max_x), .y1 = constraints.y1, .y2 = constraints.y2 };
 
-        render_node(ptr, child_constraints, depth + 1);
+        render_child(ptr, child_constraints, depth + 1);
 
         count++;
         x = child_constraints.x2;
@@ -1693,7 +2180,7 @@ static void render_fill(gui_view_node_t* node, dispWin_t cs, uint8_t depth)
 
     gui_view_node_t* ptr = node->child;
     if (ptr) {
-        render_node(ptr, cs, depth + 1);
+        render_child(ptr, cs, depth + 1);
     }
 }
 
@@ -1727,6 +2214,82 @@ static inline int resolve_valign(int y, enum gui_vertical_align valign)
     return y;
 }
 
+// Get the background color behind a node, if known - ie. if painted by the nearest fill/button
+// ancestor (as splits lay their children out side-by-side, and fills/buttons have a single child).
+static bool get_background_color(const gui_view_node_t* node, color_t* color)
+{
+    JADE_ASSERT(node);
+    JADE_ASSERT(color);
+
+    for (const gui_view_node_t* parent = node->parent; parent; parent = parent->parent) {
+        switch (parent->kind) {
+        case HSPLIT:
+        case VSPLIT:
+            continue;
+        case FILL:
+            *color = parent->is_selected ? parent->fill->selected_color : parent->fill->color;
+            return true;
+        case BUTTON:
+            *color = parent->is_selected ? parent->button->selected_color : parent->button->color;
+            return true;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+// render a scrolling text node by copying the visible part of the whole string, rendered offscreen
+// Returns false if the offscreen rendering is not possible (eg. font not supported or no spiram).
+static bool render_text_scroll_strip(gui_view_node_t* node, dispWin_t cs)
+{
+    JADE_ASSERT(node);
+    JADE_ASSERT(node->kind == TEXT);
+    JADE_ASSERT(node->text->scroll);
+
+    struct view_node_text_scroll_data* const scroll = node->text->scroll;
+    const color_t color = node->is_selected ? node->text->selected_color : node->text->color;
+
+    // Render the whole string offscreen if not already done (in this color)
+    if (scroll->strip && !same_color(scroll->strip_color, color)) {
+        free_text_scroll_strip(scroll);
+    }
+    if (!scroll->strip) {
+        const char* const text = node->render_data.resolved_text;
+        const int width = TFT_render_string(text, NULL, 0, NULL);
+        if (width <= 0 || width > UINT16_MAX) {
+            return false;
+        }
+
+        // Only use spiram, if not available fall back to printing the text directly
+        scroll->strip = heap_caps_malloc(width * TFT_getfontheight() * sizeof(disp_pixel_t), MALLOC_CAP_SPIRAM);
+        if (!scroll->strip) {
+            return false;
+        }
+        const size_t num_char_x = node->render_data.resolved_text_length + 1;
+        scroll->strip_char_x = JADE_MALLOC_PREFER_SPIRAM(num_char_x * sizeof(uint16_t));
+        scroll->strip_width = width;
+        scroll->strip_color = color;
+
+        _fg = color;
+        _bg = scroll->background_color;
+        TFT_render_string(text, scroll->strip, width, scroll->strip_char_x);
+    }
+
+    // Copy the visible window
+    const int height = TFT_getfontheight();
+    int y = cs.y1;
+    if (node->text->valign == GUI_ALIGN_MIDDLE) {
+        y = ((cs.y2 - cs.y1 - height) / 2) + cs.y1;
+    } else if (node->text->valign == GUI_ALIGN_BOTTOM) {
+        y = cs.y2 - height;
+    }
+    const uint8_t offset = min(scroll->offset, node->render_data.resolved_text_length);
+    TFT_blit(scroll->strip, scroll->strip_width, height, scroll->strip_char_x[offset], cs.x1, y, cs.x2 - cs.x1,
+        scroll->background_color);
+    return true;
+}
+
 // render a text node to screen in the window constrained by cs
 static void render_text(gui_view_node_t* node, dispWin_t cs)
 {
@@ -1735,7 +2298,20 @@ static void render_text(gui_view_node_t* node, dispWin_t cs)
 
     TFT_setFont(node->text->font, NULL);
 
-    if (node->text->scroll) {
+    // If the background color is known, print opaque text as that is much faster (the glyphs are
+    // cached and whole strings sent at once, rather than drawing every pixel individually).
+    // NOTE: 'noise' text relies on overprinting, so must remain transparent.
+    color_t background_color;
+    if (!node->text->noise && get_background_color(node, &background_color)) {
+        font_transparent = 0;
+        _bg = background_color;
+    }
+
+    if (node->text->scroll
+        && !can_text_fit(node->render_data.resolved_text, node->text->font, node->render_data.padded_constraints)
+        && render_text_scroll_strip(node, cs)) {
+        // text too long to fit, rendered offscreen once and the visible part copied to the screen
+    } else if (node->text->scroll) {
         // this text has the scroll enable, so disable wrap
         text_wrap = 0;
 
@@ -1792,6 +2368,8 @@ static void render_text(gui_view_node_t* node, dispWin_t cs)
                 resolve_valign(0, node->text->valign), cs);
         }
     }
+
+    font_transparent = 1;
 }
 
 // render an icon to screen
@@ -1867,6 +2445,15 @@ void gui_repaint(gui_view_node_t* node, bool take_mutex)
         JADE_SEMAPHORE_TAKE(paint_mutex);
     }
 
+    // if repainting damage, skip any node (and hence its children) which lies outside the damaged area
+    if (repaint_clip && !rects_intersect(&node->render_data.original_constraints, repaint_clip)) {
+        if (take_mutex) {
+            JADE_SEMAPHORE_GIVE(paint_mutex);
+        }
+        return;
+    }
+    node->render_data.is_dirty = false;
+
     // borders use the un-padded constraints
     if (node->borders) {
         dispWin_t constraints = node->render_data.original_constraints;
@@ -1990,7 +2577,8 @@ static bool switch_activities(void)
                 status_bar.updated = true;
             }
 
-            // Draw the new activity
+            // Draw the new activity - any damage to the old activity is moot
+            damage.num_rects = 0;
             gui_render_activity(current_activity);
 
             // Register new events
@@ -2015,46 +2603,78 @@ static bool switch_activities(void)
     return false;
 }
 
-// updatables task, this task runs to update elements in the `updatables` list of the current activity
-static void update_updateables(void)
+// Run any due elements in the `updatables` list of the current activity.
+// Returns the ticks until the next updatable is due, or portMAX_DELAY if none are pending.
+static TickType_t update_updateables(const TickType_t now)
 {
+    TickType_t next_due = portMAX_DELAY;
     if (!current_activity) {
-        return;
+        return next_due;
     }
 
-    updatable_t* current = current_activity->updatables;
-    while (current) {
+    const TickType_t frame_ticks = gui_frame_ticks();
+    for (updatable_t* current = current_activity->updatables; current; current = current->next) {
         // this shouldn't really happen but better add a check anyways
-        if (!current->callback) {
+        if (!current->callback || current->idle) {
             continue;
         }
 
-        // let's see if we need to repaint this
-        bool result = current->callback(current->node, current->extra_args);
-        if (result) {
-            // repaint and take the mutex
-            // TODO: we are ignoring the return code here...
-            gui_repaint(current->node, true);
+        if (tick_due(current->next_update, now)) {
+            // let's see if we need to repaint this, and when the callback next needs to run
+            uint32_t wait_frames = 0;
+            const bool result = current->callback(current->node, current->extra_args, &wait_frames);
+            if (result) {
+                // repaint and take the mutex
+                // TODO: we are ignoring the return code here...
+                gui_repaint(current->node, true);
+            }
+
+            if (wait_frames == GUI_UPDATABLE_IDLE) {
+                current->idle = true;
+                continue;
+            }
+            current->next_update = now + (wait_frames + 1) * frame_ticks;
+        }
+
+        const TickType_t ticks_to_wait = current->next_update - now;
+        if (ticks_to_wait < next_due) {
+            next_due = ticks_to_wait;
         }
-        current = current->next;
     }
+    return next_due;
+}
+
+static inline dispWin_t status_bar_cs(void)
+{
+    dispWin_t cs = GUI_DISPLAY_WINDOW;
+    cs.y2 = cs.y1 + GUI_STATUS_BAR_HEIGHT;
+    return cs;
 }
 
 // update the status bar
-static void update_status_bar(void)
+// Returns the ticks until the status bar is next due to be refreshed, or portMAX_DELAY if no status bar.
+static TickType_t update_status_bar(const TickType_t now)
 {
     // No-op if no status bar
     if (!current_activity || !current_activity->status_bar) {
-        return;
+        return portMAX_DELAY;
     }
 
-    dispWin_t status_bar_cs = GUI_DISPLAY_WINDOW;
-    status_bar_cs.y2 = status_bar_cs.y1 + GUI_STATUS_BAR_HEIGHT;
+    // Poll the connection and battery state when due, but immediately redraw any changes (eg. title)
+    // if flagged as updated.
+    if (!tick_due(status_bar.next_poll, now)) {
+        if (status_bar.updated) {
+            render_node(status_bar.root, status_bar_cs(), 0);
+            status_bar.updated = false;
+        }
+        return status_bar.next_poll - now;
+    }
+    bool changed = false;
 
     // NOTE: we use the internal 'gui_update_text_node_text()' method here
     // since we don't want to redraw each update individually, but rather
     // capture in a single repaint after all nodes are updated.
-    if ((status_bar.battery_update_counter % 10) == 0) {
+    {
 #ifdef CONFIG_BT_ENABLED
         const bool new_ble = ble_enabled();
 #else
@@ -2068,7 +2688,7 @@ static void update_status_bar(void)
             } else {
                 gui_update_text_node_text(status_bar.ble_text, (char[]){ 'F', '\0' });
             }
-            status_bar.updated = true;
+            changed = true;
         }
 
         const bool new_usb = usb_connected();
@@ -2079,7 +2699,7 @@ static void update_status_bar(void)
             } else {
                 gui_update_text_node_text(status_bar.usb_text, (char[]){ 'D', '\0' });
             }
-            status_bar.updated = true;
+            changed = true;
             status_bar.battery_update_counter = 0; // Force battery icon update
         }
     }
@@ -2094,39 +2714,69 @@ static void update_status_bar(void)
             status_bar.last_battery_val = new_bat;
             gui_set_colors(status_bar.battery_text, color, color);
             gui_update_text_node_text(status_bar.battery_text, (char[]){ new_bat + '0', '\0' });
-            status_bar.updated = true;
+            changed = true;
         }
-        status_bar.battery_update_counter = 60;
+        status_bar.battery_update_counter = GUI_STATUS_BAR_BATTERY_POLLS;
     }
 
     status_bar.battery_update_counter--;
 
+    // Poll again soon after any change, backing off while nothing changes
+    if (changed) {
+        status_bar.updated = true;
+        status_bar.poll_interval = GUI_STATUS_BAR_POLL_MIN_MS / portTICK_PERIOD_MS;
+    } else if (status_bar.poll_interval < GUI_STATUS_BAR_POLL_MAX_MS / portTICK_PERIOD_MS) {
+        status_bar.poll_interval *= 2;
+    }
+    status_bar.next_poll = now + status_bar.poll_interval;
+
     if (status_bar.updated) {
-        render_node(status_bar.root, status_bar_cs, 0);
+        render_node(status_bar.root, status_bar_cs(), 0);
         status_bar.updated = false;
     }
+    return status_bar.next_poll - now;
 }
 
 // gui task, for managing display/activities
+// Rather than running every frame, the task blocks until woken by a new activity, a damaged area or
+// status-bar change to redraw, or until the next updatable (eg. scrolling text) or status-bar refresh is due.
 static void gui_task(void* args)
 {
-    const TickType_t period = 1000 / GUI_TARGET_FRAMERATE / portTICK_PERIOD_MS;
-    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t last_paint = xTaskGetTickCount();
+    TickType_t timeout = 0;
     for (;;) {
-        // Wait for the next frame
-        // Note: this task is never suspended, so no need to re-fetch the tick-
-        // time each loop, just let vTaskDelayUntil() track the 'last_wake' count.
-        vTaskDelayUntil(&last_wake, period);
+        // Wait for something to do
+        if (ulTaskNotifyTake(pdTRUE, timeout)) {
+            // Woken to paint - limit to the target framerate, so that bursts of updates
+            // (eg. several text nodes updated together) are painted in a single pass.
+            const TickType_t frame_ticks = gui_frame_ticks();
+            if (!tick_due(last_paint + frame_ticks, xTaskGetTickCount())) {
+                vTaskDelayUntil(&last_paint, frame_ticks);
+            }
+        }
+        const TickType_t now = xTaskGetTickCount();
+        last_paint = now;
 
         // Check the current activity - set new activity if need be
         // Note: this can also free all the old/completed activities
-        if (!switch_activities()) {
-            // Not switching activities, update any 'updatable' gui elements on this activity
-            update_updateables();
+        if (switch_activities()) {
+            // Check immediately for any further queued activities, and to run
+            // the new activity's updatables and status-bar
+            timeout = 0;
+            continue;
         }
 
+        // Not switching activities, update any 'updatable' gui elements on this activity
+        timeout = update_updateables(now);
+
+        // Repaint any areas damaged since the last frame
+        repaint_damage();
+
         // Update status bar if required
-        update_status_bar();
+        const TickType_t status_bar_timeout = update_status_bar(now);
+        if (status_bar_timeout < timeout) {
+            timeout = status_bar_timeout;
+        }
     }
 
     vTaskDelete(NULL);
@@ -2183,20 +2833,32 @@ void gui_set_current_activity_ex(gui_activity_t* new_current, const bool free_ma
 {
     JADE_ASSERT(new_current);
 
+    // Building the activity ends when it is first shown - any nodes made later (eg. when a cached
+    // activity is reused) are allocated from the heap, so the arena does not grow while it lives.
+    clear_building_activity(new_current);
+
     // We will post the gui task the new activity, and the list of activities it can free
     activity_switch_info_t switch_info = { .new_activity = new_current, .to_free = NULL };
 
-    // If freeing others, partition existing activities into those to keep (new current and the
-    //  passed 'retain' activity) and those to free (all others).
+    // If freeing others, partition existing activities into those to keep (new current and any
+    // cached activities) and those to free (all others).
     if (free_managed_activities) {
         JADE_SEMAPHORE_TAKE(activities_mutex);
+
+        // If memory is low, also evict any cached activities not in use
+        if (activity_cache_evict_requested
+            || heap_caps_get_free_size(MALLOC_CAP_DEFAULT | MALLOC_CAP_INTERNAL) < GUI_ACTIVITY_CACHE_MIN_FREE_DRAM) {
+            evict_cache_entries(new_current);
+            activity_cache_evict_requested = false;
+        }
+
         activity_holder_t* holder = existing_activities;
         existing_activities = NULL;
 
         while (holder) {
             activity_holder_t* const next = holder->next;
 
-            if (&holder->activity == new_current) {
+            if (&holder->activity == new_current || holder->cached) {
                 // Retain this activity
                 holder->next = existing_activities;
                 existing_activities = holder;
@@ -2209,10 +2871,10 @@ void gui_set_current_activity_ex(gui_activity_t* new_current, const bool free_ma
         }
 
         // Sanity check
-        // 'existing_activities' should be the new current activity only, or be completely empty
-        // (if current activity is an "unmanaged" activity)
-        JADE_ASSERT(
-            !existing_activities || ((&existing_activities->activity == new_current) && !existing_activities->next));
+        // 'existing_activities' should be the new current activity and any cached activities only
+        for (activity_holder_t* retained = existing_activities; retained; retained = retained->next) {
+            JADE_ASSERT(&retained->activity == new_current || retained->cached);
+        }
 
         JADE_SEMAPHORE_GIVE(activities_mutex);
     }
@@ -2221,6 +2883,7 @@ void gui_set_current_activity_ex(gui_activity_t* new_current, const bool free_ma
     while (xRingbufferSend(switch_activities_queue, &switch_info, sizeof(switch_info), portMAX_DELAY) != pdTRUE) {
         // wait for a spot in the ring
     }
+    gui_wake();
 }
 
 // Initiate change of 'current' activity
@@ -2237,7 +2900,7 @@ wait_event_data_t* gui_activity_make_wait_event_data(gui_activity_t* activity)
     JADE_ASSERT(activity);
 
     // Create item to hold new event data object
-    wait_data_t* const item = JADE_MALLOC(sizeof(wait_data_t));
+    wait_data_t* const item = activity_calloc(activity, sizeof(wait_data_t));
     item->event_data = make_wait_event_data();
 
     // Put into activity's list
@@ -2255,7 +2918,7 @@ void gui_activity_register_event(
     JADE_ASSERT(event_base);
 
     // Store the event registration so we can re-apply when switching between activities
-    activity_event_t* link = JADE_CALLOC(1, sizeof(activity_event_t));
+    activity_event_t* link = activity_calloc(activity, sizeof(activity_event_t));
 
     link->event_base = event_base;
     link->event_id = event_id;
@@ -2314,10 +2977,16 @@ void gui_set_activity_title(gui_activity_t* activity, const char* title)
     JADE_ASSERT(activity);
     JADE_ASSERT(title);
 
-    if (activity->title) {
-        free(activity->title);
+    // Reuse the existing buffer if the new title fits (eg. when rebinding a cached activity), otherwise
+    // use the heap - as for other updates made after the activity is built, so the arena does not grow
+    const size_t len = strlen(title) + 1;
+    if (activity->title && len <= strlen(activity->title) + 1) {
+        strcpy(activity->title, title);
+    } else {
+        activity_free(activity, activity->title);
+        activity->title = JADE_MALLOC(len);
+        memcpy(activity->title, title, len);
     }
-    activity->title = strdup(title);
 
     // If setting title for the current activity, update status bar immediately
     if (activity == current_activity) {
@@ -2,6 +2,7 @@
 #define GUI_H_
 
 #include <tft.h>
+#include <utils/arena.h>
 #include <utils/event.h>
 
 #include "jlocale.h"
@@ -116,17 +117,24 @@ typedef struct gui_activity_t gui_activity_t;
 
 // Callback called before repainting an updatable node.
 //     return true to actually paint the node, false otherwise
-typedef bool (*gui_updatable_callback_t)(gui_view_node_t* node, void* extra_args);
+// Returns whether the node needs repainting, and sets the number of frames to wait before calling again
+// (GUI_UPDATABLE_IDLE if the node needs no further timed updates).
+typedef bool (*gui_updatable_callback_t)(gui_view_node_t* node, void* extra_args, uint32_t* wait_frames);
+#define GUI_UPDATABLE_IDLE UINT32_MAX
 
 // Wrapper for items that need repaint at each frame, possibly with an extra callback
 typedef struct updatable_element {
     // node to update and callback to run before updating it
     gui_view_node_t* node;
 
-    // callback (and its args) to run at each frame, it will tell us if it's necessary to repaint the node
+    // callback (and its args) to run when due, it will tell us if it's necessary to repaint the node
     gui_updatable_callback_t callback;
     void* extra_args;
 
+    // tick count at which the callback is next due (if not idle)
+    TickType_t next_update;
+    bool idle;
+
     // next in the linked list
     struct updatable_element* next;
 } updatable_t;
@@ -175,6 +183,9 @@ struct __attribute__((__packed__)) view_node_render_data {
     // is this the first rendering of the node?
     bool is_first_time;
 
+    // has the node been updated/damaged since it was last painted?
+    bool is_dirty;
+
     // depth of the node in the tree of this activity
     uint8_t depth;
 };
@@ -209,6 +220,13 @@ struct view_node_text_scroll_data {
     uint8_t wait;
     // is the text moving right?
     bool going_back;
+
+    // the whole string rendered offscreen (in spiram) in 'strip_color', if available, so
+    // each step only needs to copy the visible part - and the x position of each char in it
+    disp_pixel_t* strip;
+    uint16_t* strip_char_x;
+    uint16_t strip_width;
+    color_t strip_color;
 };
 
 // Data appended to a text node when noise is needed
@@ -247,13 +265,29 @@ struct view_node_button_data {
     void* args;
 };
 
+// Callback to fetch the next frame of a generated (streamed) icon animation.
+// Returns true if 'icon' has been set to the next frame, or false to continue showing the current frame.
+// NOTE: the icon data returned is owned by the generator, and must remain valid until the next call.
+typedef bool (*gui_icon_generator_fn_t)(void* ctx, Icon* icon);
+
+// Optional callback called when a view_node is destructed. Basically a custom destructor
+typedef void (*free_callback_t)(void*);
+
+// Destructor for the data of a view_node - passed the node, as the data may be held in the node's activity's arena
+typedef void (*view_node_free_callback_t)(gui_view_node_t*);
+
 // Data for an icon node
-// NOTE: animated icons ARE owned here
+// NOTE: animated icons ARE owned here, as is any generator context
 struct view_node_icon_animation_data {
     Icon* icons;
     size_t num_icons;
     size_t current_icon;
 
+    // if != NULL frames are fetched from this generator rather than the 'icons' array
+    gui_icon_generator_fn_t generator;
+    void* generator_ctx;
+    free_callback_t free_generator_ctx;
+
     size_t frames_per_icon;
     size_t current_frame;
 };
@@ -319,10 +353,11 @@ struct __attribute__((__packed__)) gui_activity_t {
     char* title;
     // should that cursor "wrap around" when you reach one end?
     bool selectables_wrap;
-};
 
-// Optional callback called when a view_node is destructed. Basically a custom destructor
-typedef void (*free_callback_t)(void*);
+    // owns the nodes, node data and strings created while building this activity
+    // (released in one go when the activity is freed)
+    arena_t arena;
+};
 
 // Generic struct representing a node in the view tree
 struct __attribute__((__packed__)) gui_view_node_t {
@@ -357,7 +392,7 @@ struct __attribute__((__packed__)) gui_view_node_t {
         struct view_node_picture_data* picture;
     };
     // (optional) destructor
-    free_callback_t free_callback;
+    view_node_free_callback_t free_callback;
 
     // ptr to the first child of the list
     gui_view_node_t* child;
@@ -385,6 +420,20 @@ typedef struct {
     gui_view_node_t* last_activity_next_button;
 } linked_activities_info_t;
 
+// Entry in the cache of frequently shown activities (eg. PIN entry, keyboards, dashboard screens)
+// Usually a static owned by the code which builds the activities.
+#define GUI_ACTIVITY_CACHE_ENTRY_MAX_ACTIVITIES 4
+typedef struct gui_activity_cache_entry_t gui_activity_cache_entry_t;
+struct gui_activity_cache_entry_t {
+    gui_activity_t* activities[GUI_ACTIVITY_CACHE_ENTRY_MAX_ACTIVITIES];
+    size_t num_activities;
+    // caller-defined, identifies what the activities were built for
+    uint32_t key;
+    // held entries are in use and are never evicted
+    bool held;
+    gui_activity_cache_entry_t* next;
+};
+
 gui_event_t gui_get_click_event(void);
 void gui_set_click_event(gui_event_t event);
 
@@ -395,6 +444,11 @@ void gui_make_activity_ex(gui_activity_t** ppact, const bool has_status_bar, con
 void gui_make_activity(gui_activity_t** ppact, bool has_status_bar, const char* title);
 void free_unmanaged_activity(gui_activity_t* activity);
 
+bool gui_activity_cache_lookup(gui_activity_cache_entry_t* entry, uint32_t key);
+void gui_activity_cache_add(gui_activity_cache_entry_t* entry, uint32_t key, gui_activity_t* activity);
+void gui_activity_cache_hold(gui_activity_cache_entry_t* entry, bool hold);
+void gui_activity_cache_evict(void);
+
 void gui_set_parent(gui_view_node_t* child, gui_view_node_t* parent);
 void gui_chain_activities(const link_activity_t* link_act, linked_activities_info_t* pActInfo);
 void free_view_node(gui_view_node_t* node);
@@ -414,6 +468,8 @@ void gui_set_borders_inactive_color(gui_view_node_t* node, color_t inactive_colo
 void gui_set_colors(gui_view_node_t* node, color_t color, color_t selected_color);
 void gui_set_align(gui_view_node_t* node, enum gui_horizontal_align halign, enum gui_vertical_align valign);
 void gui_set_icon_animation(gui_view_node_t* node, Icon* icons, size_t num_icons, size_t frames_per_icon);
+void gui_set_icon_generator(gui_view_node_t* node, gui_icon_generator_fn_t generator, void* ctx,
+    free_callback_t free_ctx, size_t frames_per_icon);
 void gui_set_text_scroll(gui_view_node_t* node, color_t background_color);
 void gui_set_text_noise(gui_view_node_t* node, color_t background_color);
 void gui_set_text_font(gui_view_node_t* node, uint32_t font);
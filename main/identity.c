@@ -20,6 +20,33 @@
 
 static const uint8_t SSH_NIST_HMAC_KEY[] = { 'N', 'i', 's', 't', '2', '5', '6', 'p', '1', ' ', 's', 'e', 'e', 'd' };
 
+// Number of distinct curves whose groups may be loaded
+#define MAX_LOADED_CURVES 2
+
+// Number of derived identity keys cached
+#define IDENTITY_CACHE_SIZE 4
+
+// A derived identity key - the hash of the identity and index (and derivation type/curve) and the keys
+// NOTE: an empty entry has curve_group_id == MBEDTLS_ECP_DP_NONE (ie. zero)
+typedef struct {
+    uint8_t identity_hash[SHA256_LEN];
+    size_t slip_prefix;
+    mbedtls_ecp_group_id curve_group_id;
+    uint8_t privkey[EC_PRIVATE_KEY_LEN];
+    uint8_t pubkey[EC_PUBLIC_KEY_UNCOMPRESSED_LEN];
+} identity_cache_entry_t;
+
+// Derived identity keys - cleared whenever the keychain is cleared
+static identity_cache_entry_t identity_cache[IDENTITY_CACHE_SIZE];
+static size_t identity_cache_next = 0;
+
+// A key on a (shared) loaded curve group
+typedef struct {
+    mbedtls_ecp_group* grp;
+    mbedtls_mpi d;
+    mbedtls_ecp_point Q;
+} identity_key_t;
+
 // Interpret 4 bytes as a uint32_t path element, and set the 'hardened' bit
 // NOTE: 'bytes' ptr must be 4-byte aligned
 #define HARDENED_PATH_ELEMENT(bytes) (BIP32_INITIAL_HARDENED_CHILD | *((uint32_t*)(bytes)))
@@ -181,40 +208,63 @@ static void get_bip32_hardened_child_from_path(const mbedtls_ecp_group* grp, con
     JADE_ASSERT(child_out->priv_key[0] == BIP32_FLAG_KEY_PRIVATE);
 }
 
-// Function to get a public/private keypair for a given identity (slip13 or slip17).
-// Deduces the curve to use, given the identity protocol prefix.
-static bool get_internal_keypair(const size_t slip_prefix, const char* identity, const size_t identity_len,
-    const size_t index, const char* curve_name, const size_t curve_name_len, mbedtls_ecp_keypair* keypair)
+// Get the (loaded) group for the passed curve
+// Loaded curve groups are held for the session, as they are not secret and are costly to load.
+static mbedtls_ecp_group* get_curve_group(const mbedtls_ecp_group_id curve_group_id)
 {
-    JADE_ASSERT(curve_name);
-    JADE_ASSERT(curve_name_len > 0);
-    JADE_ASSERT(identity);
-    JADE_ASSERT(identity_len > 0);
-    JADE_ASSERT(keypair);
-    JADE_ASSERT(keychain_get());
+    JADE_ASSERT(curve_group_id != MBEDTLS_ECP_DP_NONE);
 
-    if (keychain_get()->seed_len == 0) {
-        JADE_LOGE("No wallet seed available.");
-        return false;
+    static mbedtls_ecp_group loaded_groups[MAX_LOADED_CURVES] = { 0 };
+    for (size_t i = 0; i < MAX_LOADED_CURVES; ++i) {
+        mbedtls_ecp_group* const grp = &loaded_groups[i];
+        if (grp->id == curve_group_id) {
+            return grp;
+        }
+        if (grp->id == MBEDTLS_ECP_DP_NONE) {
+            mbedtls_ecp_group_init(grp);
+            const int ret = mbedtls_ecp_group_load(grp, curve_group_id);
+            JADE_ASSERT(!ret);
+            return grp;
+        }
     }
+    JADE_ABORT();
+}
 
-    // Get/load the curve of interest
-    const mbedtls_ecp_group_id curve_group_id = get_curve_group_id(curve_name, curve_name_len);
-    if (curve_group_id == MBEDTLS_ECP_DP_NONE) {
-        JADE_LOGE("Unsupported curve '%.*s'", curve_name_len, curve_name);
-        return false;
+// Empty the cache of derived identity keys - called whenever the keychain is cleared/replaced
+void identity_clear_cache(void)
+{
+    JADE_WALLY_VERIFY(wally_bzero(identity_cache, sizeof(identity_cache)));
+    identity_cache_next = 0;
+}
+
+// Look up a cached identity key
+static const identity_cache_entry_t* find_cached_key(
+    const size_t slip_prefix, const mbedtls_ecp_group_id curve_group_id, const uint8_t* identity_hash)
+{
+    JADE_ASSERT(identity_hash);
+
+    for (size_t i = 0; i < IDENTITY_CACHE_SIZE; ++i) {
+        const identity_cache_entry_t* const entry = &identity_cache[i];
+        if (entry->curve_group_id == curve_group_id && entry->slip_prefix == slip_prefix
+            && !memcmp(entry->identity_hash, identity_hash, sizeof(entry->identity_hash))) {
+            return entry;
+        }
     }
-    // FIXME: use getters instead of MBEDTLS_PRIVATE MACRO
-    int ret = mbedtls_ecp_group_load(&keypair->MBEDTLS_PRIVATE(grp), curve_group_id);
-    JADE_ASSERT(!ret);
+    return NULL;
+}
 
-    // Get the hash of the identity and index
-    uint8_t identity_hash[SHA256_LEN];
-    get_identity_hash(identity, identity_len, index, identity_hash, sizeof(identity_hash));
+// Derive the key for an identity hash on the passed curve, and add it to the cache
+// (replacing the oldest entry if the cache is full).
+static const identity_cache_entry_t* derive_and_cache_key(mbedtls_ecp_group* grp, const size_t slip_prefix,
+    const uint8_t* identity_hash, const size_t identity_hash_len)
+{
+    JADE_ASSERT(grp);
+    JADE_ASSERT(identity_hash);
+    JADE_ASSERT(identity_hash_len == SHA256_LEN);
 
-    // Get the bip32 path for that hash
+    // Get the bip32 path for the identity hash
     uint32_t path[IDENTITY_PATH_LEN];
-    get_path_from_hash(slip_prefix, identity_hash, sizeof(identity_hash), path, IDENTITY_PATH_LEN);
+    get_path_from_hash(slip_prefix, identity_hash, identity_hash_len, path, IDENTITY_PATH_LEN);
 
     // Derive a key from this curve, for this identity/path
     struct ext_key derived = { 0 };
@@ -227,45 +277,139 @@ static bool get_internal_keypair(const size_t slip_prefix, const char* identity,
         SSH_NIST_HMAC_KEY, sizeof(SSH_NIST_HMAC_KEY), 0, &root));
 
     // Use local function to run (a restricted) bip32 derivation for this curve
-    get_bip32_hardened_child_from_path(&keypair->MBEDTLS_PRIVATE(grp), &root, path, IDENTITY_PATH_LEN, &derived);
+    get_bip32_hardened_child_from_path(grp, &root, path, IDENTITY_PATH_LEN, &derived);
     SENSITIVE_POP(&root);
 
-    // Read the private key into the output keypair
+    // Read the private key, and generate the public key from it
     // NOTE: need to skip the leading 0 byte
-    ret = mbedtls_mpi_read_binary(&keypair->MBEDTLS_PRIVATE(d), &derived.priv_key[1], sizeof(derived.priv_key) - 1);
+    mbedtls_mpi d = { 0 };
+    mbedtls_ecp_point Q = { 0 };
+    SENSITIVE_PUSH(&d, sizeof(d));
+    mbedtls_mpi_init(&d);
+    mbedtls_ecp_point_init(&Q);
+
+    int ret = mbedtls_mpi_read_binary(&d, &derived.priv_key[1], sizeof(derived.priv_key) - 1);
     JADE_ASSERT(!ret);
-    ret = mbedtls_ecp_check_privkey(&keypair->MBEDTLS_PRIVATE(grp), &keypair->MBEDTLS_PRIVATE(d));
+    ret = mbedtls_ecp_check_privkey(grp, &d);
+    JADE_ASSERT(!ret);
+    ret = mbedtls_ecp_mul(grp, &Q, &d, &grp->G, jade_get_random_cb, NULL);
+    JADE_ASSERT(!ret);
+    ret = mbedtls_ecp_check_pubkey(grp, &Q);
     JADE_ASSERT(!ret);
-    SENSITIVE_POP(&derived);
 
-    // Generate the public key from the private key + curve settings
-    ret = mbedtls_ecp_mul(&keypair->MBEDTLS_PRIVATE(grp), &keypair->MBEDTLS_PRIVATE(Q), &keypair->MBEDTLS_PRIVATE(d),
-        &keypair->MBEDTLS_PRIVATE(grp).G, jade_get_random_cb, NULL);
+    // Sanity check - only run as the key is derived, not each time it is fetched from the cache
+    mbedtls_ecp_keypair keypair;
+    SENSITIVE_PUSH(&keypair, sizeof(keypair));
+    mbedtls_ecp_keypair_init(&keypair);
+    ret = mbedtls_ecp_group_copy(&keypair.MBEDTLS_PRIVATE(grp), grp);
+    JADE_ASSERT(!ret);
+    ret = mbedtls_mpi_copy(&keypair.MBEDTLS_PRIVATE(d), &d);
+    JADE_ASSERT(!ret);
+    ret = mbedtls_ecp_copy(&keypair.MBEDTLS_PRIVATE(Q), &Q);
     JADE_ASSERT(!ret);
-    ret = mbedtls_ecp_check_pubkey(&keypair->MBEDTLS_PRIVATE(grp), &keypair->MBEDTLS_PRIVATE(Q));
+    ret = mbedtls_ecp_check_pub_priv(&keypair, &keypair, jade_get_random_cb, NULL);
     JADE_ASSERT(!ret);
+    mbedtls_ecp_keypair_free(&keypair);
+    SENSITIVE_POP(&keypair);
 
-    // Sanity check
-    ret = mbedtls_ecp_check_pub_priv(keypair, keypair, jade_get_random_cb, NULL);
+    // Add to the cache
+    identity_cache_entry_t* const entry = &identity_cache[identity_cache_next];
+    identity_cache_next = (identity_cache_next + 1) % IDENTITY_CACHE_SIZE;
+
+    memcpy(entry->identity_hash, identity_hash, sizeof(entry->identity_hash));
+    entry->slip_prefix = slip_prefix;
+    entry->curve_group_id = grp->id;
+    memcpy(entry->privkey, &derived.priv_key[1], sizeof(entry->privkey));
+    size_t pubkeylen = 0;
+    ret = mbedtls_ecp_point_write_binary(
+        grp, &Q, MBEDTLS_ECP_PF_UNCOMPRESSED, &pubkeylen, entry->pubkey, sizeof(entry->pubkey));
+    JADE_ASSERT(!ret);
+    JADE_ASSERT(pubkeylen == sizeof(entry->pubkey));
+
+    mbedtls_ecp_point_free(&Q);
+    mbedtls_mpi_free(&d);
+    SENSITIVE_POP(&d);
+    SENSITIVE_POP(&derived);
+
+    return entry;
+}
+
+// Function to get a public/private keypair for a given identity (slip13 or slip17).
+// Deduces the curve to use, given the identity protocol prefix.
+// Derived keys are cached, so repeated use of the same identity/index does not repeat the derivation.
+static bool get_identity_key(const size_t slip_prefix, const char* identity, const size_t identity_len,
+    const size_t index, const char* curve_name, const size_t curve_name_len, identity_key_t* key)
+{
+    JADE_ASSERT(curve_name);
+    JADE_ASSERT(curve_name_len > 0);
+    JADE_ASSERT(identity);
+    JADE_ASSERT(identity_len > 0);
+    JADE_ASSERT(key);
+    JADE_ASSERT(keychain_get());
+
+    if (keychain_get()->seed_len == 0) {
+        JADE_LOGE("No wallet seed available.");
+        return false;
+    }
+
+    // Get the curve of interest
+    const mbedtls_ecp_group_id curve_group_id = get_curve_group_id(curve_name, curve_name_len);
+    if (curve_group_id == MBEDTLS_ECP_DP_NONE) {
+        JADE_LOGE("Unsupported curve '%.*s'", curve_name_len, curve_name);
+        return false;
+    }
+    key->grp = get_curve_group(curve_group_id);
+
+    // Get the hash of the identity and index
+    uint8_t identity_hash[SHA256_LEN];
+    get_identity_hash(identity, identity_len, index, identity_hash, sizeof(identity_hash));
+
+    // Get the cached key, or derive it if not cached
+    const identity_cache_entry_t* entry = find_cached_key(slip_prefix, curve_group_id, identity_hash);
+    if (!entry) {
+        entry = derive_and_cache_key(key->grp, slip_prefix, identity_hash, sizeof(identity_hash));
+    }
+
+    // Read the keys into the output
+    int ret = mbedtls_mpi_read_binary(&key->d, entry->privkey, sizeof(entry->privkey));
+    JADE_ASSERT(!ret);
+    ret = mbedtls_ecp_point_read_binary(key->grp, &key->Q, entry->pubkey, sizeof(entry->pubkey));
     JADE_ASSERT(!ret);
 
     return true;
 }
 
+static void identity_key_init(identity_key_t* key)
+{
+    JADE_ASSERT(key);
+    key->grp = NULL;
+    mbedtls_mpi_init(&key->d);
+    mbedtls_ecp_point_init(&key->Q);
+}
+
+static void identity_key_free(identity_key_t* key)
+{
+    JADE_ASSERT(key);
+    key->grp = NULL;
+    mbedtls_mpi_free(&key->d);
+    mbedtls_ecp_point_free(&key->Q);
+}
+
 // Function to sign challenge with the passed key
 // Returns a low-s signature - not sure whether this is vital...
-static bool sign_challenge(mbedtls_ecp_keypair* keypair, const uint8_t* challenge, const size_t challenge_len,
-    mbedtls_mpi* pr, mbedtls_mpi* ps)
+static bool sign_challenge(
+    identity_key_t* key, const uint8_t* challenge, const size_t challenge_len, mbedtls_mpi* pr, mbedtls_mpi* ps)
 {
-    JADE_ASSERT(keypair);
+    JADE_ASSERT(key);
+    JADE_ASSERT(key->grp);
     JADE_ASSERT(challenge);
     JADE_ASSERT(challenge_len);
     JADE_ASSERT(pr);
     JADE_ASSERT(ps);
 
     // Use RFC6979 deterministic signatures
-    int ret = mbedtls_ecdsa_sign_det_ext(&keypair->MBEDTLS_PRIVATE(grp), pr, ps, &keypair->MBEDTLS_PRIVATE(d),
-        challenge, challenge_len, MBEDTLS_MD_SHA256, jade_get_random_cb, NULL);
+    int ret = mbedtls_ecdsa_sign_det_ext(
+        key->grp, pr, ps, &key->d, challenge, challenge_len, MBEDTLS_MD_SHA256, jade_get_random_cb, NULL);
     if (ret) {
         JADE_LOGE("mbedtls_ecdsa_sign_det_ext() failed, returned %d", ret);
         return false;
@@ -277,13 +421,13 @@ static bool sign_challenge(mbedtls_ecp_keypair* keypair, const uint8_t* challeng
     mbedtls_mpi tmp = { 0 };
     mbedtls_mpi_init(&tmp);
 
-    ret = mbedtls_mpi_copy(&tmp, &keypair->MBEDTLS_PRIVATE(grp).N);
+    ret = mbedtls_mpi_copy(&tmp, &key->grp->N);
     JADE_ASSERT(!ret);
     mbedtls_mpi_shift_r(&tmp, 1);
 
     if (mbedtls_mpi_cmp_mpi(ps, &tmp) > 0) {
         // Generated 'high' S.  Flip to low-s.
-        ret = mbedtls_mpi_sub_mpi(&tmp, &keypair->MBEDTLS_PRIVATE(grp).N, ps);
+        ret = mbedtls_mpi_sub_mpi(&tmp, &key->grp->N, ps);
         JADE_ASSERT(!ret);
         ret = mbedtls_mpi_copy(ps, &tmp);
         JADE_ASSERT(!ret);
@@ -291,8 +435,7 @@ static bool sign_challenge(mbedtls_ecp_keypair* keypair, const uint8_t* challeng
     mbedtls_mpi_free(&tmp);
 
     // Sanity check
-    ret = mbedtls_ecdsa_verify(
-        &keypair->MBEDTLS_PRIVATE(grp), challenge, challenge_len, &keypair->MBEDTLS_PRIVATE(Q), pr, ps);
+    ret = mbedtls_ecdsa_verify(key->grp, challenge, challenge_len, &key->Q, pr, ps);
     JADE_ASSERT(!ret);
 
     return true;
@@ -310,12 +453,6 @@ bool get_identity_pubkey(const char* identity, const size_t identity_len, const
         return false;
     }
 
-    // Get a keypair and curve for this identity
-    mbedtls_ecp_keypair keypair = { 0 };
-    SENSITIVE_PUSH(&keypair, sizeof(keypair));
-    mbedtls_ecp_keypair_init(&keypair);
-    bool result = false;
-
     // Prefix deduced from type - ie. slip13 vs slip17
     const size_t slip_prefix = get_key_derivation_prefix(type, type_len);
     if (!slip_prefix) {
@@ -323,21 +460,27 @@ bool get_identity_pubkey(const char* identity, const size_t identity_len, const
         return false;
     }
 
-    if (!get_internal_keypair(slip_prefix, identity, identity_len, index, curve_name, curve_name_len, &keypair)) {
+    // Get a keypair and curve for this identity
+    identity_key_t key;
+    SENSITIVE_PUSH(&key, sizeof(key));
+    identity_key_init(&key);
+    bool result = false;
+
+    if (!get_identity_key(slip_prefix, identity, identity_len, index, curve_name, curve_name_len, &key)) {
         JADE_LOGE(
             "get_identity_pubkey() failed to get key/curve for '%.*s' and index %u", identity_len, identity, index);
     } else {
         // Return the pubkey assoiciated with this identity/signature
         size_t pubkeylen = 0;
-        int ret = mbedtls_ecp_point_write_binary(&keypair.MBEDTLS_PRIVATE(grp), &keypair.MBEDTLS_PRIVATE(Q),
-            MBEDTLS_ECP_PF_UNCOMPRESSED, &pubkeylen, pubkey_out, pubkey_out_len);
+        const int ret = mbedtls_ecp_point_write_binary(
+            key.grp, &key.Q, MBEDTLS_ECP_PF_UNCOMPRESSED, &pubkeylen, pubkey_out, pubkey_out_len);
         JADE_ASSERT(!ret);
         JADE_ASSERT(pubkeylen == pubkey_out_len);
         result = true;
     }
 
-    mbedtls_ecp_keypair_free(&keypair);
-    SENSITIVE_POP(&keypair);
+    identity_key_free(&key);
+    SENSITIVE_POP(&key);
     return result;
 }
 
@@ -354,13 +497,12 @@ bool get_identity_shared_key(const char* identity, const size_t identity_len, co
     }
 
     // Get a keypair and curve for this identity
-    mbedtls_ecp_keypair keypair = { 0 };
-    SENSITIVE_PUSH(&keypair, sizeof(keypair));
-    mbedtls_ecp_keypair_init(&keypair);
+    identity_key_t key;
+    SENSITIVE_PUSH(&key, sizeof(key));
+    identity_key_init(&key);
     bool result = false;
 
-    if (!get_internal_keypair(
-            SLIP17_PATH_PREFIX, identity, identity_len, index, curve_name, curve_name_len, &keypair)) {
+    if (!get_identity_key(SLIP17_PATH_PREFIX, identity, identity_len, index, curve_name, curve_name_len, &key)) {
         JADE_LOGE(
             "get_identity_shared_key() failed to get key/curve for '%.*s' and index %u", identity_len, identity, index);
     } else {
@@ -368,17 +510,16 @@ bool get_identity_shared_key(const char* identity, const size_t identity_len, co
         mbedtls_ecp_point pubk = { 0 };
         mbedtls_ecp_point_init(&pubk);
 
-        if (mbedtls_ecp_point_read_binary(&keypair.MBEDTLS_PRIVATE(grp), &pubk, their_pubkey, their_pubkey_len) != 0
-            || mbedtls_ecp_check_pubkey(&keypair.MBEDTLS_PRIVATE(grp), &pubk) != 0) {
-            JADE_LOGE("get_identity_shared_key() failed to read/validate public key point for curve id %d",
-                keypair.MBEDTLS_PRIVATE(grp).id);
+        if (mbedtls_ecp_point_read_binary(key.grp, &pubk, their_pubkey, their_pubkey_len) != 0
+            || mbedtls_ecp_check_pubkey(key.grp, &pubk) != 0) {
+            JADE_LOGE(
+                "get_identity_shared_key() failed to read/validate public key point for curve id %d", key.grp->id);
         } else {
             // Pubkey valid for deduced curve/group
             mbedtls_mpi shared_secret = { 0 };
             mbedtls_mpi_init(&shared_secret);
 
-            int ret = mbedtls_ecdh_compute_shared(&keypair.MBEDTLS_PRIVATE(grp), &shared_secret, &pubk,
-                &keypair.MBEDTLS_PRIVATE(d), jade_get_random_cb, NULL);
+            int ret = mbedtls_ecdh_compute_shared(key.grp, &shared_secret, &pubk, &key.d, jade_get_random_cb, NULL);
             if (ret != 0) {
                 JADE_LOGE("ecdh_compute_shared failed with %d", ret);
             } else {
@@ -394,8 +535,8 @@ bool get_identity_shared_key(const char* identity, const size_t identity_len, co
         mbedtls_ecp_point_free(&pubk);
     }
 
-    mbedtls_ecp_keypair_free(&keypair);
-    SENSITIVE_POP(&keypair);
+    identity_key_free(&key);
+    SENSITIVE_POP(&key);
     return result;
 }
 
@@ -413,16 +554,16 @@ bool sign_identity(const char* identity, const size_t identity_len, const size_t
     }
 
     // Get a keypair and curve for this identity
-    mbedtls_ecp_keypair keypair = { 0 };
-    SENSITIVE_PUSH(&keypair, sizeof(keypair));
-    mbedtls_ecp_keypair_init(&keypair);
+    identity_key_t key;
+    SENSITIVE_PUSH(&key, sizeof(key));
+    identity_key_init(&key);
     bool result = false;
 
-    if (get_internal_keypair(SLIP13_PATH_PREFIX, identity, identity_len, index, curve_name, curve_name_len, &keypair)) {
+    if (get_identity_key(SLIP13_PATH_PREFIX, identity, identity_len, index, curve_name, curve_name_len, &key)) {
         // Return the pubkey assoiciated with this identity/signature
         size_t pubkeylen = 0;
-        int ret = mbedtls_ecp_point_write_binary(&keypair.MBEDTLS_PRIVATE(grp), &keypair.MBEDTLS_PRIVATE(Q),
-            MBEDTLS_ECP_PF_UNCOMPRESSED, &pubkeylen, pubkey_out, pubkey_out_len);
+        int ret = mbedtls_ecp_point_write_binary(
+            key.grp, &key.Q, MBEDTLS_ECP_PF_UNCOMPRESSED, &pubkeylen, pubkey_out, pubkey_out_len);
         JADE_ASSERT(!ret);
         JADE_ASSERT(pubkeylen == pubkey_out_len);
 
@@ -433,13 +574,12 @@ bool sign_identity(const char* identity, const size_t identity_len, const size_t
 
         // For ssh with SECP256R1 we need to sign a hash of the challenge passed
         // Otherwise we sign the passed challenge directly
-        if (keypair.MBEDTLS_PRIVATE(grp).id == MBEDTLS_ECP_DP_SECP256R1
-            && is_identity_protocol_ssh(identity, identity_len)) {
+        if (key.grp->id == MBEDTLS_ECP_DP_SECP256R1 && is_identity_protocol_ssh(identity, identity_len)) {
             uint8_t challenge_hash[SHA256_LEN];
             JADE_WALLY_VERIFY(wally_sha256(challenge, challenge_len, challenge_hash, sizeof(challenge_hash)));
-            result = sign_challenge(&keypair, challenge_hash, sizeof(challenge_hash), &r, &s);
+            result = sign_challenge(&key, challenge_hash, sizeof(challenge_hash), &r, &s);
         } else {
-            result = sign_challenge(&keypair, challenge, challenge_len, &r, &s);
+            result = sign_challenge(&key, challenge, challenge_len, &r, &s);
         }
 
         if (result) {
@@ -460,7 +600,7 @@ bool sign_identity(const char* identity, const size_t identity_len, const size_t
         JADE_LOGE("sign_identity() failed to get key/curve for '%.*s' and index %u", identity_len, identity, index);
     }
 
-    mbedtls_ecp_keypair_free(&keypair);
-    SENSITIVE_POP(&keypair);
+    identity_key_free(&key);
+    SENSITIVE_POP(&key);
     return result;
 }
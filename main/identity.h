@@ -56,4 +56,7 @@ bool sign_identity(const char* identity, size_t identity_len, size_t index, cons
     size_t curve_name_len, const uint8_t* challenge_hash, size_t challenge_hash_len, uint8_t* pubkey_out,
     size_t pubkey_out_len, uint8_t* signature_out, size_t signature_out_len);
 
+// Wipe any cached identity keys - called when the keychain is cleared
+void identity_clear_cache(void);
+
 #endif /* IDENTITY_H_ */
@@ -23,8 +23,10 @@
 #define JADE_TASK_PRIO_CAMERA (tskIDLE_PRIORITY + 3)
 
 #define JADE_TASK_PRIO_WRITER (tskIDLE_PRIORITY + 2)
+#define JADE_TASK_PRIO_QR_RENDER (tskIDLE_PRIORITY + 2)
 
 // Main Task Priority : (tskIDLE_PRIORITY + 1)
+#define JADE_TASK_PRIO_PRECOMPUTE (tskIDLE_PRIORITY + 1)
 
 #define JADE_TASK_PRIO_IDLETIMER (tskIDLE_PRIORITY)
 
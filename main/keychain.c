@@ -1,5 +1,6 @@
 #include "keychain.h"
 #include "aes.h"
+#include "identity.h"
 #include "jade_assert.h"
 #include "jade_wally_verify.h"
 #include "random.h"
@@ -74,6 +75,9 @@ void keychain_clear(void)
         keychain_data = NULL;
     }
 
+    // Clear any identity keys derived from the keychain
+    identity_clear_cache();
+
     // Clear any mnemonic entropy we may have been holding
     JADE_WALLY_VERIFY(wally_bzero(mnemonic_entropy, sizeof(mnemonic_entropy)));
     mnemonic_entropy_len = 0;
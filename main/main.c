@@ -37,6 +37,7 @@
 #include "idletimer.h"
 #include "power.h"
 #include "storage.h"
+#include "trace.h"
 #include "wallet.h"
 
 #ifndef CONFIG_LOG_DEFAULT_LEVEL_NONE
@@ -74,6 +75,10 @@ static void boot_process(void)
     TaskHandle_t* ble_handle = NULL;
     TaskHandle_t* qemu_tcp_handle = NULL;
 
+#ifdef CONFIG_DEBUG_MODE
+    trace_init();
+#endif
+
     if (!jade_process_init(&serial_handle, &ble_handle, &qemu_tcp_handle)) {
         JADE_ABORT();
     }
@@ -1,10 +1,12 @@
 #include "multisig.h"
 #include "jade_assert.h"
 #include "jade_wally_verify.h"
+#include "keychain.h"
 #include "storage.h"
 #include "utils/malloc_ext.h"
 
 #include <sodium/utils.h>
+#include <stddef.h>
 #include <wally_script.h>
 
 // 0 - 0.1.30 - variant, threshold, signers, hmac
@@ -220,6 +222,234 @@ bool multisig_data_from_bytes(const uint8_t* bytes, const size_t bytes_len, mult
     return true;
 }
 
+// Compact index of the multisig registrations, persisted in storage and cached in RAM once loaded.
+// Entries are kept sorted by name, and carry enough summary information to list and filter the
+// registrations without loading and hmac-checking every full record.
+// The 'wallet tag' is an hmac (with the wallet master key) of the rest of the entry, so a summary
+// can be trusted as valid for this wallet without loading the record.  If the tag does not verify
+// (eg. the entry was written when another wallet was loaded) the full record is checked instead,
+// and the entry repaired if the record is valid for this wallet.
+#define MULTISIG_INDEX_POLICY_HASH_LEN 4
+#define MULTISIG_INDEX_WALLET_TAG_LEN 8
+
+#define MULTISIG_INDEX_FLAG_SORTED 0x1
+#define MULTISIG_INDEX_FLAG_BLINDING_KEY 0x2
+
+typedef struct {
+    char name[MAX_MULTISIG_NAME_SIZE];
+    uint8_t variant;
+    uint8_t flags;
+    uint8_t threshold;
+    uint8_t num_signers;
+    uint8_t policy_hash[MULTISIG_INDEX_POLICY_HASH_LEN];
+    uint8_t wallet_tag[MULTISIG_INDEX_WALLET_TAG_LEN];
+} multisig_index_entry_t;
+
+static multisig_index_entry_t* multisig_index = NULL;
+static size_t multisig_index_len = 0;
+
+// Truncated hash of the record data (excluding the trailing hmac) - identifies the multisig policy
+static void get_policy_hash(const uint8_t* registration, const size_t registration_len, uint8_t* policy_hash)
+{
+    JADE_ASSERT(registration);
+    JADE_ASSERT(registration_len > HMAC_SHA256_LEN);
+    JADE_ASSERT(policy_hash);
+
+    uint8_t hash[SHA256_LEN];
+    JADE_WALLY_VERIFY(wally_sha256(registration, registration_len - HMAC_SHA256_LEN, hash, sizeof(hash)));
+    memcpy(policy_hash, hash, MULTISIG_INDEX_POLICY_HASH_LEN);
+}
+
+// Compute the wallet tag for the index entry - fails if no wallet is loaded
+static bool get_wallet_tag(const multisig_index_entry_t* entry, uint8_t* wallet_tag)
+{
+    JADE_ASSERT(entry);
+    JADE_ASSERT(wallet_tag);
+
+    if (!keychain_get()) {
+        return false;
+    }
+
+    uint8_t hmac[HMAC_SHA256_LEN];
+    if (!wallet_hmac_with_master_key(
+            (const uint8_t*)entry, offsetof(multisig_index_entry_t, wallet_tag), hmac, sizeof(hmac))) {
+        return false;
+    }
+    memcpy(wallet_tag, hmac, MULTISIG_INDEX_WALLET_TAG_LEN);
+    return true;
+}
+
+static bool wallet_tag_valid(const multisig_index_entry_t* entry)
+{
+    uint8_t wallet_tag[MULTISIG_INDEX_WALLET_TAG_LEN];
+    return get_wallet_tag(entry, wallet_tag) && !sodium_memcmp(wallet_tag, entry->wallet_tag, sizeof(wallet_tag));
+}
+
+// Set the entry summary from the (valid) record data, and tag the entry as valid for this wallet
+static void set_index_entry_summary(multisig_index_entry_t* entry, const multisig_data_t* multisig_data)
+{
+    JADE_ASSERT(entry);
+    JADE_ASSERT(multisig_data);
+
+    entry->variant = (uint8_t)multisig_data->variant;
+    entry->flags = (multisig_data->sorted ? MULTISIG_INDEX_FLAG_SORTED : 0)
+        | (multisig_data->master_blinding_key_len ? MULTISIG_INDEX_FLAG_BLINDING_KEY : 0);
+    entry->threshold = multisig_data->threshold;
+    entry->num_signers = multisig_data->num_xpubs;
+    const bool ret = get_wallet_tag(entry, entry->wallet_tag);
+    JADE_ASSERT(ret);
+}
+
+// Make the index entry for a record - the summary is only populated if valid for the current wallet
+static void make_index_entry(
+    const char* name, const uint8_t* registration, const size_t registration_len, multisig_index_entry_t* entry)
+{
+    JADE_ASSERT(name);
+    JADE_ASSERT(strlen(name) < sizeof(entry->name));
+    JADE_ASSERT(entry);
+
+    memset(entry, 0, sizeof(multisig_index_entry_t));
+    strcpy(entry->name, name);
+    get_policy_hash(registration, registration_len, entry->policy_hash);
+
+    multisig_data_t multisig_data;
+    if (keychain_get() && registration_len >= MIN_MULTISIG_BYTES_LEN
+        && multisig_data_from_bytes(registration, registration_len, &multisig_data)) {
+        set_index_entry_summary(entry, &multisig_data);
+    }
+}
+
+static bool persist_index(void)
+{
+    if (!multisig_index_len) {
+        return storage_erase_multisig_index();
+    }
+    return storage_set_multisig_index(
+        (const uint8_t*)multisig_index, multisig_index_len * sizeof(multisig_index_entry_t));
+}
+
+// Persist the index after a record has been updated - as the record itself has already been stored, if
+// the index cannot be persisted the stored index is discarded, so it is rebuilt from the records when
+// next loaded (the index in RAM remains correct).
+static void persist_updated_index(void)
+{
+    if (!persist_index()) {
+        JADE_LOGW("Failed to persist updated multisig index - discarding stored index");
+        if (!storage_erase_multisig_index()) {
+            JADE_LOGE("Failed to discard stored multisig index");
+        }
+    }
+}
+
+static int compare_index_entries(const void* lhs, const void* rhs)
+{
+    return strcmp(((const multisig_index_entry_t*)lhs)->name, ((const multisig_index_entry_t*)rhs)->name);
+}
+
+// Binary search of the index - returns whether found, and sets the position of the entry (or where it should go)
+static bool find_index_entry(const char* name, size_t* pos)
+{
+    JADE_ASSERT(name);
+    JADE_ASSERT(pos);
+
+    size_t lo = 0;
+    size_t hi = multisig_index_len;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        const int cmp = strcmp(name, multisig_index[mid].name);
+        if (!cmp) {
+            *pos = mid;
+            return true;
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    *pos = lo;
+    return false;
+}
+
+// Whether an index loaded from storage is well-formed - ie. all names are nul-terminated valid key
+// names, and the entries are in strictly ascending name order (as the binary search requires).
+static bool index_well_formed(const multisig_index_entry_t* index, const size_t len)
+{
+    JADE_ASSERT(index);
+
+    for (size_t i = 0; i < len; ++i) {
+        const char* const name = index[i].name;
+        if (!memchr(name, '\0', sizeof(index[i].name)) || !storage_key_name_valid(name)) {
+            return false;
+        }
+        if (i > 0 && strcmp(index[i - 1].name, name) >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Load the index from storage on first use - rebuilding it from the records if it is missing, is
+// stale (eg. records registered by an earlier firmware version), or is not well-formed.
+static void load_index(void)
+{
+    if (multisig_index) {
+        return;
+    }
+
+    const size_t index_size = MAX_MULTISIG_REGISTRATIONS * sizeof(multisig_index_entry_t);
+    multisig_index = JADE_MALLOC_PREFER_SPIRAM(index_size);
+
+    size_t written = 0;
+    const size_t num_records = storage_get_multisig_registration_count();
+    if (storage_get_multisig_index((uint8_t*)multisig_index, index_size, &written)
+        && written == num_records * sizeof(multisig_index_entry_t)) {
+        if (index_well_formed(multisig_index, num_records)) {
+            multisig_index_len = num_records;
+            return;
+        }
+        JADE_LOGW("Stored multisig index is not well-formed - discarding");
+    }
+
+    JADE_LOGI("Rebuilding multisig index for %u records", num_records);
+    multisig_index_len = 0;
+
+    size_t num_names = 0;
+    char names[MAX_MULTISIG_REGISTRATIONS][NVS_KEY_NAME_MAX_SIZE]; // Sufficient
+    if (storage_get_all_multisig_registration_names(names, MAX_MULTISIG_REGISTRATIONS, &num_names)) {
+        uint8_t* const registration = JADE_MALLOC(MAX_MULTISIG_BYTES_LEN);
+        for (size_t i = 0; i < num_names; ++i) {
+            size_t registration_len = 0;
+            if (storage_get_multisig_registration(names[i], registration, MAX_MULTISIG_BYTES_LEN, &registration_len)
+                && registration_len > HMAC_SHA256_LEN) {
+                make_index_entry(names[i], registration, registration_len, multisig_index + multisig_index_len);
+                ++multisig_index_len;
+            }
+        }
+        free(registration);
+    }
+
+    qsort(multisig_index, multisig_index_len, sizeof(multisig_index_entry_t), compare_index_entries);
+    if (!persist_index()) {
+        JADE_LOGW("Failed to persist rebuilt multisig index");
+    }
+}
+
+// Called when a record has been loaded and found valid - repairs the index entry if it was not tagged as valid
+static void update_index_entry(const char* name, const multisig_data_t* multisig_data)
+{
+    load_index();
+
+    size_t pos = 0;
+    if (!find_index_entry(name, &pos) || wallet_tag_valid(multisig_index + pos)) {
+        return;
+    }
+
+    JADE_LOGI("Updating multisig index entry for %s", name);
+    set_index_entry_summary(multisig_index + pos, multisig_data);
+    persist_updated_index();
+}
+
 bool multisig_load_from_storage(const char* multisig_name, multisig_data_t* output, const char** errmsg)
 {
     JADE_ASSERT(multisig_name);
@@ -243,6 +473,8 @@ bool multisig_load_from_storage(const char* multisig_name, multisig_data_t* outp
         || !output->num_xpubs || output->num_xpubs > MAX_MULTISIG_SIGNERS
         || (output->master_blinding_key_len && output->master_blinding_key_len != MULTISIG_MASTER_BLINDING_KEY_SIZE)) {
         *errmsg = "Multisig wallet data invalid";
+    } else {
+        update_index_entry(multisig_name, output);
     }
 
     return true;
@@ -381,26 +613,134 @@ void multisig_get_valid_record_names(
     JADE_ASSERT(num_names);
     JADE_INIT_OUT_SIZE(num_written);
 
-    // Get registered multisig names
-    size_t num_multisigs = 0;
-    if (!storage_get_all_multisig_registration_names(names, num_names, &num_multisigs) || !num_multisigs) {
-        // No registered multisig records
-        return;
+    // Use the index summaries - include only those valid for this wallet and passed script type
+    size_t written = 0;
+    const size_t num_multisigs = multisig_get_registration_count();
+    for (size_t i = 0; i < num_multisigs && written < num_names; ++i) {
+        multisig_summary_t summary;
+        if (multisig_get_registration_summary(i, &summary)
+            && variant_matches_script_type(summary.variant, script_type)) {
+            strcpy(names[written], summary.name);
+            ++written;
+        }
+    }
+    *num_written = written;
+}
+
+size_t multisig_get_registration_count(void)
+{
+    load_index();
+    return multisig_index_len;
+}
+
+bool multisig_registration_exists(const char* multisig_name)
+{
+    JADE_ASSERT(multisig_name);
+
+    load_index();
+    size_t pos = 0;
+    return find_index_entry(multisig_name, &pos);
+}
+
+// Whether the named registration exists and is identical to that passed
+bool multisig_registration_matches(
+    const char* multisig_name, const uint8_t* registration, const size_t registration_len)
+{
+    JADE_ASSERT(multisig_name);
+    JADE_ASSERT(registration);
+    JADE_ASSERT(registration_len > HMAC_SHA256_LEN);
+
+    load_index();
+    size_t pos = 0;
+    if (!find_index_entry(multisig_name, &pos)) {
+        return false;
+    }
+
+    // Check the policy hash first, only loading the full record if it matches
+    uint8_t policy_hash[MULTISIG_INDEX_POLICY_HASH_LEN];
+    get_policy_hash(registration, registration_len, policy_hash);
+    if (memcmp(policy_hash, multisig_index[pos].policy_hash, sizeof(policy_hash))) {
+        return false;
     }
 
-    // Load description of each - remove ones that are not valid for this wallet or passed script type
     size_t written = 0;
-    for (int i = 0; i < num_multisigs; ++i) {
+    uint8_t existing[MAX_MULTISIG_BYTES_LEN]; // Sufficient
+    return storage_get_multisig_registration(multisig_name, existing, sizeof(existing), &written)
+        && written == registration_len && !sodium_memcmp(existing, registration, registration_len);
+}
+
+// Get the summary of the indexed registration (in name order)
+// Returns whether the registration is valid for this wallet - the name is populated in any case.
+bool multisig_get_registration_summary(const size_t index, multisig_summary_t* summary)
+{
+    JADE_ASSERT(summary);
+
+    load_index();
+    JADE_ASSERT(index < multisig_index_len);
+    const multisig_index_entry_t* const entry = multisig_index + index;
+
+    memset(summary, 0, sizeof(multisig_summary_t));
+    strcpy(summary->name, entry->name);
+
+    if (!wallet_tag_valid(entry)) {
+        // Not tagged as valid for this wallet - check the full record (which repairs the entry if valid)
         const char* errmsg = NULL;
         multisig_data_t multisig_data;
-        if (multisig_load_from_storage(names[i], &multisig_data, &errmsg)
-            && variant_matches_script_type(multisig_data.variant, script_type)) {
-            // If any previous records were not valid, move subsequent valid record names down
-            if (written != i) {
-                strcpy(names[written], names[i]);
-            }
-            ++written;
+        if (!keychain_get() || !multisig_load_from_storage(entry->name, &multisig_data, &errmsg) || errmsg) {
+            return false;
         }
+        JADE_ASSERT(wallet_tag_valid(entry));
     }
-    *num_written = written;
+
+    summary->variant = entry->variant;
+    summary->sorted = entry->flags & MULTISIG_INDEX_FLAG_SORTED;
+    summary->has_master_blinding_key = entry->flags & MULTISIG_INDEX_FLAG_BLINDING_KEY;
+    summary->threshold = entry->threshold;
+    summary->num_signers = entry->num_signers;
+    return true;
+}
+
+// Persist the registration record and update the index.  The record is the source of truth - the result
+// reflects whether it was stored, and if the index cannot be persisted it is rebuilt when next loaded.
+bool multisig_store_registration(const char* multisig_name, const uint8_t* registration, const size_t registration_len)
+{
+    JADE_ASSERT(multisig_name);
+    JADE_ASSERT(registration);
+    JADE_ASSERT(registration_len >= MIN_MULTISIG_BYTES_LEN);
+
+    load_index();
+    size_t pos = 0;
+    const bool exists = find_index_entry(multisig_name, &pos);
+    if (!exists && multisig_index_len >= MAX_MULTISIG_REGISTRATIONS) {
+        JADE_LOGE("Multisig index full");
+        return false;
+    }
+
+    const bool ret = storage_set_multisig_registration(multisig_name, registration, registration_len);
+    if (ret) {
+        if (!exists) {
+            memmove(multisig_index + pos + 1, multisig_index + pos,
+                (multisig_index_len - pos) * sizeof(multisig_index_entry_t));
+            ++multisig_index_len;
+        }
+        make_index_entry(multisig_name, registration, registration_len, multisig_index + pos);
+        persist_updated_index();
+    }
+    return ret;
+}
+
+bool multisig_erase_registration(const char* multisig_name)
+{
+    JADE_ASSERT(multisig_name);
+
+    load_index();
+    const bool ret = storage_erase_multisig_registration(multisig_name);
+    size_t pos = 0;
+    if (ret && find_index_entry(multisig_name, &pos)) {
+        memmove(multisig_index + pos, multisig_index + pos + 1,
+            (multisig_index_len - pos - 1) * sizeof(multisig_index_entry_t));
+        --multisig_index_len;
+        persist_updated_index();
+    }
+    return ret;
 }
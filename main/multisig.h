@@ -10,7 +10,8 @@
 #define MAX_MULTISIG_NAME_SIZE 16
 
 // The maximum number of concurrent multisig registrations supported
-#define MAX_MULTISIG_REGISTRATIONS 16
+// NOTE: in practice also limited by the space available in nvs storage
+#define MAX_MULTISIG_REGISTRATIONS 32
 
 // The expected size of a liquid master blinding key
 #define MULTISIG_MASTER_BLINDING_KEY_SIZE (HMAC_SHA512_LEN / 2)
@@ -39,6 +40,16 @@ typedef struct _multisig_data {
     uint8_t xpubs[MAX_MULTISIG_SIGNERS * BIP32_SERIALIZED_LEN];
 } multisig_data_t;
 
+// Summary of a multisig registration, as held in the registrations index
+typedef struct {
+    char name[MAX_MULTISIG_NAME_SIZE];
+    script_variant_t variant;
+    bool sorted;
+    bool has_master_blinding_key;
+    uint8_t threshold;
+    uint8_t num_signers;
+} multisig_summary_t;
+
 // Signer details passed in during multisig registration
 typedef struct {
     uint8_t fingerprint[BIP32_KEY_FINGERPRINT_LEN];
@@ -82,4 +93,13 @@ bool multisig_get_master_blinding_key(const multisig_data_t* multisig_data, uint
 void multisig_get_valid_record_names(
     const size_t* script_type, char names[][MAX_MULTISIG_NAME_SIZE], size_t num_names, size_t* num_written);
 
+// Registrations are indexed by name - the index is loaded from storage on first use
+size_t multisig_get_registration_count(void);
+bool multisig_registration_exists(const char* multisig_name);
+bool multisig_registration_matches(const char* multisig_name, const uint8_t* registration, size_t registration_len);
+bool multisig_get_registration_summary(size_t index, multisig_summary_t* summary);
+
+bool multisig_store_registration(const char* multisig_name, const uint8_t* registration, size_t registration_len);
+bool multisig_erase_registration(const char* multisig_name);
+
 #endif /* MULTISIG_H_ */
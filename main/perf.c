@@ -0,0 +1,347 @@
+#include "perf.h"
+#include "jade_assert.h"
+#include "process.h"
+#include "utils/cbor_rpc.h"
+#include "utils/malloc_ext.h"
+
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Compute-time histogram buckets: <1ms, <4ms, <16ms, <64ms, <256ms, <1024ms, and longer
+#define PERF_HIST_BUCKETS 7
+
+// Limit the number of methods reported, to keep the reply within the maximum message size
+// (the most frequently called methods are reported)
+#define PERF_MAX_REPORTED_METHODS 12
+
+typedef struct {
+    const char* name;
+    uint32_t calls;
+    uint32_t compute_hist[PERF_HIST_BUCKETS];
+    uint32_t compute_max_us;
+    uint64_t recv_us;
+    uint64_t dispatch_us;
+    uint64_t compute_us;
+    uint64_t wait_us;
+    uint64_t send_us;
+} perf_method_stats_t;
+
+typedef struct {
+    size_t size;
+    size_t peak;
+} perf_ringbuf_stats_t;
+
+static const char* RINGBUF_NAMES[PERF_NUM_RINGBUFS]
+    = { "shared_in", "serial_out", "ble_out", "qr_out", "qemu_tcp_out" };
+
+// Tasks whose stack high-water marks are reported, if running
+static const char* TASK_NAMES[] = { "main", "gui", "serial_reader", "serial_writer", "ble_writer", "nimble_host",
+    "qemu_tcp_reader", "qemu_tcp_writer", "idle_timeout", "wheel_watcher", "jade_camera", "ota_writer",
+    "pin_precompute", "bcur_icons" };
+#define NUM_TASK_NAMES (sizeof(TASK_NAMES) / sizeof(TASK_NAMES[0]))
+
+// Upper bound on the encoded size of the stats reply, which must fit in a single output message.
+// All keys are literals of fewer than 24 chars (so have a 1-byte cbor header), as are task names.
+// Method names are at most PERF_MAX_METHOD_NAME_LEN chars, and uints take at most 5 or 9 bytes.
+#define KEY_SIZE(key) sizeof(key)
+#define UINT32_SIZE 5
+#define UINT64_SIZE 9
+#define METHOD_STATS_SIZE                                                                                              \
+    (PERF_MAX_METHOD_NAME_LEN + 2 + 1 + KEY_SIZE("calls") + UINT32_SIZE + KEY_SIZE("recv_us") + UINT64_SIZE            \
+        + KEY_SIZE("dispatch_us") + UINT64_SIZE + KEY_SIZE("compute_us") + UINT64_SIZE + KEY_SIZE("compute_max_us")    \
+        + UINT32_SIZE + KEY_SIZE("wait_us") + UINT64_SIZE + KEY_SIZE("send_us") + UINT64_SIZE                          \
+        + KEY_SIZE("compute_hist") + 1 + PERF_HIST_BUCKETS * UINT32_SIZE)
+#define METHODS_SIZE (KEY_SIZE("methods") + 1 + PERF_MAX_REPORTED_METHODS * METHOD_STATS_SIZE)
+#define HEAP_SIZE                                                                                                      \
+    (KEY_SIZE("heap") + 1 + KEY_SIZE("dram_free") + KEY_SIZE("dram_min_free") + KEY_SIZE("spiram_free")                \
+        + KEY_SIZE("spiram_min_free") + 4 * UINT32_SIZE)
+#define STACKS_SIZE (KEY_SIZE("stack_hwm") + 1 + NUM_TASK_NAMES * (configMAX_TASK_NAME_LEN + UINT32_SIZE))
+#define RINGBUFS_SIZE                                                                                                  \
+    (KEY_SIZE("ringbuffers") + 1                                                                                       \
+        + PERF_NUM_RINGBUFS * (KEY_SIZE("qemu_tcp_out") + 1 + KEY_SIZE("size") + KEY_SIZE("peak") + 2 * UINT32_SIZE))
+#define PERF_STATS_SIZE                                                                                                \
+    (1 + KEY_SIZE("uptime_ms") + UINT64_SIZE + METHODS_SIZE + HEAP_SIZE + STACKS_SIZE + RINGBUFS_SIZE)
+#define PERF_STATS_REPLY_SIZE (1 + KEY_SIZE("id") + MAXLEN_ID + 2 + KEY_SIZE("result") + PERF_STATS_SIZE)
+_Static_assert(PERF_STATS_REPLY_SIZE <= MAX_STANDARD_OUTPUT_MSG_SIZE, "perf stats reply may be too large");
+
+static perf_method_stats_t* method_stats = NULL;
+static size_t num_method_stats = 0;
+static perf_ringbuf_stats_t ringbuf_stats[PERF_NUM_RINGBUFS];
+
+// Details of the last message received - written by the transport tasks
+// NOTE: only the lower 32-bits of the timer are held, so values can be read/written atomically
+static volatile uint32_t last_msg_recv_us = 0;
+static volatile uint32_t last_msg_queued_at = 0;
+
+// The request currently being handled
+static perf_method_stats_t* current = NULL;
+static TaskHandle_t current_task = NULL;
+static int64_t current_start_us = 0;
+static int64_t current_wait_us = 0;
+static int64_t current_send_us = 0;
+
+void perf_init(const size_t num_methods)
+{
+    JADE_ASSERT(!method_stats);
+    JADE_ASSERT(num_methods);
+
+    method_stats = JADE_CALLOC_PREFER_SPIRAM(num_methods, sizeof(perf_method_stats_t));
+    num_method_stats = num_methods;
+}
+
+void perf_message_received(const int64_t recv_start_us)
+{
+    const int64_t now = esp_timer_get_time();
+    last_msg_recv_us = (uint32_t)(now - recv_start_us);
+    last_msg_queued_at = (uint32_t)now;
+}
+
+void perf_request_begin(const size_t method_index, const char* method_name)
+{
+    JADE_ASSERT(method_name);
+    JADE_ASSERT(!current);
+
+    if (!method_stats) {
+        return;
+    }
+    JADE_ASSERT(method_index < num_method_stats);
+
+    current = &method_stats[method_index];
+    current->name = method_name;
+    current_task = xTaskGetCurrentTaskHandle();
+    current_start_us = esp_timer_get_time();
+    current_wait_us = 0;
+    current_send_us = 0;
+
+    // Attribute the last message received to this request
+    current->recv_us += last_msg_recv_us;
+    current->dispatch_us += (uint32_t)current_start_us - last_msg_queued_at;
+}
+
+void perf_request_end(void)
+{
+    if (!current) {
+        return;
+    }
+
+    const int64_t elapsed_us = esp_timer_get_time() - current_start_us;
+    const int64_t compute_us = elapsed_us - current_wait_us - current_send_us;
+    const uint32_t compute = compute_us > 0 ? compute_us : 0;
+
+    ++current->calls;
+    current->compute_us += compute;
+    current->wait_us += current_wait_us;
+    current->send_us += current_send_us;
+    if (compute > current->compute_max_us) {
+        current->compute_max_us = compute;
+    }
+
+    size_t bucket = 0;
+    for (uint32_t limit_us = 1000; bucket < PERF_HIST_BUCKETS - 1 && compute >= limit_us; limit_us *= 4) {
+        ++bucket;
+    }
+    ++current->compute_hist[bucket];
+
+    current = NULL;
+    current_task = NULL;
+}
+
+void perf_add_user_wait(const int64_t elapsed_us)
+{
+    if (current && xTaskGetCurrentTaskHandle() == current_task) {
+        current_wait_us += elapsed_us;
+    }
+}
+
+void perf_add_reply_send(const int64_t elapsed_us)
+{
+    if (current && xTaskGetCurrentTaskHandle() == current_task) {
+        current_send_us += elapsed_us;
+    }
+}
+
+void perf_note_ringbuf_usage(const perf_ringbuf_t ringbuf, const size_t used, const size_t size)
+{
+    JADE_ASSERT(ringbuf < PERF_NUM_RINGBUFS);
+
+    ringbuf_stats[ringbuf].size = size;
+    if (used > ringbuf_stats[ringbuf].peak) {
+        ringbuf_stats[ringbuf].peak = used;
+    }
+}
+
+// Whether method stats 'a' should be reported before 'b' - ie. more calls, or equal calls and lower index
+static bool reported_before(const perf_method_stats_t* a, const perf_method_stats_t* b)
+{
+    return a->calls > b->calls || (a->calls == b->calls && a < b);
+}
+
+static void add_method_stats(CborEncoder* container, const perf_method_stats_t* stats)
+{
+    JADE_ASSERT(stats->name);
+
+    CborEncoder map_encoder;
+    CborError cberr = cbor_encode_text_stringz(container, stats->name);
+    JADE_ASSERT(cberr == CborNoError);
+    cberr = cbor_encoder_create_map(container, &map_encoder, 8);
+    JADE_ASSERT(cberr == CborNoError);
+
+    add_uint_to_map(&map_encoder, "calls", stats->calls);
+    add_uint_to_map(&map_encoder, "recv_us", stats->recv_us);
+    add_uint_to_map(&map_encoder, "dispatch_us", stats->dispatch_us);
+    add_uint_to_map(&map_encoder, "compute_us", stats->compute_us);
+    add_uint_to_map(&map_encoder, "compute_max_us", stats->compute_max_us);
+    add_uint_to_map(&map_encoder, "wait_us", stats->wait_us);
+    add_uint_to_map(&map_encoder, "send_us", stats->send_us);
+
+    CborEncoder array_encoder;
+    cberr = cbor_encode_text_stringz(&map_encoder, "compute_hist");
+    JADE_ASSERT(cberr == CborNoError);
+    cberr = cbor_encoder_create_array(&map_encoder, &array_encoder, PERF_HIST_BUCKETS);
+    JADE_ASSERT(cberr == CborNoError);
+    for (size_t i = 0; i < PERF_HIST_BUCKETS; ++i) {
+        cberr = cbor_encode_uint(&array_encoder, stats->compute_hist[i]);
+        JADE_ASSERT(cberr == CborNoError);
+    }
+    cberr = cbor_encoder_close_container(&map_encoder, &array_encoder);
+    JADE_ASSERT(cberr == CborNoError);
+
+    cberr = cbor_encoder_close_container(container, &map_encoder);
+    JADE_ASSERT(cberr == CborNoError);
+}
+
+static void add_methods(CborEncoder* container)
+{
+    // Select the most frequently called methods to report
+    const perf_method_stats_t* reported[PERF_MAX_REPORTED_METHODS];
+    size_t num_reported = 0;
+    const perf_method_stats_t* prev = NULL;
+    while (num_reported < PERF_MAX_REPORTED_METHODS) {
+        const perf_method_stats_t* next = NULL;
+        for (size_t i = 0; i < num_method_stats; ++i) {
+            const perf_method_stats_t* const stats = &method_stats[i];
+            if (stats->calls && (!prev || reported_before(prev, stats)) && (!next || reported_before(stats, next))) {
+                next = stats;
+            }
+        }
+        if (!next) {
+            break;
+        }
+        reported[num_reported++] = next;
+        prev = next;
+    }
+
+    CborEncoder map_encoder;
+    CborError cberr = cbor_encode_text_stringz(container, "methods");
+    JADE_ASSERT(cberr == CborNoError);
+    cberr = cbor_encoder_create_map(container, &map_encoder, num_reported);
+    JADE_ASSERT(cberr == CborNoError);
+    for (size_t i = 0; i < num_reported; ++i) {
+        add_method_stats(&map_encoder, reported[i]);
+    }
+    cberr = cbor_encoder_close_container(container, &map_encoder);
+    JADE_ASSERT(cberr == CborNoError);
+}
+
+static void add_heap(CborEncoder* container)
+{
+    CborEncoder map_encoder;
+    CborError cberr = cbor_encode_text_stringz(container, "heap");
+    JADE_ASSERT(cberr == CborNoError);
+    cberr = cbor_encoder_create_map(container, &map_encoder, 4);
+    JADE_ASSERT(cberr == CborNoError);
+
+    add_uint_to_map(&map_encoder, "dram_free", heap_caps_get_free_size(MALLOC_CAP_DEFAULT | MALLOC_CAP_INTERNAL));
+    add_uint_to_map(
+        &map_encoder, "dram_min_free", heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT | MALLOC_CAP_INTERNAL));
+    add_uint_to_map(&map_encoder, "spiram_free", heap_caps_get_free_size(MALLOC_CAP_DEFAULT | MALLOC_CAP_SPIRAM));
+    add_uint_to_map(
+        &map_encoder, "spiram_min_free", heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT | MALLOC_CAP_SPIRAM));
+
+    cberr = cbor_encoder_close_container(container, &map_encoder);
+    JADE_ASSERT(cberr == CborNoError);
+}
+
+static void add_stacks(CborEncoder* container)
+{
+    // Only tasks currently running are reported
+    TaskHandle_t tasks[NUM_TASK_NAMES];
+    size_t num_tasks = 0;
+    for (size_t i = 0; i < NUM_TASK_NAMES; ++i) {
+        tasks[i] = xTaskGetHandle(TASK_NAMES[i]);
+        if (tasks[i]) {
+            ++num_tasks;
+        }
+    }
+
+    CborEncoder map_encoder;
+    CborError cberr = cbor_encode_text_stringz(container, "stack_hwm");
+    JADE_ASSERT(cberr == CborNoError);
+    cberr = cbor_encoder_create_map(container, &map_encoder, num_tasks);
+    JADE_ASSERT(cberr == CborNoError);
+
+    for (size_t i = 0; i < NUM_TASK_NAMES; ++i) {
+        if (tasks[i]) {
+            add_uint_to_map(&map_encoder, TASK_NAMES[i], uxTaskGetStackHighWaterMark(tasks[i]));
+        }
+    }
+
+    cberr = cbor_encoder_close_container(container, &map_encoder);
+    JADE_ASSERT(cberr == CborNoError);
+}
+
+static void add_ringbufs(CborEncoder* container)
+{
+    // Only ringbuffers in use are reported
+    size_t num_ringbufs = 0;
+    for (size_t i = 0; i < PERF_NUM_RINGBUFS; ++i) {
+        if (ringbuf_stats[i].size) {
+            ++num_ringbufs;
+        }
+    }
+
+    CborEncoder map_encoder;
+    CborError cberr = cbor_encode_text_stringz(container, "ringbuffers");
+    JADE_ASSERT(cberr == CborNoError);
+    cberr = cbor_encoder_create_map(container, &map_encoder, num_ringbufs);
+    JADE_ASSERT(cberr == CborNoError);
+
+    for (size_t i = 0; i < PERF_NUM_RINGBUFS; ++i) {
+        if (!ringbuf_stats[i].size) {
+            continue;
+        }
+
+        CborEncoder ringbuf_encoder;
+        cberr = cbor_encode_text_stringz(&map_encoder, RINGBUF_NAMES[i]);
+        JADE_ASSERT(cberr == CborNoError);
+        cberr = cbor_encoder_create_map(&map_encoder, &ringbuf_encoder, 2);
+        JADE_ASSERT(cberr == CborNoError);
+        add_uint_to_map(&ringbuf_encoder, "size", ringbuf_stats[i].size);
+        add_uint_to_map(&ringbuf_encoder, "peak", ringbuf_stats[i].peak);
+        cberr = cbor_encoder_close_container(&map_encoder, &ringbuf_encoder);
+        JADE_ASSERT(cberr == CborNoError);
+    }
+
+    cberr = cbor_encoder_close_container(container, &map_encoder);
+    JADE_ASSERT(cberr == CborNoError);
+}
+
+void perf_stats_cb(const void* ctx, CborEncoder* container)
+{
+    JADE_ASSERT(container);
+
+    CborEncoder map_encoder;
+    CborError cberr = cbor_encoder_create_map(container, &map_encoder, 5);
+    JADE_ASSERT(cberr == CborNoError);
+
+    add_uint_to_map(&map_encoder, "uptime_ms", esp_timer_get_time() / 1000);
+    add_methods(&map_encoder);
+    add_heap(&map_encoder);
+    add_stacks(&map_encoder);
+    add_ringbufs(&map_encoder);
+
+    cberr = cbor_encoder_close_container(container, &map_encoder);
+    JADE_ASSERT(cberr == CborNoError);
+}
@@ -0,0 +1,43 @@
+#ifndef PERF_H_
+#define PERF_H_
+
+#include <cbor.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Ringbuffers whose peak occupancy is tracked
+typedef enum {
+    PERF_RINGBUF_SHARED_IN,
+    PERF_RINGBUF_SERIAL_OUT,
+    PERF_RINGBUF_BLE_OUT,
+    PERF_RINGBUF_QR_OUT,
+    PERF_RINGBUF_QEMU_TCP_OUT,
+    PERF_NUM_RINGBUFS
+} perf_ringbuf_t;
+
+// Longest method name, as reported in the stats
+#define PERF_MAX_METHOD_NAME_LEN 24
+
+// Initialise per-method stats, for methods identified by index (0 to num_methods - 1)
+void perf_init(size_t num_methods);
+
+// Called by the transports when a complete message is received and queued
+// 'recv_start_us' is when the first data of the message was received
+void perf_message_received(int64_t recv_start_us);
+
+// Bracket the handling of a request (on the calling task)
+// Names must be static strings, as they are not copied.
+void perf_request_begin(size_t method_index, const char* method_name);
+void perf_request_end(void);
+
+// Time spent awaiting user input, or sending replies, during the current request (if any)
+void perf_add_user_wait(int64_t elapsed_us);
+void perf_add_reply_send(int64_t elapsed_us);
+
+// Track ringbuffer peak usage
+void perf_note_ringbuf_usage(perf_ringbuf_t ringbuf, size_t used, size_t size);
+
+// cbor encoder callback to write all stats as a map
+void perf_stats_cb(const void* ctx, CborEncoder* container);
+
+#endif /* PERF_H_ */
@@ -1,8 +1,10 @@
 #include "process.h"
 #include "jade_assert.h"
 #include "jade_wally_verify.h"
+#include "perf.h"
 #include "power.h"
 #include "process/process_utils.h"
+#include "trace.h"
 #include "utils/cbor_rpc.h"
 #include "utils/malloc_ext.h"
 #ifdef CONFIG_BT_ENABLED
@@ -10,6 +12,7 @@
 #endif
 
 #include <esp_mac.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/ringbuf.h>
 #include <freertos/semphr.h>
@@ -18,6 +21,12 @@
 #include <ctype.h>
 #include <stdlib.h>
 
+// NOTE: The inbound ring buffer should be twice the size of the largest
+// valid input message, as the largest item the buffer will hold is just
+// under half its size.
+#define INPUT_RINGBUF_SIZE (2 * MAX_INPUT_MSG_SIZE + 32)
+#define OUTPUT_RINGBUF_SIZE (2 * MAX_OUTPUT_MSG_SIZE + 32)
+
 static RingbufHandle_t shared_in = NULL;
 
 static TaskHandle_t serial_handle;
@@ -38,6 +47,15 @@ static TaskHandle_t qemu_tcp_handle;
 
 static char jade_id[16];
 
+// Process-lifetime allocations are carved out of (preferably spiram) chunks of this size.
+// Without spiram the chunks come from dram, so are kept small - most processes need only a few
+// on-exit handlers, and larger allocations get an exactly-sized chunk of their own in any case.
+#ifdef CONFIG_ESP32_SPIRAM_SUPPORT
+#define PROCESS_ARENA_CHUNK_SIZE 2048
+#else
+#define PROCESS_ARENA_CHUNK_SIZE 256
+#endif
+
 #ifdef CONFIG_HEAP_TRACING
 
 #include <esp_heap_trace.h>
@@ -56,12 +74,14 @@ struct _jade_deferred_fn_t {
 
 // Function to make a deferred-(void)function holder, and push it onto the top
 // of the existing stack of deferred functions (ie. most recent at top).
-static void add_deferred_function(jade_deferred_fn_t** existing, void_fn_t fn, void* param)
+// NOTE: the holder is allocated from the process arena, so is freed along with that.
+static void add_deferred_function(arena_t* arena, jade_deferred_fn_t** existing, void_fn_t fn, void* param)
 {
+    JADE_ASSERT(arena);
     JADE_ASSERT(existing);
     JADE_ASSERT(fn);
 
-    jade_deferred_fn_t* fn_deferred = JADE_MALLOC(sizeof(jade_deferred_fn_t));
+    jade_deferred_fn_t* fn_deferred = arena_alloc(arena, sizeof(jade_deferred_fn_t));
 
     fn_deferred->fn = fn;
     fn_deferred->param = param;
@@ -70,7 +90,7 @@ static void add_deferred_function(jade_deferred_fn_t** existing, void_fn_t fn, v
 }
 
 // Function to pop deferred functions from the stack, (optionally) call
-// each one, and free/discard them (ie. last added, first called/freed).
+// each one, and discard them (ie. last added, first called).
 static void cleanup_deferred_functions(jade_deferred_fn_t** p_fns, bool call)
 {
     JADE_ASSERT(p_fns);
@@ -80,11 +100,10 @@ static void cleanup_deferred_functions(jade_deferred_fn_t** p_fns, bool call)
         *p_fns = deferred->next;
         JADE_ASSERT(deferred->fn);
 
-        // Maybe call the function on the param, then free the function-holder
+        // Maybe call the function on the param
         if (call) {
             (*deferred->fn)(deferred->param);
         }
-        free(deferred);
     }
 }
 
@@ -145,10 +164,7 @@ bool jade_process_init(TaskHandle_t** serial_h, TaskHandle_t** ble_h, TaskHandle
 
     // Allocate ring buffer main storage areas into SPIRAM if available
 
-    // NOTE: The inbound ring buffer should be twice the size of the largest
-    // valid input message, as the largest item the buffer will hold is just
-    // under half its size.
-    shared_in = create_ringbuffer(2 * MAX_INPUT_MSG_SIZE + 32);
+    shared_in = create_ringbuffer(INPUT_RINGBUF_SIZE);
     JADE_ASSERT(shared_in);
 
     // The ring buffers are quite generous because at startup, especially with
@@ -157,22 +173,22 @@ bool jade_process_init(TaskHandle_t** serial_h, TaskHandle_t** ble_h, TaskHandle
 
     // Serial/ble/qemu_tcp task handles
     *serial_h = &serial_handle;
-    serial_out = create_ringbuffer(2 * MAX_OUTPUT_MSG_SIZE + 32);
+    serial_out = create_ringbuffer(OUTPUT_RINGBUF_SIZE);
     JADE_ASSERT(serial_out);
 #if defined(CONFIG_FREERTOS_UNICORE) && defined(CONFIG_ETH_USE_OPENETH)
     *qemu_tcp_h = &qemu_tcp_handle;
-    qemu_tcp_out = create_ringbuffer(2 * MAX_OUTPUT_MSG_SIZE + 32);
+    qemu_tcp_out = create_ringbuffer(OUTPUT_RINGBUF_SIZE);
     JADE_ASSERT(qemu_tcp_out);
 #endif
 #ifdef CONFIG_BT_ENABLED
     *ble_h = &ble_handle;
-    ble_out = create_ringbuffer(2 * MAX_OUTPUT_MSG_SIZE + 32);
+    ble_out = create_ringbuffer(OUTPUT_RINGBUF_SIZE);
     JADE_ASSERT(ble_out);
 #endif
 
 #if defined(CONFIG_BOARD_TYPE_JADE) || defined(CONFIG_BOARD_TYPE_JADE_V1_1) || defined(CONFIG_BOARD_TYPE_WAVESHARE_ESP32_ONE)
     qr_handle = xTaskGetCurrentTaskHandle();
-    qr_out = create_ringbuffer(2 * MAX_OUTPUT_MSG_SIZE + 32);
+    qr_out = create_ringbuffer(OUTPUT_RINGBUF_SIZE);
     JADE_ASSERT(qr_out);
 #endif
 
@@ -197,6 +213,9 @@ void init_jade_process(jade_process_t* process)
 
     // No at-exit hooks initially
     process->on_exit = NULL;
+
+    // Arena for process-lifetime allocations (no memory allocated until first used)
+    arena_init_ex(&process->arena, PROCESS_ARENA_CHUNK_SIZE, ARENA_PREFER_SPIRAM | ARENA_WIPE_ON_RELEASE);
 }
 
 void jade_process_transfer_current_message(jade_process_t* process, jade_process_t* new_process)
@@ -225,6 +244,9 @@ void cleanup_jade_process(jade_process_t* process)
     JADE_ASSERT(process);
     cleanup_deferred_functions(&process->on_exit, true); // call and discard
     jade_process_free_current_message(process);
+
+    // Zeroize and free all process-lifetime allocations (including the deferred function holders)
+    arena_release(&process->arena);
 }
 
 // On-exit handlers - register functions to be called when process is freed
@@ -244,7 +266,19 @@ void jade_process_free_on_exit(jade_process_t* process, void* param)
 void jade_process_call_on_exit(jade_process_t* process, void_fn_t fn, void* param)
 {
     JADE_ASSERT(process);
-    add_deferred_function(&process->on_exit, fn, param);
+    add_deferred_function(&process->arena, &process->on_exit, fn, param);
+}
+
+void* jade_process_malloc(jade_process_t* process, const size_t size)
+{
+    JADE_ASSERT(process);
+    return arena_alloc(&process->arena, size);
+}
+
+void* jade_process_calloc(jade_process_t* process, const size_t num, const size_t size)
+{
+    JADE_ASSERT(process);
+    return arena_calloc(&process->arena, num, size);
 }
 
 bool jade_process_push_in_message(const uint8_t* data, const size_t size)
@@ -259,6 +293,8 @@ bool jade_process_push_in_message(const uint8_t* data, const size_t size)
     while (xRingbufferSend(shared_in, data, size, 10 / portTICK_PERIOD_MS) != pdTRUE) {
         // wait for a spot in the ringbuffer
     }
+    perf_note_ringbuf_usage(
+        PERF_RINGBUF_SHARED_IN, INPUT_RINGBUF_SIZE - xRingbufferGetCurFreeSize(shared_in), INPUT_RINGBUF_SIZE);
 
     return true;
 }
@@ -274,25 +310,30 @@ void jade_process_push_out_message(const uint8_t* data, const size_t size, const
 #endif
     RingbufHandle_t ring = NULL;
     TaskHandle_t handle = NULL;
+    perf_ringbuf_t perf_ringbuf;
     switch (source) {
     case SOURCE_SERIAL:
         ring = serial_out;
         handle = serial_handle;
+        perf_ringbuf = PERF_RINGBUF_SERIAL_OUT;
         break;
     case SOURCE_QR:
         ring = qr_out;
         handle = qr_handle;
+        perf_ringbuf = PERF_RINGBUF_QR_OUT;
         break;
 #ifdef CONFIG_BT_ENABLED
     case SOURCE_BLE:
         ring = ble_out;
         handle = ble_handle;
+        perf_ringbuf = PERF_RINGBUF_BLE_OUT;
         break;
 #endif
 #if defined(CONFIG_FREERTOS_UNICORE) && defined(CONFIG_ETH_USE_OPENETH)
     case SOURCE_QEMU_TCP:
         ring = qemu_tcp_out;
         handle = qemu_tcp_handle;
+        perf_ringbuf = PERF_RINGBUF_QEMU_TCP_OUT;
         break;
 #endif
     default:
@@ -306,6 +347,8 @@ void jade_process_push_out_message(const uint8_t* data, const size_t size, const
         JADE_LOGE("Message of size %u too large for output queue (max: %u)", size, xRingbufferGetMaxItemSize(ring));
         JADE_ABORT();
     }
+    JADE_TRACE_BEGIN("reply_send");
+    const int64_t send_start_us = esp_timer_get_time();
     while (xRingbufferSend(ring, data, size, 10 / portTICK_PERIOD_MS) != pdTRUE) {
 
         // If the ring buffer is full and the sink process (handle) is not yet running
@@ -319,9 +362,13 @@ void jade_process_push_out_message(const uint8_t* data, const size_t size, const
         }
     }
 
+    perf_note_ringbuf_usage(perf_ringbuf, OUTPUT_RINGBUF_SIZE - xRingbufferGetCurFreeSize(ring), OUTPUT_RINGBUF_SIZE);
+
     if (handle) {
         xTaskNotify(handle, 0, eNoAction);
     }
+    perf_add_reply_send(esp_timer_get_time() - send_start_us);
+    JADE_TRACE_END("reply_send");
 }
 
 #ifdef CONFIG_HEAP_TRACING
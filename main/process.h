@@ -12,6 +12,8 @@
 
 #include <cbor.h>
 
+#include "utils/arena.h"
+
 // This should be the size of the largest valid input message.
 // Used by ble and serial when reading data in. (sign-liquid-txn)
 // NOTE: limited to 17k when SPIRAM not enabled.
@@ -58,6 +60,7 @@ typedef struct {
 typedef struct {
     cbor_msg_t ctx;
     jade_deferred_fn_t* on_exit;
+    arena_t arena;
 } jade_process_t;
 
 typedef struct {
@@ -77,6 +80,11 @@ void jade_process_free_on_exit(jade_process_t* process, void* param);
 void jade_process_wally_free_string_on_exit(jade_process_t* process, char* str);
 void jade_process_call_on_exit(jade_process_t* process, void_fn_t fn, void* param);
 
+// Allocations which live until the process is freed - never passed to free(), as all
+// are zeroized and freed in one go when the process is cleaned up (after on-exit handlers)
+void* jade_process_malloc(jade_process_t* process, size_t size);
+void* jade_process_calloc(jade_process_t* process, size_t num, size_t size);
+
 // A process can have a 'current' input message for processing
 void jade_process_load_in_message(jade_process_t* process, bool blocking);
 void jade_process_transfer_current_message(jade_process_t* process, jade_process_t* new_process);
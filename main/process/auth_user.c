@@ -22,6 +22,8 @@ bool pinclient_get(
     jade_process_t* process, const uint8_t* pin, const size_t pin_len, uint8_t* finalaes, const size_t finalaes_len);
 bool pinclient_set(
     jade_process_t* process, const uint8_t* pin, const size_t pin_len, uint8_t* finalaes, const size_t finalaes_len);
+void pinclient_precompute_start(void);
+void pinclient_discard_precomputed(void);
 
 static void check_wallet_erase_pin(jade_process_t* process, const uint8_t* pin_entered, const size_t pin_len)
 {
@@ -67,6 +69,9 @@ void check_pin_load_keys(jade_process_t* process)
     JADE_ASSERT(pin_insert.activity);
     SENSITIVE_PUSH(&pin_insert, sizeof(pin_insert_t));
 
+    // Prepare the pinserver handshake while the user enters their PIN
+    pinclient_precompute_start();
+
     gui_set_current_activity(pin_insert.activity);
 
 // In a debug unattended ci build, use hardcoded pin after a short delay
@@ -136,7 +141,8 @@ void check_pin_load_keys(jade_process_t* process)
     JADE_LOGI("Success");
 
 cleanup:
-    // Clear out pin and temporary keychain
+    // Clear out pin and temporary keychain, and any unused handshake material
+    pinclient_discard_precomputed();
     SENSITIVE_POP(aeskey);
     SENSITIVE_POP(pin);
     SENSITIVE_POP(&pin_insert);
@@ -160,6 +166,9 @@ static void set_pin_save_keys(jade_process_t* process)
     uint8_t pin[sizeof(pin_insert.pin)];
     SENSITIVE_PUSH(pin, sizeof(pin));
 
+    // Prepare the pinserver handshake while the user enters their PIN
+    pinclient_precompute_start();
+
     while (true) {
         gui_set_current_activity(pin_insert.activity);
 
@@ -228,7 +237,8 @@ static void set_pin_save_keys(jade_process_t* process)
     JADE_LOGI("Success");
 
 cleanup:
-    // Clear out pin and temporary keychain
+    // Clear out pin and temporary keychain, and any unused handshake material
+    pinclient_discard_precomputed();
     SENSITIVE_POP(aeskey);
     SENSITIVE_POP(pin);
     SENSITIVE_POP(&pin_insert);
@@ -11,6 +11,7 @@
 #include "../keychain.h"
 #include "../multisig.h"
 #include "../otpauth.h"
+#include "../perf.h"
 #include "../power.h"
 #include "../process.h"
 #include "../qrmode.h"
@@ -18,6 +19,7 @@
 #include "../selfcheck.h"
 #include "../sensitive.h"
 #include "../storage.h"
+#include "../trace.h"
 #include "../ui.h"
 #include "../utils/cbor_rpc.h"
 #include "../utils/event.h"
@@ -169,9 +171,9 @@ static void reply_version_info(const void* ctx, CborEncoder* container)
     const jade_process_t* process = (const jade_process_t*)ctx;
 
 #ifdef CONFIG_DEBUG_MODE
-    const uint8_t num_version_fields = 19;
+    const uint8_t num_version_fields = 20;
 #else
-    const uint8_t num_version_fields = 12;
+    const uint8_t num_version_fields = 13;
 #endif
 
     CborEncoder map_encoder;
@@ -180,6 +182,7 @@ static void reply_version_info(const void* ctx, CborEncoder* container)
 
     add_string_to_map(&map_encoder, "JADE_VERSION", running_app_info.version);
     add_uint_to_map(&map_encoder, "JADE_OTA_MAX_CHUNK", JADE_OTA_BUF_SIZE);
+    add_uint_to_map(&map_encoder, "JADE_OTA_MAX_WINDOW", JADE_OTA_MAX_WINDOW);
 
     // Config - eg. ble/radio enabled in build, or not
     // defined in ota.h
@@ -324,8 +327,192 @@ static void process_logout_request(jade_process_t* process)
     jade_process_reply_to_message_ok(process);
 }
 
-// method_name should be a string literal - or at least non-null and nul terminated
-#define IS_METHOD(method_name) (!strncmp(method, method_name, method_len) && strlen(method_name) == method_len)
+static void process_get_version_info_request(jade_process_t* process)
+{
+    ASSERT_CURRENT_MESSAGE(process, "get_version_info");
+    jade_process_reply_to_message_result(process->ctx, process, reply_version_info);
+}
+
+static void process_get_perf_stats_request(jade_process_t* process)
+{
+    ASSERT_CURRENT_MESSAGE(process, "get_perf_stats");
+    jade_process_reply_to_message_result(process->ctx, NULL, perf_stats_cb);
+}
+
+// 'cancel' is completely ignored (as nothing is 'in-progress' to cancel)
+static void process_cancel_request(jade_process_t* process)
+{
+    ASSERT_CURRENT_MESSAGE(process, "cancel");
+    JADE_LOGD("Received 'cancel' request - no-op");
+}
+
+#ifdef CONFIG_DEBUG_MODE
+// Time test run and return to caller
+static void process_debug_selfcheck_request(jade_process_t* process)
+{
+    ASSERT_CURRENT_MESSAGE(process, "debug_selfcheck");
+
+    const TickType_t start_time = xTaskGetTickCount();
+    if (debug_selfcheck()) {
+        const TickType_t end_time = xTaskGetTickCount();
+        const uint64_t elapsed_time_ms = (end_time - start_time) * portTICK_PERIOD_MS;
+        jade_process_reply_to_message_result(process->ctx, &elapsed_time_ms, cbor_result_uint64_cb);
+    } else {
+        jade_process_reject_message(process, CBOR_RPC_INTERNAL_ERROR, "ERROR", NULL);
+    }
+}
+
+// Return a page of timeline trace events
+// Recording is paused when the first page is requested, and restarted (empty) after the last
+static void process_debug_get_trace_request(jade_process_t* process)
+{
+    ASSERT_CURRENT_MESSAGE(process, "debug_get_trace");
+    GET_MSG_PARAMS(process);
+
+    size_t index = 0;
+    if (!rpc_get_sizet("index", &params, &index)) {
+        jade_process_reject_message(
+            process, CBOR_RPC_BAD_PARAMETERS, "Failed to extract trace index from parameters", NULL);
+        goto cleanup;
+    }
+
+    const size_t total = trace_pause();
+    if (index > total) {
+        jade_process_reject_message(process, CBOR_RPC_BAD_PARAMETERS, "Invalid trace index", NULL);
+        goto cleanup;
+    }
+
+    jade_process_reply_to_message_result(process->ctx, &index, trace_events_cb);
+    if (index + TRACE_EVENTS_PER_PAGE >= total) {
+        trace_clear_and_resume();
+    }
+
+cleanup:
+    return;
+}
+#endif // CONFIG_DEBUG_MODE
+
+// When a method is available
+typedef enum {
+    // Available before user is authorised
+    METHOD_ALWAYS,
+    // Available if either:
+    // a) User has passed PIN screen and has unlocked Jade saved wallet
+    // or
+    // b) There is no PIN set (ie. no encrypted keys set, eg. new device)
+    METHOD_UNLOCKED_OR_NO_PIN,
+    // Only available after user authorised
+    METHOD_UNLOCKED,
+    // Method we only expect as part of a multi-message protocol (so always rejected here)
+    METHOD_PROTOCOL_ONLY
+} method_access_t;
+
+// NOTE: there is no per-method QR-mode or stack-size metadata - messages from a QR scan are dispatched
+// like any other source, and all methods run on the dashboard task's own stack (not a task of their own).
+typedef struct {
+    const char* name;
+    method_access_t access;
+    // Either a handler run directly by the dashboard, or a function run with its own process object
+    void (*handler)(jade_process_t*);
+    TaskFunction_t task_function;
+} dashboard_method_t;
+
+// All methods handled by the dashboard.
+// NOTE: must be kept sorted by name (as per strcmp()), as looked up by binary search.
+static const dashboard_method_t DASHBOARD_METHODS[] = {
+    { "add_entropy", METHOD_ALWAYS, process_add_entropy_request, NULL },
+    { "auth_user", METHOD_ALWAYS, NULL, auth_user_process },
+    { "cancel", METHOD_ALWAYS, process_cancel_request, NULL },
+#ifdef CONFIG_DEBUG_MODE
+#ifdef CONFIG_RETURN_CAMERA_IMAGES
+    { "debug_capture_image_data", METHOD_ALWAYS, NULL, debug_capture_image_data_process },
+#endif // CONFIG_RETURN_CAMERA_IMAGES
+    { "debug_clean_reset", METHOD_ALWAYS, NULL, debug_clean_reset_process },
+    { "debug_get_trace", METHOD_ALWAYS, process_debug_get_trace_request, NULL },
+    { "debug_handshake", METHOD_ALWAYS, NULL, debug_handshake },
+    { "debug_scan_qr", METHOD_ALWAYS, NULL, debug_scan_qr_process },
+    { "debug_selfcheck", METHOD_ALWAYS, process_debug_selfcheck_request, NULL },
+    { "debug_set_mnemonic", METHOD_ALWAYS, NULL, debug_set_mnemonic_process },
+#endif // CONFIG_DEBUG_MODE
+    { "get_blinding_factor", METHOD_UNLOCKED, NULL, get_blinding_factor_process },
+    { "get_blinding_key", METHOD_UNLOCKED, NULL, get_blinding_key_process },
+    { "get_commitments", METHOD_UNLOCKED, NULL, get_commitments_process },
+    { "get_extended_data", METHOD_PROTOCOL_ONLY, NULL, NULL },
+    { "get_identity_pubkey", METHOD_UNLOCKED, NULL, get_identity_pubkey_process },
+    { "get_identity_shared_key", METHOD_UNLOCKED, NULL, get_identity_shared_key_process },
+    { "get_master_blinding_key", METHOD_UNLOCKED, NULL, get_master_blinding_key_process },
+    { "get_otp_code", METHOD_UNLOCKED, NULL, get_otp_code_process },
+    { "get_perf_stats", METHOD_UNLOCKED, process_get_perf_stats_request, NULL },
+    { "get_receive_address", METHOD_UNLOCKED, NULL, get_receive_address_process },
+    { "get_registered_multisigs", METHOD_UNLOCKED, NULL, get_registered_multisigs_process },
+    { "get_shared_nonce", METHOD_UNLOCKED, NULL, get_shared_nonce_process },
+    { "get_signature", METHOD_PROTOCOL_ONLY, NULL, NULL },
+    { "get_version_info", METHOD_ALWAYS, process_get_version_info_request, NULL },
+    { "get_xpub", METHOD_UNLOCKED, NULL, get_xpubs_process },
+    { "handshake_complete", METHOD_PROTOCOL_ONLY, NULL, NULL },
+    { "handshake_init", METHOD_PROTOCOL_ONLY, NULL, NULL },
+    { "logout", METHOD_ALWAYS, process_logout_request, NULL },
+    { "ota", METHOD_UNLOCKED_OR_NO_PIN, NULL, ota_process },
+    { "ota_complete", METHOD_PROTOCOL_ONLY, NULL, NULL },
+    { "ota_data", METHOD_PROTOCOL_ONLY, NULL, NULL },
+    { "ota_delta", METHOD_UNLOCKED_OR_NO_PIN, NULL, ota_delta_process },
+    { "ota_resume", METHOD_PROTOCOL_ONLY, NULL, NULL },
+    { "register_multisig", METHOD_UNLOCKED, NULL, register_multisig_process },
+    { "register_otp", METHOD_UNLOCKED, NULL, register_otp_process },
+    { "set_epoch", METHOD_ALWAYS, process_set_epoch_request, NULL },
+    { "sign_identity", METHOD_UNLOCKED, NULL, sign_identity_process },
+    { "sign_liquid_tx", METHOD_UNLOCKED, NULL, sign_liquid_tx_process },
+    { "sign_message", METHOD_UNLOCKED, NULL, sign_message_process },
+    { "sign_psbt", METHOD_UNLOCKED, NULL, sign_psbt_process },
+    { "sign_tx", METHOD_UNLOCKED, NULL, sign_tx_process },
+    { "tx_input", METHOD_PROTOCOL_ONLY, NULL, NULL },
+    { "update_pinserver", METHOD_ALWAYS, NULL, update_pinserver_process },
+};
+static const size_t NUM_DASHBOARD_METHODS = sizeof(DASHBOARD_METHODS) / sizeof(DASHBOARD_METHODS[0]);
+
+// Compare a (not nul-terminated) method name with a table entry name, consistent with strcmp()
+static int compare_method_name(const char* method, const size_t method_len, const char* name)
+{
+    const int ret = strncmp(method, name, method_len);
+    if (ret) {
+        return ret;
+    }
+    // Equal if all of 'name' consumed, otherwise 'method' is a prefix of 'name' so sorts first
+    return name[method_len] ? -1 : 0;
+}
+
+// Binary search of the sorted method table
+static const dashboard_method_t* find_method(const char* method, const size_t method_len)
+{
+    JADE_ASSERT(method);
+
+    size_t lo = 0;
+    size_t hi = NUM_DASHBOARD_METHODS;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        const int cmp = compare_method_name(method, method_len, DASHBOARD_METHODS[mid].name);
+        if (!cmp) {
+            return &DASHBOARD_METHODS[mid];
+        } else if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+// Sanity check the method table is correctly sorted and each entry has exactly one handler
+static void check_method_table(void)
+{
+    for (size_t i = 0; i < NUM_DASHBOARD_METHODS; ++i) {
+        const dashboard_method_t* const entry = &DASHBOARD_METHODS[i];
+        JADE_ASSERT(!i || strcmp(DASHBOARD_METHODS[i - 1].name, entry->name) < 0);
+        JADE_ASSERT(strlen(entry->name) <= PERF_MAX_METHOD_NAME_LEN);
+        JADE_ASSERT((entry->access == METHOD_PROTOCOL_ONLY) == (!entry->handler && !entry->task_function));
+        JADE_ASSERT(!entry->handler || !entry->task_function);
+    }
+}
 
 // Message dispatcher - expects valid cbor messages, routed by 'method'
 static void dispatch_message(jade_process_t* process)
@@ -339,152 +526,73 @@ static void dispatch_message(jade_process_t* process)
     rpc_get_method(&process->ctx.value, &method, &method_len);
     JADE_ASSERT(method_len != 0);
 
-    TaskFunction_t task_function = NULL;
-
     JADE_LOGD("dashboard dispatching message method='%.*s'", method_len, method);
 
-    // Methods available before user is authorised
-    if (IS_METHOD("get_version_info")) {
-        JADE_LOGD("Received request for version");
-        jade_process_reply_to_message_result(process->ctx, process, reply_version_info);
-    } else if (IS_METHOD("add_entropy")) {
-        JADE_LOGD("Received external entropy message");
-        process_add_entropy_request(process);
-    } else if (IS_METHOD("set_epoch")) {
-        JADE_LOGD("Received set-epoch message");
-        process_set_epoch_request(process);
-    } else if (IS_METHOD("logout")) {
-        JADE_LOGD("Received logout message");
-        process_logout_request(process);
-    } else if (IS_METHOD("update_pinserver")) {
-        JADE_LOGD("Received update to pinserver details");
-        task_function = update_pinserver_process;
-    } else if (IS_METHOD("auth_user")) {
-        JADE_LOGD("Received auth-user request");
-        task_function = auth_user_process;
-    } else if (IS_METHOD("cancel")) {
-        // 'cancel' is completely ignored (as nothing is 'in-progress' to cancel)
-        JADE_LOGD("Received 'cancel' request - no-op");
-    } else if (IS_METHOD("ota")) {
-        // OTA is allowed if either:
-        // a) User has passed PIN screen and has unlocked Jade saved wallet
-        // or
-        // b) There is no PIN set (ie. no encrypted keys set, eg. new device)
-        if ((KEYCHAIN_UNLOCKED_BY_MESSAGE_SOURCE(process) && !keychain_has_temporary()) || !keychain_has_pin()) {
-            task_function = ota_process;
-        } else {
-            // Reject the message as hw locked
-            jade_process_reject_message(
-                process, CBOR_RPC_HW_LOCKED, "OTA is only allowed on new or logged-in device.", NULL);
-        }
-    } else if (IS_METHOD("ota_delta")) {
-        // OTA delta is allowed if either:
-        // a) User has passed PIN screen and has unlocked Jade saved wallet
-        // or
-        // b) There is no PIN set (ie. no encrypted keys set, eg. new device)
-        if ((KEYCHAIN_UNLOCKED_BY_MESSAGE_SOURCE(process) && !keychain_has_temporary()) || !keychain_has_pin()) {
-            task_function = ota_delta_process;
-        } else {
-            // Reject the message as hw locked
-            jade_process_reject_message(
-                process, CBOR_RPC_HW_LOCKED, "OTA delta is only allowed on new or logged-in device.", NULL);
-        }
-#ifdef CONFIG_DEBUG_MODE
-    } else if (IS_METHOD("debug_selfcheck")) {
-        // Time test run and return to caller
-        const TickType_t start_time = xTaskGetTickCount();
-        if (debug_selfcheck()) {
-            const TickType_t end_time = xTaskGetTickCount();
-            const uint64_t elapsed_time_ms = (end_time - start_time) * portTICK_PERIOD_MS;
-            jade_process_reply_to_message_result(process->ctx, &elapsed_time_ms, cbor_result_uint64_cb);
-        } else {
-            jade_process_reject_message(process, CBOR_RPC_INTERNAL_ERROR, "ERROR", NULL);
-        }
-    } else if (IS_METHOD("debug_clean_reset")) {
-        task_function = debug_clean_reset_process;
-    } else if (IS_METHOD("debug_set_mnemonic")) {
-        task_function = debug_set_mnemonic_process;
-    } else if (IS_METHOD("debug_handshake")) {
-        task_function = debug_handshake;
-    } else if (IS_METHOD("debug_scan_qr")) {
-        task_function = debug_scan_qr_process;
-#ifdef CONFIG_RETURN_CAMERA_IMAGES
-    } else if (IS_METHOD("debug_capture_image_data")) {
-        task_function = debug_capture_image_data_process;
-#endif // CONFIG_RETURN_CAMERA_IMAGES
-#endif // CONFIG_DEBUG_MODE
-    } else {
-        // Methods only available after user authorised
-        if (!KEYCHAIN_UNLOCKED_BY_MESSAGE_SOURCE(process)) {
+    const dashboard_method_t* const entry = find_method(method, method_len);
+    const method_access_t access = entry ? entry->access : METHOD_UNLOCKED;
+
+    if (access == METHOD_UNLOCKED_OR_NO_PIN) {
+        if (keychain_has_pin() && (!KEYCHAIN_UNLOCKED_BY_MESSAGE_SOURCE(process) || keychain_has_temporary())) {
             // Reject the message as hw locked
-            jade_process_reject_message(
-                process, CBOR_RPC_HW_LOCKED, "Cannot process message - hardware locked or uninitialized", NULL);
-        } else if (IS_METHOD("register_otp")) {
-            task_function = register_otp_process;
-        } else if (IS_METHOD("get_otp_code")) {
-            task_function = get_otp_code_process;
-        } else if (IS_METHOD("get_xpub")) {
-            task_function = get_xpubs_process;
-        } else if (IS_METHOD("get_registered_multisigs")) {
-            task_function = get_registered_multisigs_process;
-        } else if (IS_METHOD("register_multisig")) {
-            task_function = register_multisig_process;
-        } else if (IS_METHOD("get_receive_address")) {
-            task_function = get_receive_address_process;
-        } else if (IS_METHOD("get_identity_pubkey")) {
-            task_function = get_identity_pubkey_process;
-        } else if (IS_METHOD("get_identity_shared_key")) {
-            task_function = get_identity_shared_key_process;
-        } else if (IS_METHOD("sign_identity")) {
-            task_function = sign_identity_process;
-        } else if (IS_METHOD("sign_message")) {
-            task_function = sign_message_process;
-        } else if (IS_METHOD("sign_psbt")) {
-            task_function = sign_psbt_process;
-        } else if (IS_METHOD("sign_tx")) {
-            task_function = sign_tx_process;
-        } else if (IS_METHOD("sign_liquid_tx")) {
-            task_function = sign_liquid_tx_process;
-        } else if (IS_METHOD("get_commitments")) {
-            task_function = get_commitments_process;
-        } else if (IS_METHOD("get_blinding_factor")) {
-            task_function = get_blinding_factor_process;
-        } else if (IS_METHOD("get_master_blinding_key")) {
-            task_function = get_master_blinding_key_process;
-        } else if (IS_METHOD("get_blinding_key")) {
-            task_function = get_blinding_key_process;
-        } else if (IS_METHOD("get_shared_nonce")) {
-            task_function = get_shared_nonce_process;
-        } else if (IS_METHOD("ota_data") || IS_METHOD("ota_complete") || IS_METHOD("tx_input")
-            || IS_METHOD("get_extended_data") || IS_METHOD("get_signature") || IS_METHOD("handshake_init")
-            || IS_METHOD("handshake_complete")) {
-            // Method we only expect as part of a multi-message protocol
-            jade_process_reject_message(process, CBOR_RPC_PROTOCOL_ERROR, "Unexpected method", NULL);
-        } else {
-            // Reject the message as unknown, and free message
-            jade_process_reject_message(process, CBOR_RPC_UNKNOWN_METHOD, "Unknown method", NULL);
+            const char* const message = entry->task_function == ota_delta_process
+                ? "OTA delta is only allowed on new or logged-in device."
+                : "OTA is only allowed on new or logged-in device.";
+            jade_process_reject_message(process, CBOR_RPC_HW_LOCKED, message, NULL);
+            return;
         }
+    } else if (access != METHOD_ALWAYS && !KEYCHAIN_UNLOCKED_BY_MESSAGE_SOURCE(process)) {
+        // Reject the message as hw locked
+        jade_process_reject_message(
+            process, CBOR_RPC_HW_LOCKED, "Cannot process message - hardware locked or uninitialized", NULL);
+        return;
     }
 
-    if (task_function) {
-        // Make new process object for the message
-        jade_process_t task_process;
-        init_jade_process(&task_process);
-        jade_process_transfer_current_message(process, &task_process);
+    if (!entry) {
+        // Reject the message as unknown, and free message
+        jade_process_reject_message(process, CBOR_RPC_UNKNOWN_METHOD, "Unknown method", NULL);
+        return;
+    }
 
-        // re-randomize secp256k1 ctx for this task
-        jade_wally_randomize_secp_ctx();
+    if (access == METHOD_PROTOCOL_ONLY) {
+        // Method we only expect as part of a multi-message protocol
+        jade_process_reject_message(process, CBOR_RPC_PROTOCOL_ERROR, "Unexpected method", NULL);
+        return;
+    }
 
-        // Call the function
-        task_function(&task_process);
+    // Collect timings for the method
+    perf_request_begin(entry - DASHBOARD_METHODS, entry->name);
+    JADE_TRACE_BEGIN(entry->name);
 
-        // Then clean up after the process has finished
-        cleanup_jade_process(&task_process);
+    if (entry->handler) {
+        // Handled directly by the dashboard
+        entry->handler(process);
+        JADE_TRACE_END(entry->name);
+        perf_request_end();
+        return;
+    }
 
-        // When the authentication process exits, wipe the cached 'initialistion source'
-        if (task_function == auth_user_process) {
-            initialisation_source = SOURCE_NONE;
-        }
+    const TaskFunction_t task_function = entry->task_function;
+    JADE_ASSERT(task_function);
+
+    // Make new process object for the message
+    jade_process_t task_process;
+    init_jade_process(&task_process);
+    jade_process_transfer_current_message(process, &task_process);
+
+    // re-randomize secp256k1 ctx for this task
+    jade_wally_randomize_secp_ctx();
+
+    // Call the function
+    task_function(&task_process);
+
+    // Then clean up after the process has finished
+    cleanup_jade_process(&task_process);
+    JADE_TRACE_END(entry->name);
+    perf_request_end();
+
+    // When the authentication process exits, wipe the cached 'initialistion source'
+    if (task_function == auth_user_process) {
+        initialisation_source = SOURCE_NONE;
     }
 }
 
@@ -739,20 +847,20 @@ static void handle_ble(void) { await_message_activity("BLE disabled in this firm
 
 static void handle_multisigs(void)
 {
-    char names[MAX_MULTISIG_REGISTRATIONS][NVS_KEY_NAME_MAX_SIZE]; // Sufficient
-    const size_t num_names = sizeof(names) / sizeof(names[0]);
-    size_t num_multisigs = 0;
-    bool ok = storage_get_all_multisig_registration_names(names, num_names, &num_multisigs);
-    JADE_ASSERT(ok);
-
+    size_t num_multisigs = multisig_get_registration_count();
     if (num_multisigs == 0) {
         await_message_activity("No m-of-n multisigs registered");
         return;
     }
 
-    for (int i = 0; i < num_multisigs; ++i) {
+    // Walk the registrations index, loading each full record only as it is viewed
+    size_t i = 0;
+    while (i < num_multisigs) {
+        multisig_summary_t summary;
+        multisig_get_registration_summary(i, &summary);
+
         const char* errmsg = NULL;
-        const char* multisig_name = names[i];
+        const char* multisig_name = summary.name;
         multisig_data_t multisig_data;
         const bool valid = multisig_load_from_storage(multisig_name, &multisig_data, &errmsg);
 
@@ -769,11 +877,12 @@ static void handle_multisigs(void)
             multisig_data.master_blinding_key_len);
         JADE_ASSERT(act);
 
+        bool deleted = false;
         while (true) {
             gui_set_current_activity(act);
 
             int32_t ev_id;
-            ok = gui_activity_wait_event(act, GUI_BUTTON_EVENT, ESP_EVENT_ANY_ID, NULL, &ev_id, NULL, 0);
+            bool ok = gui_activity_wait_event(act, GUI_BUTTON_EVENT, ESP_EVENT_ANY_ID, NULL, &ev_id, NULL, 0);
             if (ok && ev_id == BTN_MULTISIG_DELETE) {
                 char message[128];
                 const int ret = snprintf(message, sizeof(message), "Delete registered multisig?\n\n%s", multisig_name);
@@ -782,11 +891,19 @@ static void handle_multisigs(void)
                     continue;
                 }
 
-                ok = storage_erase_multisig_registration(multisig_name);
+                ok = multisig_erase_registration(multisig_name);
                 JADE_ASSERT(ok);
+                deleted = true;
             }
             break;
         };
+
+        // If deleted, the subsequent registrations move down the index
+        if (deleted) {
+            --num_multisigs;
+        } else {
+            ++i;
+        }
     }
 }
 
@@ -1106,11 +1223,12 @@ static void handle_view_otps(void)
         make_view_otp_activity(&act, i + 1, num_otp_records, valid, &otp_ctx);
         JADE_ASSERT(act);
 
+        bool deleted = false;
         while (true) {
             gui_set_current_activity(act);
 
             int32_t ev_id;
-            ok = gui_activity_wait_event(act, GUI_BUTTON_EVENT, ESP_EVENT_ANY_ID, NULL, &ev_id, NULL, 0);
+            bool ok = gui_activity_wait_event(act, GUI_BUTTON_EVENT, ESP_EVENT_ANY_ID, NULL, &ev_id, NULL, 0);
             if (ok && ev_id == BTN_OTP_DELETE) {
                 char message[128];
                 const int ret = snprintf(message, sizeof(message), "Delete OTP record?\n\n%s", otp_name);
@@ -1716,14 +1834,28 @@ static void do_dashboard(jade_process_t* process, const keychain_t* const initia
     }
 }
 
-// Helper to create a dashboard activity using the function passed, and then register
-// the button event handler which we check if there are no external messages to handle.
-#define MAKE_DASHBOARD_SCREEN(fn_make_activity, activity, extra_arg)                                                   \
+// The dashboard screens are cached, so returning to them is quick - held while in use
+static gui_activity_cache_entry_t setup_screen_cache;
+static gui_activity_cache_entry_t connect_screen_cache;
+static gui_activity_cache_entry_t connect_to_screen_cache;
+static gui_activity_cache_entry_t welcome_back_screen_cache;
+
+// Helper to fetch a cached dashboard activity or else create one using the function passed,
+// and then register the button event handler which we check if there are no external messages
+// to handle.  The cache entry is held, and so the activity retained, until explicitly released.
+#define MAKE_DASHBOARD_SCREEN(fn_make_activity, activity, extra_arg, cache, key)                                       \
     do {                                                                                                               \
-        fn_make_activity(&activity, device_name, extra_arg);                                                           \
-        JADE_ASSERT(activity);                                                                                         \
-        gui_activity_register_event(                                                                                   \
-            activity, GUI_BUTTON_EVENT, ESP_EVENT_ANY_ID, sync_wait_event_handler, event_data);                        \
+        if (gui_activity_cache_lookup(&cache, key)) {                                                                  \
+            activity = cache.activities[0];                                                                            \
+        } else {                                                                                                       \
+            fn_make_activity(&activity, device_name, extra_arg);                                                       \
+            JADE_ASSERT(activity);                                                                                     \
+            gui_activity_register_event(                                                                               \
+                activity, GUI_BUTTON_EVENT, ESP_EVENT_ANY_ID, sync_wait_event_handler, event_data);                    \
+            gui_activity_cache_add(&cache, key, activity);                                                             \
+        }                                                                                                              \
+        gui_activity_cache_hold(&cache, true);                                                                         \
+        dashboard_cache = &cache;                                                                                      \
     } while (false)
 
 // Small helper to update additional info labels on the 'Ready' dashboard screen
@@ -1752,13 +1884,6 @@ static void update_ready_screen_text(gui_view_node_t* txt_label, gui_view_node_t
     gui_update_text(txt_extra, extra);
 }
 
-// Wrapper to put calls to free activities onto the process
-static void free_unmanaged_activity_wrapper(void* activity_to_free)
-{
-    gui_activity_t* activity = (gui_activity_t*)activity_to_free;
-    free_unmanaged_activity(activity);
-}
-
 // Main/default screen/process when ready for user interaction
 void dashboard_process(void* process_ptr)
 {
@@ -1770,6 +1895,8 @@ void dashboard_process(void* process_ptr)
     // At startup we may have entered an emergency restore mnemonic
     // otherwise we'd expect no keychain at this point.
     JADE_ASSERT(!keychain_get() || keychain_has_temporary());
+    check_method_table();
+    perf_init(NUM_DASHBOARD_METHODS);
 
     // Populate the static fields about the unit/fw
     device_name = get_jade_id();
@@ -1812,11 +1939,11 @@ void dashboard_process(void* process_ptr)
         //    - connect screen
         // 6. Uninitialised - has no persisted/encrypted keys and no keys in memory
         //    - setup screen
-        // NOTE: Some dashboard screens are created as 'unmanaged' activities, so are not placed
-        // in the list of activities to be freed by 'set_current_activity_ex()' calls, so any
-        // 'act_dashboard' created here must be explicitly freed when no longer relevant.
-        // 'free_dashboard' is set when this is the case.
-        bool free_dashboard = false;
+        // NOTE: Most dashboard screens are cached activities, so are not freed by 'set_current_activity_ex()'
+        // calls, and are reused when next shown.  The cache entry of any 'act_dashboard' fetched here is held
+        // while in use (so it is not evicted), and must be released when no longer relevant.
+        // 'dashboard_cache' is set when this is the case.
+        gui_activity_cache_entry_t* dashboard_cache = NULL;
         gui_activity_t* act_dashboard = NULL;
         const bool has_pin = keychain_has_pin();
         const keychain_t* initial_keychain = keychain_get();
@@ -1825,27 +1952,25 @@ void dashboard_process(void* process_ptr)
             update_ready_screen_text(txt_label, txt_extra);
             show_connect_screen = false;
             act_dashboard = act_ready;
-            // free_dashboard is not required as this screen lives for the lifetime of the application
+            // not cached, as this screen lives for the lifetime of the application
         } else if (initialisation_source == SOURCE_QR) {
             JADE_LOGI("Awaiting QR initialisation");
             act_dashboard = display_message_activity("Processing...");
-            // free_dashboard is not required as this is a standard 'managed' activity
+            // not cached, as this is a standard 'managed' activity
         } else if (initial_keychain) {
             JADE_LOGI("Wallet/keys initialised but not yet saved - showing Connect-To screen");
-            MAKE_DASHBOARD_SCREEN(make_connect_to_screen, act_dashboard, initialisation_source);
-            // free_dashboard is not required as this is a standard 'managed' activity
+            MAKE_DASHBOARD_SCREEN(make_connect_to_screen, act_dashboard, initialisation_source, connect_to_screen_cache,
+                initialisation_source);
         } else if (show_connect_screen) {
             JADE_LOGI("User navigated to 'connect' screen");
-            MAKE_DASHBOARD_SCREEN(make_connect_screen, act_dashboard, NULL);
-            // free_dashboard is not required as this is a standard 'managed' activity
+            MAKE_DASHBOARD_SCREEN(make_connect_screen, act_dashboard, NULL, connect_screen_cache, 0);
         } else if (has_pin) {
             JADE_LOGI("Wallet/keys pin set but not yet loaded - showing Welcome-Back screen");
-            MAKE_DASHBOARD_SCREEN(make_welcome_back_screen, act_dashboard, running_app_info.version);
-            free_dashboard = true;
+            MAKE_DASHBOARD_SCREEN(
+                make_welcome_back_screen, act_dashboard, running_app_info.version, welcome_back_screen_cache, 0);
         } else {
             JADE_LOGI("No wallet/keys and no pin set - showing Setup screen");
-            MAKE_DASHBOARD_SCREEN(make_setup_screen, act_dashboard, running_app_info.version);
-            free_dashboard = true;
+            MAKE_DASHBOARD_SCREEN(make_setup_screen, act_dashboard, running_app_info.version, setup_screen_cache, 0);
         }
 
         // This call loops/blocks all the time the user keychain (and related details)
@@ -1855,9 +1980,9 @@ void dashboard_process(void* process_ptr)
         // be cleared (and bzero'd).
         do_dashboard(process, initial_keychain, has_pin, act_dashboard, event_data);
 
-        // Free (defered slightly) any dashboard screen if flagged as needing explicit free
-        if (free_dashboard) {
-            jade_process_call_on_exit(process, free_unmanaged_activity_wrapper, act_dashboard);
+        // Release any cached dashboard screen, so it can be evicted if memory becomes low
+        if (dashboard_cache) {
+            gui_activity_cache_hold(dashboard_cache, false);
         }
     }
 }
@@ -37,7 +37,7 @@ void debug_clean_reset_process(void* process_ptr)
     JADE_ASSERT(ok);
 
     for (int i = 0; i < num_multisigs; ++i) {
-        ok = storage_erase_multisig_registration(multisig_names[i]);
+        ok = multisig_erase_registration(multisig_names[i]);
         JADE_ASSERT(ok);
     }
 
@@ -3,12 +3,13 @@
 #include "../process.h"
 #include "../storage.h"
 #include "../utils/cbor_rpc.h"
+#include "../utils/malloc_ext.h"
 #include "../wallet.h"
 
 #include "process_utils.h"
 
 typedef struct {
-    const char* name;
+    char name[MAX_MULTISIG_NAME_SIZE];
     const char* variant;
     bool sorted;
     bool has_master_blinding_key;
@@ -72,55 +73,49 @@ void get_registered_multisigs_process(void* process_ptr)
     ASSERT_CURRENT_MESSAGE(process, "get_registered_multisigs");
     ASSERT_KEYCHAIN_UNLOCKED_BY_MESSAGE_SOURCE(process);
 
-    // Get registered multisig names
-    char names[MAX_MULTISIG_REGISTRATIONS][NVS_KEY_NAME_MAX_SIZE]; // Sufficient
-    const size_t num_names = sizeof(names) / sizeof(names[0]);
-    size_t num_multisigs = 0;
-    if (!storage_get_all_multisig_registration_names(names, num_names, &num_multisigs)) {
-        jade_process_reject_message(process, CBOR_RPC_INTERNAL_ERROR, "Failed to load multisig registrations", NULL);
-        goto cleanup;
-    }
-
-    // Load description of each
-    multisig_descriptions_t descriptions;
-    descriptions.num_multisigs = 0;
-    JADE_ASSERT(num_multisigs <= sizeof(descriptions.multisigs) / sizeof(descriptions.multisigs[0]));
-    for (int i = 0; i < num_multisigs; ++i) {
-        const char* errmsg = NULL;
-        multisig_data_t multisig_data;
-        const bool valid = multisig_load_from_storage(names[i], &multisig_data, &errmsg);
-
-        // If valid for this wallet, add description/summary info
-        if (valid) {
-            multisig_desc_t* const desc = descriptions.multisigs + descriptions.num_multisigs;
-            desc->name = names[i];
-            desc->variant = get_script_variant_string(multisig_data.variant);
-            desc->sorted = multisig_data.sorted;
-            desc->threshold = multisig_data.threshold;
-            desc->num_signers = multisig_data.num_xpubs;
-
-            // Optional liquid master blinding key
-            if (multisig_data.master_blinding_key_len) {
-                JADE_ASSERT(multisig_data.master_blinding_key_len == sizeof(desc->master_blinding_key));
-                memcpy(desc->master_blinding_key, multisig_data.master_blinding_key,
-                    multisig_data.master_blinding_key_len);
-                desc->has_master_blinding_key = true;
-            } else {
-                desc->has_master_blinding_key = false;
-            }
+    // Describe each registration from the index summary, only loading the full record
+    // if required to fetch any liquid master blinding key.
+    multisig_descriptions_t* const descriptions = jade_process_malloc(process, sizeof(multisig_descriptions_t));
+    descriptions->num_multisigs = 0;
 
-            ++descriptions.num_multisigs;
-        } else if (errmsg) {
+    const size_t num_multisigs = multisig_get_registration_count();
+    JADE_ASSERT(num_multisigs <= sizeof(descriptions->multisigs) / sizeof(descriptions->multisigs[0]));
+    for (size_t i = 0; i < num_multisigs; ++i) {
+        multisig_summary_t summary;
+        if (!multisig_get_registration_summary(i, &summary)) {
             // Corrupt or for another wallet - just log and skip
-            JADE_LOGD("%s", errmsg);
+            JADE_LOGD("Skipping multisig %s as not valid for this wallet", summary.name);
+            continue;
+        }
+
+        // Valid for this wallet, add description/summary info
+        multisig_desc_t* const desc = descriptions->multisigs + descriptions->num_multisigs;
+        strcpy(desc->name, summary.name);
+        desc->variant = get_script_variant_string(summary.variant);
+        desc->sorted = summary.sorted;
+        desc->threshold = summary.threshold;
+        desc->num_signers = summary.num_signers;
+        desc->has_master_blinding_key = false;
+
+        // Optional liquid master blinding key
+        if (summary.has_master_blinding_key) {
+            const char* errmsg = NULL;
+            multisig_data_t multisig_data;
+            if (!multisig_load_from_storage(summary.name, &multisig_data, &errmsg) || errmsg
+                || !multisig_data.master_blinding_key_len) {
+                JADE_LOGW("Failed to load blinding key for multisig %s", summary.name);
+                continue;
+            }
+            JADE_ASSERT(multisig_data.master_blinding_key_len == sizeof(desc->master_blinding_key));
+            memcpy(desc->master_blinding_key, multisig_data.master_blinding_key, multisig_data.master_blinding_key_len);
+            desc->has_master_blinding_key = true;
         }
+
+        ++descriptions->num_multisigs;
     }
 
     // Reply with this info
-    jade_process_reply_to_message_result(process->ctx, &descriptions, reply_registered_multisigs);
+    jade_process_reply_to_message_result(process->ctx, descriptions, reply_registered_multisigs);
 
     JADE_LOGI("Success");
-
-cleanup:
-    return;
 }
@@ -1150,6 +1150,7 @@ static void get_freetext_passphrase(char* passphrase, const size_t passphrase_le
                 gui_set_current_activity(confirm_passphrase_activity);
                 gui_activity_wait_event(
                     confirm_passphrase_activity, GUI_BUTTON_EVENT, ESP_EVENT_ANY_ID, NULL, &ev_id, NULL, 0);
+                gui_update_text(text_to_confirm, "");
                 done = (ev_id == BTN_YES);
             } else {
                 done = await_yesno_activity("Confirm Passphrase", "Do you confirm the empty\npassphrase?", false);
@@ -1162,6 +1163,7 @@ static void get_freetext_passphrase(char* passphrase, const size_t passphrase_le
 
     JADE_ASSERT(kb_entry.len < passphrase_len);
     strcpy(passphrase, kb_entry.strdata);
+    JADE_WALLY_VERIFY(wally_bzero(kb_entry.strdata, sizeof(kb_entry.strdata)));
 }
 
 void get_passphrase(char* passphrase, const size_t passphrase_len, const bool confirm)
@@ -24,6 +24,7 @@
 typedef struct {
     bool* prevalidated;
     jade_ota_ctx_t* joctx;
+    ota_writer_t* writer;
 } ota_deflate_ctx_t;
 
 /* this is called by the deflate library when it has uncompressed data to write */
@@ -46,18 +47,13 @@ static int uncompressed_stream_writer(void* ctx, uint8_t* uncompressed, size_t t
         *octx->prevalidated = true;
     }
 
-    const esp_err_t res = esp_ota_write(*octx->joctx->ota_handle, (const void*)uncompressed, towrite);
-    if (res != ESP_OK) {
-        JADE_LOGE("ota_write() error: %u", res);
+    // Pass to the writer task to write to flash (and hash), while we continue to decompress
+    if (!ota_writer_write(octx->writer, uncompressed, towrite)) {
+        JADE_LOGE("ota_writer_write() error");
         *octx->joctx->ota_return_status = ERROR_WRITE;
         return DEFLATE_ERROR;
     }
 
-    if (octx->joctx->hash_type == HASHTYPE_FULLFWDATA) {
-        // Add written to hash calculation
-        mbedtls_sha256_update(octx->joctx->sha_ctx, uncompressed, towrite);
-    }
-
     *octx->joctx->remaining_uncompressed -= towrite;
     const size_t written = octx->joctx->uncompressedsize - *octx->joctx->remaining_uncompressed;
 
@@ -90,6 +86,7 @@ void ota_process(void* process_ptr)
     // Context used to compute (compressed) firmware hash - ie. file as uploaded
     mbedtls_sha256_context sha_ctx;
     esp_ota_handle_t ota_handle = 0;
+    ota_writer_t writer = {};
 
     // We expect a current message to be present
     ASSERT_CURRENT_MESSAGE(process, "ota");
@@ -124,6 +121,13 @@ void ota_process(void* process_ptr)
     JADE_WALLY_VERIFY(wally_hex_from_bytes(expected_hash, sizeof(expected_hash), &expected_hash_hexstr));
     jade_process_wally_free_string_on_exit(process, expected_hash_hexstr);
 
+    // Optionally the host may keep several chunks in flight
+    size_t window = 0;
+    if (!ota_get_window_param(&params, &window)) {
+        jade_process_reject_message(process, CBOR_RPC_BAD_PARAMETERS, "Invalid upload window size", NULL);
+        goto cleanup;
+    }
+
     // We will show a progress bar once the user has confirmed and the upload in progress
     // Initially just show a message screen.
     display_message_activity_two_lines("Preparing for firmware", "update");
@@ -134,6 +138,7 @@ void ota_process(void* process_ptr)
 
     ota_deflate_ctx_t octx = {
         .prevalidated = &prevalidated,
+        .writer = &writer,
     };
 
     size_t remaining_uncompressed = firmwaresize;
@@ -154,6 +159,8 @@ void ota_process(void* process_ptr)
         .firmwaresize = firmwaresize,
         .expected_hash_hexstr = expected_hash_hexstr,
         .expected_hash = expected_hash,
+        .window = window,
+        .next_seq = 0,
     };
 
     octx.joctx = &joctx;
@@ -162,6 +169,7 @@ void ota_process(void* process_ptr)
         jade_process_reject_message(process, CBOR_RPC_INTERNAL_ERROR, "Failed to initialize OTA", NULL);
         goto cleanup;
     }
+    ota_writer_start(&writer, &joctx);
 
     const int dret
         = deflate_init_write_compressed(dctx, compressedsize, firmwaresize, uncompressed_stream_writer, &octx);
@@ -186,6 +194,12 @@ void ota_process(void* process_ptr)
     // Uploading complete
     uploading = false;
 
+    // Wait for all firmware to be written to flash
+    if (!ota_writer_finish(&writer)) {
+        JADE_LOGE("Error writing firmware to flash");
+        ota_return_status = ERROR_WRITE;
+    }
+
     // Bail-out if the fw uncompressed to an unexpected size
     if (remaining_uncompressed != 0) {
         JADE_LOGE("Expected uncompressed size: %u, got %u", firmwaresize, firmwaresize - remaining_uncompressed);
@@ -193,11 +207,14 @@ void ota_process(void* process_ptr)
     }
 
     // Expect a complete/request for status
-    jade_process_load_in_message(process, true);
+    ota_load_final_message(process, &joctx);
     if (!IS_CURRENT_MESSAGE(process, "ota_complete")) {
-        // Protocol error
+        // Protocol error - abandon the upload
         jade_process_reject_message(
             process, CBOR_RPC_PROTOCOL_ERROR, "Unexpected message, expecting 'ota_complete'", NULL);
+        if (ota_return_status == SUCCESS) {
+            ota_return_status = ERROR_BADDATA;
+        }
         goto cleanup;
     }
 
@@ -219,6 +236,8 @@ void ota_process(void* process_ptr)
     JADE_LOGI("Success");
 
 cleanup:
+    // Ensure the writer task has stopped before the ota is finalised/abandoned
+    ota_writer_finish(&writer);
     mbedtls_sha256_free(&sha_ctx);
 
     // If ota has been successful show message and reboot.
@@ -6,6 +6,11 @@
 // OTA chunk size - should be less that MAX_INPUT_MSG_SIZE
 #define JADE_OTA_BUF_SIZE (4096)
 
+// Maximum number of OTA chunks the host may have 'in flight' (ie. sent but not yet acknowledged)
+// NOTE: each chunk is processed before the next is read, so a larger window only queues more data in the
+// input ringbuffer (which applies back-pressure to the connection when full) - it need not fit them all.
+#define JADE_OTA_MAX_WINDOW 4
+
 // Some config/features compiled into the firmware
 
 // Whether the ble/radio is configured/enabled
@@ -14,6 +14,7 @@
 
 #include <esp_efuse.h>
 #include <esp_ota_ops.h>
+#include <esp_partition.h>
 
 #include <mbedtls/sha256.h>
 #include <wally_core.h>
@@ -22,12 +23,26 @@
 #include <bspatch.h>
 #include <deflate.h>
 
+// Size of the read-ahead window used for base firmware reads if the partition cannot be mapped
+#define BASE_FIRMWARE_WINDOW_SIZE (16 * 1024)
+
 typedef struct {
     jade_ota_ctx_t* joctx;
     char* id;
     struct deflate_ctx* const dctx;
     size_t written;
     bool header_validated;
+
+    // The running/base firmware is read via a memory-mapping of the partition, or if that is not
+    // possible via a read-ahead window - bspatch reads are small and largely sequential.
+    const uint8_t* base_mapped;
+    esp_partition_mmap_handle_t base_mmap_handle;
+    uint8_t* base_window;
+    size_t base_window_pos;
+    size_t base_window_len;
+
+    // The patched firmware is written to flash by a task on the secondary core
+    ota_writer_t writer;
 } bsdiff_ctx_t;
 
 // Error reply in ota_delta is complicated by the fact that we reply 'ok' when we push the received patch data
@@ -86,14 +101,80 @@ static int base_firmware_stream_reader(const struct bspatch_stream_i* stream, vo
     // If currently in error, return immediately without reading anything
     HANDLE_ANY_CACHED_ERROR(bctx->joctx);
 
-    if (length <= 0 || pos + length >= bctx->joctx->running_partition->size
-        || esp_partition_read(bctx->joctx->running_partition, pos, buffer, length) != ESP_OK) {
+    const esp_partition_t* const partition = bctx->joctx->running_partition;
+    if (length <= 0 || pos < 0 || pos + length >= partition->size) {
         HANDLE_NEW_ERROR(bctx->joctx, ERROR_PATCH);
     }
 
+    // Mapped partition - just copy
+    if (bctx->base_mapped) {
+        memcpy(buffer, bctx->base_mapped + pos, length);
+        return SUCCESS;
+    }
+
+    // Serve from the read-ahead window, refilling it as required
+    uint8_t* dest = buffer;
+    size_t read_pos = pos;
+    size_t remaining = length;
+    while (remaining) {
+        if (read_pos < bctx->base_window_pos || read_pos >= bctx->base_window_pos + bctx->base_window_len) {
+            const size_t to_end = partition->size - read_pos;
+            const size_t window_len = to_end < BASE_FIRMWARE_WINDOW_SIZE ? to_end : BASE_FIRMWARE_WINDOW_SIZE;
+            if (esp_partition_read(partition, read_pos, bctx->base_window, window_len) != ESP_OK) {
+                bctx->base_window_len = 0;
+                HANDLE_NEW_ERROR(bctx->joctx, ERROR_PATCH);
+            }
+            bctx->base_window_pos = read_pos;
+            bctx->base_window_len = window_len;
+        }
+
+        const size_t offset = read_pos - bctx->base_window_pos;
+        const size_t in_window = bctx->base_window_len - offset;
+        const size_t available = in_window < remaining ? in_window : remaining;
+        memcpy(dest, bctx->base_window + offset, available);
+        dest += available;
+        read_pos += available;
+        remaining -= available;
+    }
+
     return SUCCESS;
 }
 
+// Map the running partition, or allocate the read-ahead window if it cannot be mapped
+static void init_base_firmware_reader(bsdiff_ctx_t* bctx)
+{
+    JADE_ASSERT(bctx);
+    JADE_ASSERT(bctx->joctx);
+    JADE_ASSERT(bctx->joctx->running_partition);
+
+    const esp_partition_t* const partition = bctx->joctx->running_partition;
+    const void* mapped = NULL;
+    const esp_err_t err
+        = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &mapped, &bctx->base_mmap_handle);
+    if (err == ESP_OK) {
+        bctx->base_mapped = mapped;
+        return;
+    }
+
+    JADE_LOGW("Failed to map running partition (%d) - using read-ahead window", err);
+    bctx->base_mapped = NULL;
+    bctx->base_window = JADE_MALLOC_PREFER_SPIRAM(BASE_FIRMWARE_WINDOW_SIZE);
+    bctx->base_window_pos = 0;
+    bctx->base_window_len = 0;
+}
+
+static void free_base_firmware_reader(bsdiff_ctx_t* bctx)
+{
+    JADE_ASSERT(bctx);
+
+    if (bctx->base_mapped) {
+        esp_partition_munmap(bctx->base_mmap_handle);
+        bctx->base_mapped = NULL;
+    }
+    free(bctx->base_window);
+    bctx->base_window = NULL;
+}
+
 // NOTE: uses macros above so may return error immediately, or may just cache it for later return
 static int ota_stream_writer(const struct bspatch_stream_n* stream, const void* buffer, int length)
 {
@@ -103,7 +184,8 @@ static int ota_stream_writer(const struct bspatch_stream_n* stream, const void*
     // If currently in error, return immediately without writing anything
     HANDLE_ANY_CACHED_ERROR(bctx->joctx);
 
-    if (length <= 0 || esp_ota_write(*bctx->joctx->ota_handle, buffer, length) != ESP_OK) {
+    // NOTE: any flash write error is reported by a subsequent write, or when the writer is finished
+    if (length <= 0 || !ota_writer_write(&bctx->writer, buffer, length)) {
         HANDLE_NEW_ERROR(bctx->joctx, ERROR_PATCH);
     }
 
@@ -115,11 +197,6 @@ static int ota_stream_writer(const struct bspatch_stream_n* stream, const void*
         bctx->header_validated = true;
     }
 
-    if (bctx->joctx->hash_type == HASHTYPE_FULLFWDATA) {
-        // Add written to hash calculation
-        mbedtls_sha256_update(bctx->joctx->sha_ctx, buffer, length);
-    }
-
     bctx->written += length;
 
     if (bctx->written > CUSTOM_HEADER_MIN_WRITE && !bctx->header_validated) {
@@ -196,6 +273,13 @@ void ota_delta_process(void* process_ptr)
     JADE_WALLY_VERIFY(wally_hex_from_bytes(expected_hash, sizeof(expected_hash), &expected_hash_hexstr));
     jade_process_wally_free_string_on_exit(process, expected_hash_hexstr);
 
+    // Optionally the host may keep several chunks in flight
+    size_t window = 0;
+    if (!ota_get_window_param(&params, &window)) {
+        jade_process_reject_message(process, CBOR_RPC_BAD_PARAMETERS, "Invalid upload window size", NULL);
+        goto cleanup;
+    }
+
     // We will show a progress bar once the user has confirmed and the upload in progress
     // Initially just show a message screen.
     display_message_activity_two_lines("Preparing for firmware", "update");
@@ -226,6 +310,8 @@ void ota_delta_process(void* process_ptr)
         .compressedsize = compressedsize,
         .expected_hash_hexstr = expected_hash_hexstr,
         .expected_hash = expected_hash,
+        .window = window,
+        .next_seq = 0,
     };
 
     bctx.joctx = &joctx;
@@ -241,6 +327,11 @@ void ota_delta_process(void* process_ptr)
 
     ota_begin_called = true;
 
+    // Prepare to read the running firmware, onto which the patch is applied
+    // and to write the patched firmware to flash in the background
+    init_base_firmware_reader(&bctx);
+    ota_writer_start(&bctx.writer, &joctx);
+
     // Send the ok response, which implies now we will get ota_data messages
     jade_process_reply_to_message_ok(process);
     uploading = true;
@@ -272,16 +363,20 @@ void ota_delta_process(void* process_ptr)
     // Uploading complete
     uploading = false;
 
-    if (bctx.written != firmwaresize) {
+    // Wait for all firmware to be written to flash
+    if (!ota_writer_finish(&bctx.writer) || bctx.written != firmwaresize) {
         ota_return_status = ERROR_PATCH;
     }
 
     // Expect a complete/request for status
-    jade_process_load_in_message(process, true);
+    ota_load_final_message(process, &joctx);
     if (!IS_CURRENT_MESSAGE(process, "ota_complete")) {
-        // Protocol error
+        // Protocol error - abandon the upload
         jade_process_reject_message(
             process, CBOR_RPC_PROTOCOL_ERROR, "Unexpected message, expecting 'ota_complete'", NULL);
+        if (ota_return_status == SUCCESS) {
+            ota_return_status = ERROR_BADDATA;
+        }
         goto cleanup;
     }
 
@@ -303,6 +398,12 @@ void ota_delta_process(void* process_ptr)
     JADE_LOGI("Success");
 
 cleanup:
+    if (ota_begin_called) {
+        // Ensure the writer task has stopped before the ota is finalised/abandoned
+        // (and before the hash context it may be updating is freed)
+        ota_writer_finish(&bctx.writer);
+        free_base_firmware_reader(&bctx);
+    }
     mbedtls_sha256_free(&sha_ctx);
 
     // If ota has been successful show message and reboot.
@@ -1,8 +1,11 @@
 #include "ota_util.h"
 #include "../button_events.h"
 #include "../jade_assert.h"
+#include "../jade_tasks.h"
 #include "../jade_wally_verify.h"
+#include "../utils/malloc_ext.h"
 #include "ota_defines.h"
+#include "process_utils.h"
 
 #include <ctype.h>
 #include <deflate.h>
@@ -18,6 +21,9 @@ void make_show_ota_hash_activity(gui_activity_t** activity_ptr, const char* expe
 const __attribute__((section(".rodata_custom_desc"))) esp_custom_app_desc_t custom_app_desc
     = { .version = 1, .board_type = JADE_OTA_BOARD_TYPE, .features = JADE_OTA_FEATURES, .config = JADE_OTA_CONFIG };
 
+// In a windowed upload, acks are cumulative - so only every few chunks (and the final chunk) need be acked
+#define OTA_ACK_INTERVAL(window) (((window) + 1) / 2)
+
 static void send_ok(const char* id, const jade_msg_source_t source)
 {
     JADE_ASSERT(id);
@@ -27,6 +33,73 @@ static void send_ok(const char* id, const jade_msg_source_t source)
     jade_process_reply_to_message_result_with_id(id, ok_msg, sizeof(ok_msg), source, &ok, cbor_result_boolean_cb);
 }
 
+// Reply with an unsigned integer result - eg. the last sequence number processed (acknowledging all
+// chunks up to and including that one), or the offset from which a resumed upload should continue.
+static void send_uint(const char* id, const jade_msg_source_t source, const size_t value)
+{
+    JADE_ASSERT(id);
+
+    uint8_t reply_msg[MAXLEN_ID + 20];
+    const uint64_t result = value;
+    jade_process_reply_to_message_result_with_id(
+        id, reply_msg, sizeof(reply_msg), source, &result, cbor_result_uint64_cb);
+}
+
+// Optional 'window' parameter - the number of chunks the host intends to keep in flight
+// Absent implies the legacy protocol, where each chunk is sent and individually acked in turn.
+bool ota_get_window_param(const CborValue* params, size_t* window)
+{
+    JADE_ASSERT(params);
+    JADE_INIT_OUT_SIZE(window);
+
+    if (!rpc_has_field_data("window", params)) {
+        return true;
+    }
+    return rpc_get_sizet("window", params, window) && *window > 0 && *window <= JADE_OTA_MAX_WINDOW;
+}
+
+// An 'ota_resume' message must describe the same upload as the initial 'ota'/'ota_delta' message
+// ie. the same compressed size, expected hash and upload window.
+static bool resume_params_match(const jade_ota_ctx_t* joctx, const CborValue* value)
+{
+    JADE_ASSERT(joctx);
+    JADE_ASSERT(value);
+
+    CborValue params;
+    if (!rpc_get_map("params", value, &params)) {
+        return false;
+    }
+
+    size_t compressedsize = 0;
+    if (!rpc_get_sizet("cmpsize", &params, &compressedsize) || compressedsize != joctx->compressedsize) {
+        return false;
+    }
+
+    uint8_t hash[SHA256_LEN];
+    const char* hash_field = joctx->hash_type == HASHTYPE_FULLFWDATA ? "fwhash" : "cmphash";
+    if (!rpc_get_n_bytes(hash_field, &params, sizeof(hash), hash)
+        || sodium_memcmp(hash, joctx->expected_hash, sizeof(hash))) {
+        return false;
+    }
+
+    size_t window = 0;
+    return ota_get_window_param(&params, &window) && window == joctx->window;
+}
+
+// An 'ota_resume' from a source other than that of the upload in progress is rejected back to that
+// source - the upload itself is unaffected, and can still be resumed by the host which started it.
+#define OTHER_SOURCE_RESUME_ERROR "Upload in progress from another source"
+
+static void reject_other_source_resume(const char* id, const jade_msg_source_t source)
+{
+    JADE_ASSERT(id);
+
+    JADE_LOGW("Rejecting ota_resume from another source");
+    uint8_t buf[256];
+    jade_process_reject_message_with_id(
+        id, CBOR_RPC_PROTOCOL_ERROR, OTHER_SOURCE_RESUME_ERROR, NULL, 0, buf, sizeof(buf), source);
+}
+
 void handle_in_bin_data(void* ctx, uint8_t* data, const size_t rawsize)
 {
     JADE_ASSERT(ctx);
@@ -52,6 +125,31 @@ void handle_in_bin_data(void* ctx, uint8_t* data, const size_t rawsize)
         return;
     }
 
+    if (rpc_is_method(&value, "ota_resume")) {
+        // A host reconnecting mid-upload (eg. after the connection dropped) - reply with the amount of
+        // compressed data processed thus far, from where the host should continue the upload.
+        // NOTE: all state (decompressor, hash, etc.) is as at the end of the last chunk processed.
+        if (data[0] != *joctx->expected_source) {
+            reject_other_source_resume(joctx->id, data[0]);
+            joctx->id[0] = '\0';
+            return;
+        }
+
+        if (!resume_params_match(joctx, &value)) {
+            JADE_LOGE("Bad or mismatched ota_resume request");
+            *joctx->ota_return_status = ERROR_BADDATA;
+            return;
+        }
+
+        // Any windowed sequence numbering restarts from zero
+        const size_t offset = joctx->compressedsize - joctx->remaining_compressed;
+        JADE_LOGI("Resuming ota upload at offset %u of %u", offset, joctx->compressedsize);
+        joctx->next_seq = 0;
+        send_uint(joctx->id, *joctx->expected_source, offset);
+        joctx->id[0] = '\0';
+        return;
+    }
+
     if (!rpc_is_method(&value, "ota_data")) {
         *joctx->ota_return_status = ERROR_BADDATA;
         return;
@@ -60,7 +158,20 @@ void handle_in_bin_data(void* ctx, uint8_t* data, const size_t rawsize)
     written = 0;
     const uint8_t* inbound_buf = NULL;
 
-    rpc_get_bytes_ptr("params", &value, &inbound_buf, &written);
+    if (joctx->window) {
+        // Windowed upload - chunks must arrive in sequence
+        CborValue params;
+        size_t seq = 0;
+        if (!rpc_get_map("params", &value, &params) || !rpc_get_sizet("seq", &params, &seq)
+            || seq != joctx->next_seq) {
+            JADE_LOGE("Bad or out-of-sequence ota_data chunk, expecting %u", joctx->next_seq);
+            *joctx->ota_return_status = ERROR_BADDATA;
+            return;
+        }
+        rpc_get_bytes_ptr("data", &params, &inbound_buf, &written);
+    } else {
+        rpc_get_bytes_ptr("params", &value, &inbound_buf, &written);
+    }
 
     if (written == 0 || data[0] != *joctx->expected_source || written > JADE_OTA_BUF_SIZE || !inbound_buf) {
         *joctx->ota_return_status = ERROR_BADDATA;
@@ -99,13 +210,54 @@ void handle_in_bin_data(void* ctx, uint8_t* data, const size_t rawsize)
         joctx->uncompressedsize - *joctx->remaining_uncompressed);
 
     // Send ack after all processing - see comment above.
-    JADE_LOGI("Sending ok for %s", joctx->id);
-    send_ok(joctx->id, *joctx->expected_source);
+    // In a windowed upload the host has further chunks in flight, so the link is not left idle.
+    const size_t seq = joctx->next_seq++;
+    if (!joctx->window) {
+        JADE_LOGI("Sending ok for %s", joctx->id);
+        send_ok(joctx->id, *joctx->expected_source);
+    } else if (!joctx->remaining_compressed || (seq + 1) % OTA_ACK_INTERVAL(joctx->window) == 0) {
+        JADE_LOGI("Sending ack for %s, seq %u", joctx->id, seq);
+        send_uint(joctx->id, *joctx->expected_source, seq);
+    }
 
     // Blank out the current msg id once 'ok' is sent for it
     joctx->id[0] = '\0';
 }
 
+// Load the message expected once all the data has been uploaded (ie. 'ota_complete').
+// Waits across any loss of connection, and answers any 'ota_resume' from a host which reconnected
+// before receiving the final ack - there is no more data to send, so the host can proceed to complete.
+void ota_load_final_message(jade_process_t* process, const jade_ota_ctx_t* joctx)
+{
+    JADE_ASSERT(process);
+    JADE_ASSERT(joctx);
+
+    while (true) {
+        jade_process_load_in_message(process, true);
+        if (!HAS_CURRENT_MESSAGE(process)) {
+            continue;
+        }
+
+        if (!IS_CURRENT_MESSAGE(process, "ota_resume")) {
+            return;
+        }
+
+        if (process->ctx.source != *joctx->expected_source) {
+            JADE_LOGW("Rejecting ota_resume from another source");
+            jade_process_reject_message(process, CBOR_RPC_PROTOCOL_ERROR, OTHER_SOURCE_RESUME_ERROR, NULL);
+            continue;
+        }
+
+        if (!resume_params_match(joctx, &process->ctx.value)) {
+            return;
+        }
+
+        JADE_LOGI("Resuming completed ota upload");
+        const uint64_t offset = joctx->compressedsize - joctx->remaining_compressed;
+        jade_process_reply_to_message_result(process->ctx, &offset, cbor_result_uint64_cb);
+    }
+}
+
 bool ota_init(jade_ota_ctx_t* joctx)
 {
     JADE_ASSERT(joctx);
@@ -317,3 +469,160 @@ enum ota_status ota_user_validation(jade_ota_ctx_t* joctx, const uint8_t* uncomp
 
     return SUCCESS;
 }
+
+// Slot value indicating no buffer is being filled, or (when queued) that the writer task should stop
+#define OTA_WRITER_NO_SLOT 0xFF
+
+// Writes the filled buffers to flash in the order they are queued, returning each to the free queue
+// Once any write fails, subsequent buffers are discarded - the failure is reported to the ota task.
+static void ota_writer_task(void* ctx)
+{
+    JADE_ASSERT(ctx);
+    ota_writer_t* const writer = (ota_writer_t*)ctx;
+    jade_ota_ctx_t* const joctx = writer->joctx;
+
+    while (true) {
+        uint8_t slot;
+        const BaseType_t ret = xQueueReceive(writer->full_slots, &slot, portMAX_DELAY);
+        JADE_ASSERT(ret == pdTRUE);
+        if (slot == OTA_WRITER_NO_SLOT) {
+            break;
+        }
+        JADE_ASSERT(slot < OTA_WRITER_NUM_BUFFERS);
+
+        if (!writer->failed) {
+            const esp_err_t err = esp_ota_write(*joctx->ota_handle, writer->buffers[slot], writer->lengths[slot]);
+            if (err != ESP_OK) {
+                JADE_LOGE("esp_ota_write() error: %u", err);
+                writer->failed = true;
+            } else if (joctx->hash_type == HASHTYPE_FULLFWDATA) {
+                // Add written to hash calculation
+                mbedtls_sha256_update(joctx->sha_ctx, writer->buffers[slot], writer->lengths[slot]);
+            }
+        }
+
+        // Can never block as the queue can hold all the slots
+        const BaseType_t sent = xQueueSend(writer->free_slots, &slot, 0);
+        JADE_ASSERT(sent == pdTRUE);
+    }
+
+    // Signal we are done, and await our death
+    xSemaphoreGive(writer->stopped);
+    for (;;) {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+
+void ota_writer_start(ota_writer_t* writer, jade_ota_ctx_t* joctx)
+{
+    JADE_ASSERT(writer);
+    JADE_ASSERT(!writer->task);
+    JADE_ASSERT(joctx);
+    JADE_ASSERT(joctx->ota_handle);
+
+    writer->joctx = joctx;
+    writer->fill_slot = OTA_WRITER_NO_SLOT;
+    writer->fill_len = 0;
+    writer->failed = false;
+
+    // Queues can hold all slots, plus the 'stop' marker
+    writer->free_slots = xQueueCreate(OTA_WRITER_NUM_BUFFERS, sizeof(uint8_t));
+    JADE_ASSERT(writer->free_slots);
+    writer->full_slots = xQueueCreate(OTA_WRITER_NUM_BUFFERS + 1, sizeof(uint8_t));
+    JADE_ASSERT(writer->full_slots);
+    writer->stopped = xSemaphoreCreateBinary();
+    JADE_ASSERT(writer->stopped);
+
+    for (uint8_t slot = 0; slot < OTA_WRITER_NUM_BUFFERS; ++slot) {
+        writer->buffers[slot] = JADE_MALLOC(OTA_WRITER_BUFFER_SIZE);
+        const BaseType_t ret = xQueueSend(writer->free_slots, &slot, 0);
+        JADE_ASSERT(ret == pdTRUE);
+    }
+
+    const BaseType_t retval = xTaskCreatePinnedToCore(&ota_writer_task, "ota_writer", 4 * 1024, writer,
+        JADE_TASK_PRIO_WRITER, &writer->task, JADE_CORE_SECONDARY);
+    JADE_ASSERT_MSG(
+        retval == pdPASS, "Failed to create ota_writer task, xTaskCreatePinnedToCore() returned %d", retval);
+}
+
+// Pass a filled buffer to the writer task
+static void ota_writer_submit(ota_writer_t* writer)
+{
+    JADE_ASSERT(writer->fill_slot < OTA_WRITER_NUM_BUFFERS);
+    JADE_ASSERT(writer->fill_len);
+
+    writer->lengths[writer->fill_slot] = writer->fill_len;
+    const BaseType_t ret = xQueueSend(writer->full_slots, &writer->fill_slot, 0);
+    JADE_ASSERT(ret == pdTRUE);
+
+    writer->fill_slot = OTA_WRITER_NO_SLOT;
+    writer->fill_len = 0;
+}
+
+// Copy data into the writer's buffers, passing each to the writer task as it is filled
+// Blocks if both buffers are awaiting writing.  Returns false if any prior flash write has failed.
+bool ota_writer_write(ota_writer_t* writer, const uint8_t* data, size_t len)
+{
+    JADE_ASSERT(writer);
+    JADE_ASSERT(writer->task);
+    JADE_ASSERT(data);
+
+    while (len && !writer->failed) {
+        if (writer->fill_slot == OTA_WRITER_NO_SLOT) {
+            const BaseType_t ret = xQueueReceive(writer->free_slots, &writer->fill_slot, portMAX_DELAY);
+            JADE_ASSERT(ret == pdTRUE);
+            writer->fill_len = 0;
+        }
+
+        const size_t space = OTA_WRITER_BUFFER_SIZE - writer->fill_len;
+        const size_t to_copy = len < space ? len : space;
+        memcpy(writer->buffers[writer->fill_slot] + writer->fill_len, data, to_copy);
+        writer->fill_len += to_copy;
+        data += to_copy;
+        len -= to_copy;
+
+        if (writer->fill_len == OTA_WRITER_BUFFER_SIZE) {
+            ota_writer_submit(writer);
+        }
+    }
+    return !writer->failed;
+}
+
+// Flush any partially filled buffer and wait for all writes to complete, then stop the writer task
+// Returns false if any flash write failed.  Safe to call if not started, or if already finished.
+bool ota_writer_finish(ota_writer_t* writer)
+{
+    JADE_ASSERT(writer);
+
+    if (!writer->task) {
+        return !writer->failed;
+    }
+
+    if (writer->fill_slot != OTA_WRITER_NO_SLOT) {
+        if (writer->fill_len && !writer->failed) {
+            ota_writer_submit(writer);
+        } else {
+            const BaseType_t ret = xQueueSend(writer->free_slots, &writer->fill_slot, 0);
+            JADE_ASSERT(ret == pdTRUE);
+            writer->fill_slot = OTA_WRITER_NO_SLOT;
+        }
+    }
+
+    // The stop marker is processed after any queued buffers
+    const uint8_t stop = OTA_WRITER_NO_SLOT;
+    const BaseType_t ret = xQueueSend(writer->full_slots, &stop, portMAX_DELAY);
+    JADE_ASSERT(ret == pdTRUE);
+    xSemaphoreTake(writer->stopped, portMAX_DELAY);
+    vTaskDelete(writer->task);
+    writer->task = NULL;
+
+    vSemaphoreDelete(writer->stopped);
+    vQueueDelete(writer->full_slots);
+    vQueueDelete(writer->free_slots);
+    for (size_t i = 0; i < OTA_WRITER_NUM_BUFFERS; ++i) {
+        free(writer->buffers[i]);
+        writer->buffers[i] = NULL;
+    }
+
+    return !writer->failed;
+}
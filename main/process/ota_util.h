@@ -7,6 +7,9 @@
 #include <esp_app_format.h>
 #include <esp_ota_ops.h>
 #include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
 #include <mbedtls/sha256.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -52,8 +55,28 @@ typedef struct {
     size_t uncompressedsize;
     size_t compressedsize;
     size_t firmwaresize;
+    size_t window;
+    size_t next_seq;
 } jade_ota_ctx_t;
 
+// Double-buffered firmware writer - the final firmware image is written to flash (and hashed, if
+// required) by a task on the secondary core, while the ota task inflates/patches the next block.
+#define OTA_WRITER_NUM_BUFFERS 2
+#define OTA_WRITER_BUFFER_SIZE (4 * 1024)
+
+typedef struct {
+    jade_ota_ctx_t* joctx;
+    uint8_t* buffers[OTA_WRITER_NUM_BUFFERS];
+    size_t lengths[OTA_WRITER_NUM_BUFFERS];
+    uint8_t fill_slot;
+    size_t fill_len;
+    QueueHandle_t free_slots;
+    QueueHandle_t full_slots;
+    SemaphoreHandle_t stopped;
+    TaskHandle_t task;
+    volatile bool failed;
+} ota_writer_t;
+
 enum ota_status {
     SUCCESS = 0,
     ERROR_OTA_SETUP,
@@ -91,8 +114,16 @@ static const char MESSAGES[][20] = {
 
 void handle_in_bin_data(void* ctx, uint8_t* data, size_t rawsize);
 
+bool ota_get_window_param(const CborValue* params, size_t* window);
+
+void ota_load_final_message(jade_process_t* process, const jade_ota_ctx_t* joctx);
+
 bool ota_init(jade_ota_ctx_t* joctx);
 enum ota_status post_ota_check(jade_ota_ctx_t* joctx, bool* ota_end_called);
 enum ota_status ota_user_validation(jade_ota_ctx_t* joctx, const uint8_t* uncompressed);
 
+void ota_writer_start(ota_writer_t* writer, jade_ota_ctx_t* joctx);
+bool ota_writer_write(ota_writer_t* writer, const uint8_t* data, size_t len);
+bool ota_writer_finish(ota_writer_t* writer);
+
 #endif /* JADE_OTA_UTIL_H_ */
@@ -1,5 +1,6 @@
 #include "../aes.h"
 #include "../jade_assert.h"
+#include "../jade_tasks.h"
 #include "../jade_wally_verify.h"
 #include "../keychain.h"
 #include "../process.h"
@@ -10,6 +11,9 @@
 #include "../utils/cbor_rpc.h"
 
 #include <cbor.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include <sodium/crypto_verify_32.h>
 
 #include "process_utils.h"
@@ -45,6 +49,20 @@ typedef struct {
     const char* message;
 } pinserver_result_t;
 
+// The PIN-independent client material for a handshake - can be computed before the PIN is known
+typedef struct {
+    // The ephemeral client ecdh key
+    uint8_t e_ecdh_privatekey[EC_PRIVATE_KEY_LEN];
+    uint8_t cke[EC_PUBLIC_KEY_LEN];
+
+    // The hw pin private key, and the hmac key derived from it for hashing the pin
+    uint8_t pin_privatekey[EC_PRIVATE_KEY_LEN];
+    uint8_t pin_hmac_key[HMAC_SHA256_LEN];
+
+    // Entropy to include in the payload
+    uint8_t entropy[ENTROPY_LEN];
+} handshake_material_t;
+
 typedef struct {
     // The ephemeral server and client ecdh public keys
     uint8_t ske[EC_PUBLIC_KEY_LEN];
@@ -70,6 +88,12 @@ typedef struct {
     const handshake_data_t* data;
 } handshake_reply_t;
 
+// Handshake material precomputed by a background task while the user enters their PIN
+// NOTE: not on any sensitive stack, so explicitly wiped when consumed or discarded
+static handshake_material_t precomputed_material;
+static SemaphoreHandle_t precompute_done = NULL;
+static bool precompute_ok = false;
+
 // Helper to encode bytes as hex and add as a string to the message
 static void add_hex_bytes_to_map(CborEncoder* container, const char* name, const uint8_t* bytes, const size_t size)
 {
@@ -253,36 +277,95 @@ static bool derive_secret(const uint8_t* shared_secret, const size_t index, uint
     return wally_hmac_sha256(shared_secret, SHA256_LEN, &flags[0], 1, result_key, HMAC_SHA256_LEN) == WALLY_OK;
 }
 
-// Hepler function to populate the pinkeys structure given the server key
-static bool generate_ecdh_pinkeys(const uint8_t* ske, const size_t ske_len, pin_keys_t* pinkeys)
+// Helper to generate the PIN-independent handshake material - a new ephemeral client key,
+// the pin hmac key (derived from the hw pin private key), and payload entropy.
+static bool generate_handshake_material(handshake_material_t* material)
+{
+    JADE_ASSERT(material);
+
+    const uint8_t subkey = 0;
+    get_random(material->entropy, sizeof(material->entropy));
+
+    return keychain_get_new_privatekey(material->e_ecdh_privatekey, sizeof(material->e_ecdh_privatekey))
+        && wally_ec_public_key_from_private_key(material->e_ecdh_privatekey, sizeof(material->e_ecdh_privatekey),
+               material->cke, sizeof(material->cke))
+        == WALLY_OK
+        && storage_get_pin_privatekey(material->pin_privatekey, sizeof(material->pin_privatekey))
+        && wally_hmac_sha256(material->pin_privatekey, sizeof(material->pin_privatekey), &subkey, 1,
+               material->pin_hmac_key, sizeof(material->pin_hmac_key))
+        == WALLY_OK;
+}
+
+static void precompute_handshake_task(void* unused)
+{
+    precompute_ok = generate_handshake_material(&precomputed_material);
+    xSemaphoreGive(precompute_done);
+
+    vTaskDelete(NULL);
+}
+
+// Start generating handshake material in the background (eg. while the user enters their PIN)
+// It is used by the next pinserver interaction, or must be discarded with pinclient_discard_precomputed().
+void pinclient_precompute_start(void)
+{
+    JADE_ASSERT(!precompute_done);
+
+    precompute_ok = false;
+    precompute_done = xSemaphoreCreateBinary();
+    JADE_ASSERT(precompute_done);
+
+    const BaseType_t retval = xTaskCreatePinnedToCore(&precompute_handshake_task, "pin_precompute", 4 * 1024, NULL,
+        JADE_TASK_PRIO_PRECOMPUTE, NULL, JADE_CORE_SECONDARY);
+    JADE_ASSERT_MSG(
+        retval == pdPASS, "Failed to create pin_precompute task, xTaskCreatePinnedToCore() returned %d", retval);
+}
+
+// Take any precomputed handshake material (awaiting its completion if necessary)
+// The precomputed copy is wiped - returns false if none was available.
+static bool take_precomputed_material(handshake_material_t* material)
+{
+    if (!precompute_done) {
+        return false;
+    }
+
+    xSemaphoreTake(precompute_done, portMAX_DELAY);
+    vSemaphoreDelete(precompute_done);
+    precompute_done = NULL;
+
+    const bool ret = precompute_ok;
+    if (ret && material) {
+        memcpy(material, &precomputed_material, sizeof(precomputed_material));
+    }
+    JADE_WALLY_VERIFY(wally_bzero(&precomputed_material, sizeof(precomputed_material)));
+    precompute_ok = false;
+    return ret;
+}
+
+// Discard any unused precomputed handshake material
+void pinclient_discard_precomputed(void) { take_precomputed_material(NULL); }
+
+// Hepler function to populate the pinkeys structure given the server key and our ephemeral key
+static bool generate_ecdh_pinkeys(
+    const uint8_t* ske, const size_t ske_len, const handshake_material_t* material, pin_keys_t* pinkeys)
 {
     JADE_ASSERT(ske);
     JADE_ASSERT(ske_len == sizeof(pinkeys->ske));
+    JADE_ASSERT(material);
     JADE_ASSERT(pinkeys);
 
     bool ret = false;
 
-    uint8_t e_ecdh_privatekey[EC_PRIVATE_KEY_LEN];
-    SENSITIVE_PUSH(e_ecdh_privatekey, sizeof(e_ecdh_privatekey));
-
     uint8_t shared_secret[SHA256_LEN];
     SENSITIVE_PUSH(shared_secret, sizeof(shared_secret));
 
-    // Copy the ske into pinkeys->ske
+    // Copy the ske and cke into pinkeys
     memcpy(pinkeys->ske, ske, ske_len);
-
-    // Get a new ephemeral client key into pinkeys->cke
-    if (!keychain_get_new_privatekey(e_ecdh_privatekey, sizeof(e_ecdh_privatekey))) {
-        goto cleanup;
-    }
-    if (wally_ec_public_key_from_private_key(
-            e_ecdh_privatekey, sizeof(e_ecdh_privatekey), pinkeys->cke, sizeof(pinkeys->cke))
-        != WALLY_OK) {
-        goto cleanup;
-    }
+    memcpy(pinkeys->cke, material->cke, sizeof(pinkeys->cke));
 
     // Make the new ecdh 'shared secret' from ske + cke
-    if (wally_ecdh(ske, ske_len, e_ecdh_privatekey, sizeof(e_ecdh_privatekey), shared_secret, SHA256_LEN) != WALLY_OK) {
+    if (wally_ecdh(ske, ske_len, material->e_ecdh_privatekey, sizeof(material->e_ecdh_privatekey), shared_secret,
+            SHA256_LEN)
+        != WALLY_OK) {
         goto cleanup;
     }
 
@@ -294,7 +377,6 @@ static bool generate_ecdh_pinkeys(const uint8_t* ske, const size_t ske_len, pin_
 
 cleanup:
     SENSITIVE_POP(shared_secret);
-    SENSITIVE_POP(e_ecdh_privatekey);
     return ret;
 }
 
@@ -355,9 +437,11 @@ static bool decrypt_reply(const uint8_t* aeskey, const uint8_t* encrypted, const
 // Sets-up the ECDH and the ephemeral encryption keys - populates pinkeys structure
 // Returns a small struct containing the success/fail, whether it is a 'hard' or
 // 'retryable' error, and any error code/message that should be sent.
-static pinserver_result_t start_handshake(jade_process_t* process, pin_keys_t* pinkeys)
+static pinserver_result_t start_handshake(
+    jade_process_t* process, const handshake_material_t* material, pin_keys_t* pinkeys)
 {
     JADE_ASSERT(process);
+    JADE_ASSERT(material);
     JADE_ASSERT(pinkeys);
     ASSERT_HAS_CURRENT_MESSAGE(process);
 
@@ -423,7 +507,7 @@ static pinserver_result_t start_handshake(jade_process_t* process, pin_keys_t* p
 
     // Derive all the various encryption keys
     JADE_LOGD("Deriving shared secrets/keys");
-    if (!generate_ecdh_pinkeys(ske, sizeof(ske), pinkeys)) {
+    if (!generate_ecdh_pinkeys(ske, sizeof(ske), material, pinkeys)) {
         RETURN_RESULT(
             FAILURE, CBOR_RPC_INTERNAL_ERROR, "Cannot initiate handshake - failed to generate shared secrets");
     }
@@ -507,23 +591,15 @@ static pinserver_result_t complete_handshake(
 }
 
 // Helper to hmac an n-digit pin into a 256bit secret
-static bool get_pin_secret(const uint8_t* pin, const size_t pin_len, const uint8_t* pin_privatekey, uint8_t* pin_secret)
+// (The hmac key is derived from the hw pin private key - see generate_handshake_material())
+static bool get_pin_secret(const uint8_t* pin, const size_t pin_len, const uint8_t* pin_hmac_key, uint8_t* pin_secret)
 {
     JADE_ASSERT(pin);
     JADE_ASSERT(pin_len > 0);
-    JADE_ASSERT(pin_privatekey);
+    JADE_ASSERT(pin_hmac_key);
     JADE_ASSERT(pin_secret);
 
-    const uint8_t subkey = 0;
-    uint8_t hmac_key[HMAC_SHA256_LEN];
-    SENSITIVE_PUSH(hmac_key, sizeof(hmac_key));
-
-    const bool ret
-        = wally_hmac_sha256(pin_privatekey, EC_PRIVATE_KEY_LEN, &subkey, 1, hmac_key, HMAC_SHA256_LEN) == WALLY_OK
-        && wally_hmac_sha256(hmac_key, sizeof(hmac_key), pin, pin_len, pin_secret, HMAC_SHA256_LEN) == WALLY_OK;
-
-    SENSITIVE_POP(hmac_key);
-    return ret;
+    return wally_hmac_sha256(pin_hmac_key, HMAC_SHA256_LEN, pin, pin_len, pin_secret, HMAC_SHA256_LEN) == WALLY_OK;
 }
 
 // Sign the payload with the private key
@@ -584,34 +660,38 @@ static pinserver_result_t pinserver_interaction(jade_process_t* process, const u
     JADE_ASSERT(finalaes_len == AES_KEY_LEN_256);
     ASSERT_HAS_CURRENT_MESSAGE(process);
 
+    handshake_material_t material;
     pin_keys_t pinkeys;
-    uint8_t pin_privatekey[EC_PRIVATE_KEY_LEN];
     uint8_t pinsecret[PIN_SECRET_LEN];
-    uint8_t entropy[ENTROPY_LEN];
     uint8_t sig[EC_SIGNATURE_RECOVERABLE_LEN];
     uint8_t payload[CLIENT_REQUEST_PAYLOAD_LEN];
     uint8_t hmac_payload[HMAC_SHA256_LEN];
 
+    SENSITIVE_PUSH(&material, sizeof(material));
     SENSITIVE_PUSH(&pinkeys, sizeof(pinkeys));
-    SENSITIVE_PUSH(pin_privatekey, sizeof(pin_privatekey));
     SENSITIVE_PUSH(pinsecret, sizeof(pinsecret));
-    SENSITIVE_PUSH(entropy, sizeof(entropy));
     SENSITIVE_PUSH(sig, sizeof(sig));
 
+    pinserver_result_t retval = { .result = FAILURE, .errorcode = 0, .message = NULL };
+
+    // Use any material precomputed while the pin was being entered, otherwise generate it now
+    if (!take_precomputed_material(&material) && !generate_handshake_material(&material)) {
+        retval.errorcode = CBOR_RPC_INTERNAL_ERROR;
+        retval.message = "Failed to create PinServer message content";
+        goto cleanup;
+    }
+
     // Start the pinserver handshake and derive the shared encryption keys
-    pinserver_result_t retval = start_handshake(process, &pinkeys);
+    retval = start_handshake(process, &material, &pinkeys);
     if (retval.result != SUCCESS) {
         goto cleanup;
     }
 
-    // Generate, sign, encrypt and hmac the pin data to send
+    // Sign, encrypt and hmac the pin data to send
     JADE_LOGI("Generating pinserver payload");
-    get_random(entropy, sizeof(entropy));
-
-    if (!storage_get_pin_privatekey(pin_privatekey, sizeof(pin_privatekey))
-        || !get_pin_secret(pin, pin_len, pin_privatekey, pinsecret)
-        || !sign_payload(pin_privatekey, pinkeys.cke, pinsecret, entropy, sig)
-        || !encrypt_payload(pinkeys.encrypt_key, pinsecret, entropy, sig, payload, sizeof(payload))
+    if (!get_pin_secret(pin, pin_len, material.pin_hmac_key, pinsecret)
+        || !sign_payload(material.pin_privatekey, pinkeys.cke, pinsecret, material.entropy, sig)
+        || !encrypt_payload(pinkeys.encrypt_key, pinsecret, material.entropy, sig, payload, sizeof(payload))
         || !hmac_ckepayload(&pinkeys, payload, hmac_payload)) {
         // Internal failure
         retval.result = FAILURE;
@@ -643,10 +723,9 @@ static pinserver_result_t pinserver_interaction(jade_process_t* process, const u
 
 cleanup:
     SENSITIVE_POP(sig);
-    SENSITIVE_POP(entropy);
     SENSITIVE_POP(pinsecret);
-    SENSITIVE_POP(pin_privatekey);
     SENSITIVE_POP(&pinkeys);
+    SENSITIVE_POP(&material);
 
     return retval;
 }
@@ -74,21 +74,18 @@ static int register_multisig(const char* multisig_name, const char* network, con
     }
 
     // See if a record for this name exists already
-    const bool overwriting = storage_multisig_name_exists(multisig_name);
+    const bool overwriting = multisig_registration_exists(multisig_name);
 
     // If so, see if it is identical to the record we are trying to persist
     // - if so, just return true immediately.
     if (overwriting) {
-        size_t written = 0;
-        uint8_t existing[MAX_MULTISIG_BYTES_LEN]; // Sufficient
-        if (storage_get_multisig_registration(multisig_name, existing, sizeof(existing), &written)
-            && written == registration_len && !sodium_memcmp(existing, registration, registration_len)) {
+        if (multisig_registration_matches(multisig_name, registration, registration_len)) {
             JADE_LOGI("Multisig %s: identical registration exists, returning immediately", multisig_name);
             return 0; // success
         }
     } else {
         // Not overwriting an existing record - check storage slot available
-        if (storage_get_multisig_registration_count() >= MAX_MULTISIG_REGISTRATIONS) {
+        if (multisig_get_registration_count() >= MAX_MULTISIG_REGISTRATIONS) {
             *errmsg = "Already have maximum number of multisig wallets";
             return CBOR_RPC_BAD_PARAMETERS;
         }
@@ -123,7 +120,7 @@ static int register_multisig(const char* multisig_name, const char* network, con
     JADE_LOGD("User accepted multisig");
 
     // Persist multisig registration in nvs
-    if (!storage_set_multisig_registration(multisig_name, registration, registration_len)) {
+    if (!multisig_store_registration(multisig_name, registration, registration_len)) {
         *errmsg = "Failed to persist multisig data";
         await_error_activity("Error saving multisig");
         return CBOR_RPC_INTERNAL_ERROR;
@@ -549,8 +549,7 @@ void sign_liquid_tx_process(void* process_ptr)
     }
 
     // We always need this extra data to 'unblind' confidential txns
-    output_info_t* output_info = JADE_CALLOC(tx->num_outputs, sizeof(output_info_t));
-    jade_process_free_on_exit(process, output_info);
+    output_info_t* output_info = jade_process_calloc(process, tx->num_outputs, sizeof(output_info_t));
 
     // Whether to use Anti-Exfil signatures and message flow
     // Optional flag, defaults to false
@@ -743,8 +742,7 @@ void sign_liquid_tx_process(void* process_ptr)
     // We generate the hashes for each input but defer signing them
     // until after the final user confirmation.  Hold them in an block for
     // ease of cleanup if something goes wrong part-way through.
-    signing_data_t* const all_signing_data = JADE_CALLOC(num_inputs, sizeof(signing_data_t));
-    jade_process_free_on_exit(process, all_signing_data);
+    signing_data_t* const all_signing_data = jade_process_calloc(process, num_inputs, sizeof(signing_data_t));
 
     // We track if the type of the inputs we are signing changes (ie. single-sig vs
     // green/multisig/other) so we can show a warning to the user if so.
@@ -199,15 +199,6 @@ static bool get_suitable_multisig_record(const struct wally_map* keypaths, const
     JADE_ASSERT(target_script_len);
     JADE_ASSERT(multisig_data);
 
-    // Load multisig record names saved in nvs
-    char names[MAX_MULTISIG_REGISTRATIONS][NVS_KEY_NAME_MAX_SIZE]; // Sufficient
-    const size_t num_names = sizeof(names) / sizeof(names[0]);
-    size_t num_multisigs = 0;
-    if (!storage_get_all_multisig_registration_names(names, num_names, &num_multisigs)) {
-        JADE_LOGE("Error loading multisig record names - won't be able to verify multisig change");
-        return false;
-    }
-
     size_t path_len = 0;
     uint32_t path[MAX_PATH_LEN];
     JADE_WALLY_VERIFY(wally_map_keypath_get_item_path(keypaths, our_key_index, path, MAX_PATH_LEN, &path_len));
@@ -217,24 +208,38 @@ static bool get_suitable_multisig_record(const struct wally_map* keypaths, const
     JADE_ASSERT(path_tail_start <= path_len);
     const size_t path_tail_len = path_len - path_tail_start;
 
-    // Iterate over named persisted multisigs to see if one fits
-    for (int i = 0; i < num_multisigs; ++i) {
+    size_t num_keys = 0;
+    JADE_WALLY_VERIFY(wally_map_get_num_items(keypaths, &num_keys));
+
+    // Iterate over the persisted multisigs index to see if one fits
+    // Only load the full records of those with the expected script type and number of signers
+    const size_t num_multisigs = multisig_get_registration_count();
+    for (size_t i = 0; i < num_multisigs; ++i) {
+        multisig_summary_t summary;
+        if (!multisig_get_registration_summary(i, &summary)) {
+            JADE_LOGD("Ignoring multisig %s as not valid for this wallet", summary.name);
+            continue;
+        }
+        if (summary.num_signers != num_keys || script_length_for_variant(summary.variant) != target_script_len) {
+            continue;
+        }
+
         const char* errmsg = NULL;
-        if (!multisig_load_from_storage(names[i], multisig_data, &errmsg)) {
-            JADE_LOGD("Ignoring multisig %s as not valid for this wallet", names[i]);
+        if (!multisig_load_from_storage(summary.name, multisig_data, &errmsg)) {
+            JADE_LOGD("Failed to load multisig %s", summary.name);
             JADE_LOGD("%s", errmsg);
             continue;
         }
 
-        JADE_LOGD("Trying loaded multisig: %s", names[i]);
+        JADE_LOGD("Trying loaded multisig: %s", summary.name);
         if (!verify_multisig_script_matches(
                 multisig_data, &path[path_tail_start], path_tail_len, keypaths, target_script, target_script_len)) {
-            JADE_LOGD("Receive script failed validation with %s", names[i]);
+            JADE_LOGD("Receive script failed validation with %s", summary.name);
             continue;
         }
 
         // Found suitable record
-        JADE_LOGI("Found suitable multisig record: %s", names[i]);
+        JADE_LOGI("Found suitable multisig record: %s", summary.name);
         return true;
     }
 
@@ -367,8 +367,7 @@ void sign_tx_process(void* process_ptr)
     // NOTE: Element named 'change' for backward-compatibility reasons
     CborValue wallet_outputs;
     if (rpc_get_array("change", &params, &wallet_outputs)) {
-        output_info = JADE_CALLOC(tx->num_outputs, sizeof(output_info_t));
-        jade_process_free_on_exit(process, output_info);
+        output_info = jade_process_calloc(process, tx->num_outputs, sizeof(output_info_t));
 
         if (!validate_wallet_outputs(process, network, tx, &wallet_outputs, output_info, &errmsg)) {
             jade_process_reject_message(process, CBOR_RPC_BAD_PARAMETERS, errmsg, NULL);
@@ -410,8 +409,7 @@ void sign_tx_process(void* process_ptr)
     // We generate the hashes for each input but defer signing them
     // until after the final user confirmation.  Hold them in an block for
     // ease of cleanup if something goes wrong part-way through.
-    signing_data_t* const all_signing_data = JADE_CALLOC(num_inputs, sizeof(signing_data_t));
-    jade_process_free_on_exit(process, all_signing_data);
+    signing_data_t* const all_signing_data = jade_process_calloc(process, num_inputs, sizeof(signing_data_t));
 
     // We track if the type of the inputs we are signing changes (ie. single-sig vs
     // green/multisig/other) so we can show a warning to the user if so.
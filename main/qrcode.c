@@ -540,89 +540,133 @@ static void drawCodewords(BitBucket* modules, BitBucket* isFunction, BitBucket*
 #define PENALTY_N3 40
 #define PENALTY_N4 10
 
+// Finder-like patterns (1:1:3:1:1 with four light modules either side), as 11-bit windows
+#define PENALTY_FINDER_PATTERN_A 0x05D
+#define PENALTY_FINDER_PATTERN_B 0x5D0
+#define PENALTY_FINDER_PATTERN_LEN 11
+
+// Blockstream added - the module grid is packed into rows of 32-bit words (module x at bit x & 31 of
+// word x / 32) so the penalty rules can be evaluated 32 modules at a time.  Rows are evaluated along
+// the word (bit shifts), columns are evaluated across consecutive rows (one column per bit lane).
+// Each row has a trailing zero word, so reading a word shifted along the row never overruns.
+#define PENALTY_ROW_WORDS(size) (((size) + 31) / 32 + 1)
+
+// Returns the word holding modules [32*w + shift, 32*w + shift + 31] of the packed row
+static inline uint32_t rowWord(const uint32_t* row, uint8_t w, uint8_t shift)
+{
+    return shift ? (row[w] >> shift) | (row[w + 1] << (32 - shift)) : row[w];
+}
+
+// Returns the bits of word w which lie in the first 'count' module positions
+static inline uint32_t validBits(uint8_t w, int16_t count)
+{
+    const int16_t n = count - 32 * w;
+    return n <= 0 ? 0 : n >= 32 ? UINT32_MAX : (1u << n) - 1;
+}
+
+// Penalty for the runs of five or more same-coloured modules, given a word flagging the start of
+// each five-module run, and the same for the preceding position (so the start of each run can be found).
+// Each run of length L >= 5 scores N1 + (L - 5), which is one per five-module window plus (N1 - 1) per run.
+static inline uint32_t runPenalty(uint32_t run5, uint32_t prevRun5)
+{
+    return __builtin_popcount(run5) + (PENALTY_N1 - 1) * __builtin_popcount(run5 & ~prevRun5);
+}
+
+// Counts the positions where the 11 words of modules (one word per module along the line) match either
+// finder-like pattern (where the first module is the most-significant bit of the pattern).
+static inline uint8_t countFinderPatterns(const uint32_t* modules, uint32_t valid)
+{
+    uint32_t matchA = valid, matchB = valid;
+    for (uint8_t i = 0; i < PENALTY_FINDER_PATTERN_LEN; ++i) {
+        const uint8_t bit = PENALTY_FINDER_PATTERN_LEN - 1 - i;
+        matchA &= ((PENALTY_FINDER_PATTERN_A >> bit) & 1) ? modules[i] : ~modules[i];
+        matchB &= ((PENALTY_FINDER_PATTERN_B >> bit) & 1) ? modules[i] : ~modules[i];
+    }
+    return __builtin_popcount(matchA) + __builtin_popcount(matchB);
+}
+
 // Calculates and returns the penalty score based on state of this QR Code's current modules.
 // This is used by the automatic mask choice algorithm to find the mask pattern that yields the lowest score.
-// @TODO: This can be optimized by working with the bytes instead of bits.
+// NOTE: Blockstream - reworked to evaluate the rules on packed rows of modules, 32 modules at a time.
+// The scores returned are identical to those of the original module-by-module implementation.
 static uint32_t getPenaltyScore(BitBucket* modules)
 {
     uint32_t result = 0;
 
-    uint8_t size = modules->bitOffsetOrWidth;
-
-    // Adjacent modules in row having same color
-    for (uint8_t y = 0; y < size; y++) {
-
-        bool colorX = bb_getBit(modules, 0, y);
-        for (uint8_t x = 1, runX = 1; x < size; x++) {
-            bool cx = bb_getBit(modules, x, y);
-            if (cx != colorX) {
-                colorX = cx;
-                runX = 1;
-
-            } else {
-                runX++;
-                if (runX == 5) {
-                    result += PENALTY_N1;
-                } else if (runX > 5) {
-                    result++;
-                }
-            }
-        }
-    }
+    const uint8_t size = modules->bitOffsetOrWidth;
+    const uint8_t nwords = PENALTY_ROW_WORDS(size) - 1;
 
-    // Adjacent modules in column having same color
-    for (uint8_t x = 0; x < size; x++) {
-        bool colorY = bb_getBit(modules, x, 0);
-        for (uint8_t y = 1, runY = 1; y < size; y++) {
-            bool cy = bb_getBit(modules, x, y);
-            if (cy != colorY) {
-                colorY = cy;
-                runY = 1;
-            } else {
-                runY++;
-                if (runY == 5) {
-                    result += PENALTY_N1;
-                } else if (runY > 5) {
-                    result++;
-                }
+    // Pack the module grid into rows of words (with a trailing zero word per row)
+    uint32_t rows[size][nwords + 1];
+    memset(rows, 0, sizeof(rows));
+    for (uint16_t y = 0, offset = 0; y < size; ++y) {
+        for (uint8_t x = 0; x < size; ++x, ++offset) {
+            if (modules->data[offset >> 3] & (1 << (7 - (offset & 0x07)))) {
+                rows[y][x >> 5] |= 1u << (x & 31);
             }
         }
     }
 
     uint16_t black = 0;
     for (uint8_t y = 0; y < size; y++) {
-        uint16_t bitsRow = 0, bitsCol = 0;
-        for (uint8_t x = 0; x < size; x++) {
-            bool color = bb_getBit(modules, x, y);
+        const uint32_t* const row = rows[y];
+
+        // Flag pairs of adjacent modules in the row having same color
+        uint32_t same[nwords + 1];
+        for (uint8_t w = 0; w < nwords; ++w) {
+            same[w] = ~(row[w] ^ rowWord(row, w, 1)) & validBits(w, size - 1);
+        }
+        same[nwords] = 0;
+
+        uint32_t prevRun5 = 0;
+        for (uint8_t w = 0; w < nwords; ++w) {
+            // Adjacent modules in row having same color
+            const uint32_t run5 = same[w] & rowWord(same, w, 1) & rowWord(same, w, 2) & rowWord(same, w, 3);
+            result += runPenalty(run5, (run5 << 1) | prevRun5);
+            prevRun5 = run5 >> 31;
 
             // 2*2 blocks of modules having same color
-            if (x > 0 && y > 0) {
-                bool colorUL = bb_getBit(modules, x - 1, y - 1);
-                bool colorUR = bb_getBit(modules, x, y - 1);
-                bool colorL = bb_getBit(modules, x - 1, y);
-                if (color == colorUL && color == colorUR && color == colorL) {
-                    result += PENALTY_N2;
-                }
+            if (y > 0) {
+                const uint32_t* const above = rows[y - 1];
+                const uint32_t sameAbove = ~(above[w] ^ rowWord(above, w, 1)) & validBits(w, size - 1);
+                const uint32_t block = same[w] & sameAbove & ~(row[w] ^ above[w]);
+                result += PENALTY_N2 * __builtin_popcount(block);
             }
 
-            // Finder-like pattern in rows and columns
-            bitsRow = ((bitsRow << 1) & 0x7FF) | color;
-            bitsCol = ((bitsCol << 1) & 0x7FF) | bb_getBit(modules, y, x);
-
-            // Needs 11 bits accumulated
-            if (x >= 10) {
-                if (bitsRow == 0x05D || bitsRow == 0x5D0) {
-                    result += PENALTY_N3;
-                }
-                if (bitsCol == 0x05D || bitsCol == 0x5D0) {
-                    result += PENALTY_N3;
-                }
+            // Finder-like pattern in rows
+            uint32_t window[PENALTY_FINDER_PATTERN_LEN];
+            for (uint8_t i = 0; i < PENALTY_FINDER_PATTERN_LEN; ++i) {
+                window[i] = rowWord(row, w, i);
             }
+            result += PENALTY_N3 * countFinderPatterns(window, validBits(w, size - PENALTY_FINDER_PATTERN_LEN + 1));
 
             // Balance of black and white modules
-            if (color) {
-                black++;
+            black += __builtin_popcount(row[w]);
+        }
+    }
+
+    // Columns are evaluated a word of columns at a time, walking down the rows
+    for (uint8_t w = 0; w < nwords; ++w) {
+        const uint32_t valid = validBits(w, size);
+
+        // Adjacent modules in column having same color
+        uint32_t prevRun5 = 0;
+        for (uint8_t y = 0; y + 4 < size; ++y) {
+            uint32_t run5 = valid;
+            for (uint8_t i = 0; i < 4; ++i) {
+                run5 &= ~(rows[y + i][w] ^ rows[y + i + 1][w]);
+            }
+            result += runPenalty(run5, prevRun5);
+            prevRun5 = run5;
+        }
+
+        // Finder-like pattern in columns
+        for (uint8_t y = 0; y + PENALTY_FINDER_PATTERN_LEN <= size; ++y) {
+            uint32_t window[PENALTY_FINDER_PATTERN_LEN];
+            for (uint8_t i = 0; i < PENALTY_FINDER_PATTERN_LEN; ++i) {
+                window[i] = rows[y + i][w];
             }
+            result += PENALTY_N3 * countFinderPatterns(window, valid);
         }
     }
 
@@ -939,6 +983,105 @@ bool qrcode_getModule(QRCode* qrcode, uint8_t x, uint8_t y)
     return (qrcode->modules[offset >> 3] & (1 << (7 - (offset & 0x07)))) != 0;
 }
 
+// Blockstream added functions
+// Icon data is stored one bit per pixel (LSB first) in uint32's, with pixel rows packed contiguously.
+// Rather than setting each pixel individually, a row of modules is expanded into a row of pixels a
+// whole word at a time (using a table of pre-expanded groups of four modules where the scale allows),
+// and that pixel row is then copied into the icon 'scale' times, again a word at a time.
+#define QR_ICON_BITS_PER_UINT (sizeof(uint32_t) * 8)
+#define QR_ICON_MODULES_PER_GROUP 4
+#define QR_ICON_MAX_GROUP_SCALE (QR_ICON_BITS_PER_UINT / QR_ICON_MODULES_PER_GROUP)
+
+// Build table of each possible group of four modules, expanded to 'scale' pixels per module
+static void buildGroupTable(const uint8_t scale, uint32_t* table)
+{
+    JADE_ASSERT(scale <= QR_ICON_MAX_GROUP_SCALE);
+    const uint32_t module_pixels = (1u << scale) - 1;
+    for (uint8_t group = 0; group < (1 << QR_ICON_MODULES_PER_GROUP); ++group) {
+        table[group] = 0;
+        for (uint8_t i = 0; i < QR_ICON_MODULES_PER_GROUP; ++i) {
+            if (group & (1 << i)) {
+                table[group] |= module_pixels << (i * scale);
+            }
+        }
+    }
+}
+
+// Expand 'count' modules of the qrcode row 'y', starting at column 'x', into a row of pixels, each module
+// becoming 'scale' pixels.  Any modules outside the qrcode are light.  Pixel words are written, not or'd.
+// 'table' should be as built by buildGroupTable() for this scale, or NULL if the scale is too large for that.
+static void expandModuleRow(QRCode* qrcode, const uint8_t y, const uint8_t x, const uint8_t count,
+    const uint8_t scale, const uint32_t* table, uint32_t* row)
+{
+    uint64_t pending = 0;
+    uint8_t num_pending = 0;
+    for (uint8_t i = 0; i < count;) {
+        if (table) {
+            // Expand a group of (up to) four modules from the table
+            const uint8_t num_modules = count - i < QR_ICON_MODULES_PER_GROUP ? count - i : QR_ICON_MODULES_PER_GROUP;
+            uint8_t group = 0;
+            for (uint8_t j = 0; j < num_modules; ++j) {
+                group |= qrcode_getModule(qrcode, x + i + j, y) << j;
+            }
+            pending |= (uint64_t)table[group] << num_pending;
+            num_pending += num_modules * scale;
+            i += num_modules;
+        } else {
+            // Large scale - expand a single module, in chunks of up to a word of pixels
+            const bool paint = qrcode_getModule(qrcode, x + i, y);
+            for (uint16_t remaining = scale; remaining;) {
+                const uint8_t num_pixels = remaining < QR_ICON_BITS_PER_UINT ? remaining : QR_ICON_BITS_PER_UINT;
+                if (paint) {
+                    pending |= (uint64_t)(UINT32_MAX >> (QR_ICON_BITS_PER_UINT - num_pixels)) << num_pending;
+                }
+                num_pending += num_pixels;
+                remaining -= num_pixels;
+
+                if (num_pending >= QR_ICON_BITS_PER_UINT) {
+                    *row++ = (uint32_t)pending;
+                    pending >>= QR_ICON_BITS_PER_UINT;
+                    num_pending -= QR_ICON_BITS_PER_UINT;
+                }
+            }
+            ++i;
+        }
+
+        if (num_pending >= QR_ICON_BITS_PER_UINT) {
+            *row++ = (uint32_t)pending;
+            pending >>= QR_ICON_BITS_PER_UINT;
+            num_pending -= QR_ICON_BITS_PER_UINT;
+        }
+    }
+
+    if (num_pending) {
+        *row = (uint32_t)pending;
+    }
+}
+
+// Or 'num_pixels' pixels from 'src' into the (zeroed) icon data 'dest', starting at pixel 'offset'
+static void blitPixelRow(uint32_t* dest, const uint32_t offset, const uint32_t* src, uint16_t num_pixels)
+{
+    dest += offset / QR_ICON_BITS_PER_UINT;
+    const uint8_t shift = offset % QR_ICON_BITS_PER_UINT;
+    for (; num_pixels; ++src, ++dest) {
+        const uint8_t num_bits = num_pixels < QR_ICON_BITS_PER_UINT ? num_pixels : QR_ICON_BITS_PER_UINT;
+        const uint32_t word = *src & (UINT32_MAX >> (QR_ICON_BITS_PER_UINT - num_bits));
+
+        *dest |= word << shift;
+        if (shift && shift + num_bits > QR_ICON_BITS_PER_UINT) {
+            dest[1] |= word >> (QR_ICON_BITS_PER_UINT - shift);
+        }
+        num_pixels -= num_bits;
+    }
+}
+
+// Number of uint32's of icon data for an icon of the given size
+// Note: we add one for any final partially filled uint32
+static size_t iconDataSize(const uint16_t width, const uint16_t height)
+{
+    return ((width * height) / QR_ICON_BITS_PER_UINT) + 1;
+}
+
 void qrcode_toIcon(QRCode* qrcode, Icon* icon, const uint8_t scale)
 {
     JADE_ASSERT(qrcode);
@@ -947,58 +1090,74 @@ void qrcode_toIcon(QRCode* qrcode, Icon* icon, const uint8_t scale)
 
     icon->width = qrcode->size * scale;
     icon->height = qrcode->size * scale;
+    icon->data = JADE_CALLOC_PREFER_SPIRAM(iconDataSize(icon->width, icon->height), sizeof(uint32_t));
 
-    // Icon data is stored one bit per pixel, in uint32's
-    // Note: we add one for any final partially filled uint32
-    const uint8_t bits_per_uint = sizeof(uint32_t) * 8;
-    const size_t num_pixels = icon->width * icon->height;
-    const size_t num_uints = (num_pixels / bits_per_uint) + 1;
-    icon->data = JADE_CALLOC_PREFER_SPIRAM(num_uints, sizeof(uint32_t));
+    qrcode_redrawIcon(qrcode, icon, scale);
+}
 
-    uint64_t val = 0;
-    for (uint8_t y = 0; y < qrcode->size; y++) {
-        // scaling
-        for (uint8_t j = 0; j < scale; j++) {
-            for (uint8_t x = 0; x < qrcode->size; x++) {
-                const bool paint = qrcode_getModule(qrcode, x, y);
+// Redraw an existing icon (as created by qrcode_toIcon() for a qrcode of the same size and scale)
+// NOTE: the icon data buffer is reused, so no allocation is made.
+void qrcode_redrawIcon(QRCode* qrcode, Icon* icon, const uint8_t scale)
+{
+    JADE_ASSERT(qrcode);
+    JADE_ASSERT(icon);
+    JADE_ASSERT(icon->data);
+    JADE_ASSERT(scale);
+    JADE_ASSERT(icon->width == qrcode->size * scale);
+    JADE_ASSERT(icon->height == qrcode->size * scale);
 
-                // scaling
-                for (uint8_t i = 0; i < scale; i++) {
-                    const uint32_t elem = val / bits_per_uint;
-                    const uint32_t bit = val % bits_per_uint;
+    memset(icon->data, 0, iconDataSize(icon->width, icon->height) * sizeof(uint32_t));
 
-                    JADE_ASSERT(elem < num_uints);
-                    icon->data[elem] |= paint << bit;
+    uint32_t table[1 << QR_ICON_MODULES_PER_GROUP];
+    const bool use_table = scale <= QR_ICON_MAX_GROUP_SCALE;
+    if (use_table) {
+        buildGroupTable(scale, table);
+    }
 
-                    val++;
-                }
-            }
+    uint32_t row[(icon->width + QR_ICON_BITS_PER_UINT - 1) / QR_ICON_BITS_PER_UINT];
+    uint32_t offset = 0;
+    for (uint8_t y = 0; y < qrcode->size; y++) {
+        expandModuleRow(qrcode, y, 0, qrcode->size, scale, use_table ? table : NULL, row);
+
+        // scaling
+        for (uint8_t j = 0; j < scale; j++, offset += icon->width) {
+            blitPixelRow(icon->data, offset, row, icon->width);
         }
     }
 }
 
-// Blockstream added function
-// NOTE: only supports v1 and v2 qrcodes atm.
-// fyi: target_size of 105 works well for 'full screen' icons of v1 and v2 qrcodes
-bool qrcode_toFragmentsIcons(
-    QRCode* qrcode, const uint8_t target_size, const bool show_grid, Icon** icons_out, size_t* num_icons_out)
+// Default split of a qrcode into fragments - an even split into fragments of no more than
+// seven modules square, if possible, otherwise fragments of seven modules (last ones padded).
+// eg. v1 (21x21) uses a 3x3 grid of 7x7 fragments, v2 (25x25) uses a 5x5 grid of 5x5 fragments.
+static uint8_t defaultFragmentsPerSide(const uint8_t size)
+{
+    const uint8_t min_fragments = (size + 6) / 7;
+    for (uint8_t fragments = min_fragments; fragments <= (size + 4) / 5; ++fragments) {
+        if (size % fragments == 0) {
+            return fragments;
+        }
+    }
+    return min_fragments;
+}
+
+// Split the qrcode into a square grid of fragments, with the given number of fragments per side.  If the qrcode
+// does not split evenly the last fragments in each row and column are padded with light modules.
+static bool toFragmentsIcons(QRCode* qrcode, const uint8_t num_fragments_per_side, const uint8_t target_size,
+    const bool show_grid, Icon** icons_out, size_t* num_icons_out)
 {
     JADE_ASSERT(qrcode);
     JADE_ASSERT(target_size);
     JADE_INIT_OUT_PPTR(icons_out);
     JADE_INIT_OUT_SIZE(num_icons_out);
 
-    // Only versions 1 and 2 are supported atm (sizes 21 and 25)
-    if (qrcode->version < 1 || qrcode->version > 2) {
-        JADE_LOGE("qr version unsupported for fragmenting: %u", qrcode->version);
+    if (!num_fragments_per_side || num_fragments_per_side > qrcode->size) {
+        JADE_LOGE("Invalid number of fragments %u for qr size %u", num_fragments_per_side, qrcode->size);
         return false;
     }
 
-    // For v1 (21x21) we use a 3x3 grid of 7x7 icons (ie. 9 icons)
-    // For v2 (25x25) we use a 5x5 grid of 5x5 icons (ie. 25 icons)
-    const uint8_t num_fragments_per_side = qrcode->version == 1 ? 3 : 5;
-    const uint8_t fragment_size = qrcode->version == 1 ? 7 : 5;
-    JADE_ASSERT(num_fragments_per_side * fragment_size == qrcode->size);
+    // Fragments are all the same size - if the qrcode does not divide evenly the last
+    // fragments in each row/column are padded with light (ie. quiet-zone) modules.
+    const uint8_t fragment_size = (qrcode->size + num_fragments_per_side - 1) / num_fragments_per_side;
     if (target_size < fragment_size) {
         JADE_LOGE("Target size too small for version %u code - min size %u", qrcode->version, fragment_size);
         return false;
@@ -1014,55 +1173,68 @@ bool qrcode_toFragmentsIcons(
     JADE_LOGI("Mapping QR version %u (%ux%u) into %u %ux%u fragments", qrcode->version, qrcode->size, qrcode->size,
         *num_icons_out, icon_size, icon_size);
 
-    // Icon data is stored one bit per pixel, in uint32's
-    // Note: we add one for any final partially filled uint32
-    const uint8_t bits_per_uint = sizeof(uint32_t) * 8;
-    const size_t num_pixels = icon_size * icon_size;
-    const size_t num_uints = (num_pixels / bits_per_uint) + 1;
+    uint32_t table[1 << QR_ICON_MODULES_PER_GROUP];
+    const bool use_table = scale <= QR_ICON_MAX_GROUP_SCALE;
+    if (use_table) {
+        buildGroupTable(scale, table);
+    }
 
+    // Grid-lines, if shown, invert the pixels on the first row/column of each module and on the last row/column
+    // of the icon.  Precompute the mask of pixels to invert for rows with and without a horizontal grid-line.
+    const size_t row_words = (icon_size + QR_ICON_BITS_PER_UINT - 1) / QR_ICON_BITS_PER_UINT;
+    uint32_t grid_columns[row_words];
+    memset(grid_columns, 0, sizeof(grid_columns));
+    for (uint16_t dest_x = 0; dest_x < icon_size; dest_x += scale) {
+        grid_columns[dest_x / QR_ICON_BITS_PER_UINT] |= 1u << (dest_x % QR_ICON_BITS_PER_UINT);
+    }
+    grid_columns[(icon_size - 1) / QR_ICON_BITS_PER_UINT] |= 1u << ((icon_size - 1) % QR_ICON_BITS_PER_UINT);
+
+    uint32_t row[row_words];
+    uint32_t line[row_words];
     for (size_t i = 0; i < *num_icons_out; ++i) {
         // Create fragment icon
         Icon* const icon = (*icons_out) + i;
         icon->width = icon_size;
         icon->height = icon_size;
-        icon->data = JADE_CALLOC_PREFER_SPIRAM(num_uints, sizeof(uint32_t));
+        icon->data = JADE_CALLOC_PREFER_SPIRAM(iconDataSize(icon->width, icon->height), sizeof(uint32_t));
 
         const uint8_t fragment_orig_y = (i / num_fragments_per_side) * fragment_size;
         const uint8_t fragment_orig_x = (i % num_fragments_per_side) * fragment_size;
         JADE_LOGD("Fragment icon %u, origin maps to (%u, %u)", i, fragment_orig_x, fragment_orig_y);
 
-        // Iterate over the destination, copying the source data across
-        for (uint16_t dest_y = 0; dest_y < icon->height; ++dest_y) {
-            const uint32_t dest_y_pixel_offset = dest_y * icon->width;
-            const uint8_t src_y = (dest_y / scale) + fragment_orig_y;
-            JADE_ASSERT(src_y < qrcode->size);
-
-            for (uint16_t dest_x = 0; dest_x < icon->width; ++dest_x) {
-                const uint8_t src_x = (dest_x / scale) + fragment_orig_x;
-                JADE_ASSERT(src_x < qrcode->size);
-
-                const uint32_t dest_pixel = dest_y_pixel_offset + dest_x;
-                JADE_ASSERT(dest_pixel < num_pixels);
+        // Expand each row of the fragment, and copy it into the icon 'scale' times
+        uint32_t offset = 0;
+        for (uint8_t src_y = fragment_orig_y; src_y < fragment_orig_y + fragment_size; ++src_y) {
+            expandModuleRow(qrcode, src_y, fragment_orig_x, fragment_size, scale, use_table ? table : NULL, row);
 
-                // Copy single module->pixel ie. single bit
-                const uint32_t dest_elem = dest_pixel / bits_per_uint;
-                const uint8_t dest_bit = dest_pixel % bits_per_uint;
-                JADE_ASSERT(dest_elem < num_uints);
-
-                bool paint = qrcode_getModule(qrcode, src_x, src_y);
+            for (uint8_t j = 0; j < scale; j++, offset += icon->width) {
+                const uint32_t* pixels = row;
                 if (show_grid) {
                     // Invert if on a grid-line
-                    const bool gridline = (dest_x == icon->width - 1) || (dest_x % scale == 0)
-                        || (dest_y == icon->height - 1) || (dest_y % scale == 0);
-                    paint = (paint != gridline);
+                    const uint16_t dest_y = offset / icon->width;
+                    const bool gridline = (dest_y == icon->height - 1) || (j == 0);
+                    for (size_t w = 0; w < row_words; ++w) {
+                        line[w] = row[w] ^ (gridline ? UINT32_MAX : grid_columns[w]);
+                    }
+                    pixels = line;
                 }
-                icon->data[dest_elem] |= paint << dest_bit;
+                blitPixelRow(icon->data, offset, pixels, icon->width);
             }
         }
     }
     return true;
 }
-// End Blockstream added function
+
+// fyi: target_size of 105 works well for 'full screen' icons of v1 and v2 qrcodes
+bool qrcode_toFragmentsIcons(
+    QRCode* qrcode, const uint8_t target_size, const bool show_grid, Icon** icons_out, size_t* num_icons_out)
+{
+    JADE_ASSERT(qrcode);
+
+    const uint8_t num_fragments_per_side = defaultFragmentsPerSide(qrcode->size);
+    return toFragmentsIcons(qrcode, num_fragments_per_side, target_size, show_grid, icons_out, num_icons_out);
+}
+// End Blockstream added functions
 
 void qrcode_freeIcon(Icon* icon)
 {
@@ -83,7 +83,13 @@ void qrcode_toIcon(QRCode* qrcode, Icon* icon, uint8_t scale);
 void qrcode_freeIcon(Icon* icon);
 
 // Blockstream added function
-// NOTE: only supports v1 and v2 qrcodes atm.
+// Redraws into the data buffer of an icon previously created by qrcode_toIcon()
+// for a qrcode of the same version, and using the same scale.
+void qrcode_redrawIcon(QRCode* qrcode, Icon* icon, uint8_t scale);
+
+// Blockstream added function
+// Splits the qrcode into a square grid of fragments, each rendered as an icon scaled to fit 'target_size'.
+// The default split yields fragments of around 5-7 modules square (eg. 3x3 for v1, 5x5 for v2 qrcodes).
 bool qrcode_toFragmentsIcons(
     QRCode* qrcode, uint8_t target_size, bool show_grid, Icon** icons_out, size_t* num_icons_out);
 
@@ -43,6 +43,9 @@ void make_search_verify_address_activity(
 
 void make_show_qr_activity(gui_activity_t** activity_ptr, const char* title, const char* label, Icon* icons,
     size_t num_icons, size_t frames_per_qr_icon, bool show_options_button);
+void make_show_qr_stream_activity(gui_activity_t** activity_ptr, const char* title, const char* label,
+    const Icon* first_icon, gui_icon_generator_fn_t generator, void* ctx, free_callback_t free_ctx,
+    size_t frames_per_qr_icon, bool show_options_button);
 void make_qr_options_activity(
     gui_activity_t** activity_ptr, gui_view_node_t** density_textbox, gui_view_node_t** speed_textbox);
 
@@ -590,16 +593,20 @@ static void create_display_bcur_qr_activity(gui_activity_t** activity_ptr, const
     JADE_ASSERT(cbor);
     JADE_ASSERT(cbor_len);
 
-    // Map BCUR cbor into a series of QR-code icons
-    Icon* icons = NULL;
-    size_t num_icons = 0;
+    // Map BCUR cbor into a stream of QR-code icons, rendered on demand as they are displayed
+    Icon first_icon = { 0 };
+    bcur_icon_stream_t* stream = NULL;
+    size_t num_fragments = 0;
     const uint8_t qrcode_version = qr_version_from_flags(qr_flags);
-    bcur_create_qr_icons(cbor, cbor_len, bcur_type, qrcode_version, &icons, &num_icons);
+    bcur_create_qr_icon_stream(cbor, cbor_len, bcur_type, qrcode_version, &stream, &first_icon, &num_fragments);
+    JADE_ASSERT(stream);
 
-    // Create qr activity for those icons
+    // Create qr activity for that stream - the activity takes ownership of the stream
+    // A single fragment is not animated, so the stream need not be polled.
     const bool show_options_button = true;
-    const uint8_t frames_per_qr = qr_animation_speed_from_flags(qr_flags);
-    make_show_qr_activity(activity_ptr, title, label, icons, num_icons, frames_per_qr, show_options_button);
+    const uint8_t frames_per_qr = num_fragments > 1 ? qr_animation_speed_from_flags(qr_flags) : 0;
+    make_show_qr_stream_activity(activity_ptr, title, label, &first_icon, bcur_icon_stream_next, stream,
+        bcur_free_icon_stream, frames_per_qr, show_options_button);
     JADE_ASSERT(*activity_ptr);
 }
 
@@ -12,8 +12,27 @@
 #include "esp_system.h"
 #include "esp_timer.h"
 
-// Inspect qrcodes and try to extract payload - whether any were seen and any
-// string data extracted are stored in the qr_data struct passed.
+// The most qr codes quirc will identify in a single image (see QUIRC_MAX_GRIDS)
+#define QR_MAX_CODES_PER_FRAME 8
+
+// Simple FNV-1a hash of a payload - used to spot repeated codes within a single frame
+static uint32_t payload_hash(const uint8_t* data, const size_t len)
+{
+    JADE_ASSERT(data);
+
+    uint32_t hash = 0x811c9dc5;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= data[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+// Inspect qrcodes and try to extract payloads - every code identified in the image is
+// decoded in turn, and each distinct payload is written into the qr_data struct passed
+// and offered to any validation function.  Returns true as soon as one payload is
+// accepted (or if there is no validation function, on the first payload extracted).
+// This allows multi-frame (eg. bc-ur) data to be collected from several codes per image.
 static bool qr_extract_payload(qr_data_t* qr_data)
 {
     JADE_ASSERT(qr_data);
@@ -29,40 +48,72 @@ static bool qr_extract_payload(qr_data_t* qr_data)
     }
     JADE_LOGI("Detected %d QR codes in image.", count);
 
-    // Store the first string we manage to extract - initialise to empty string.
+    // Note the payloads already seen in this frame, so duplicates are not reprocessed
+    struct {
+        uint32_t hash;
+        size_t len;
+    } seen[QR_MAX_CODES_PER_FRAME];
+    size_t num_seen = 0;
+
     struct quirc_data data;
     SENSITIVE_PUSH(&data, sizeof(data));
 
-    // Look for a string
-    for (int i = 0; i < count; ++i) {
+    // Look for strings
+    bool accepted = false;
+    for (int i = 0; i < count && !accepted; ++i) {
         struct quirc_code code;
         quirc_extract(qr_data->q, i, &code);
 
         const quirc_decode_error_t error_status = quirc_decode(&code, &data, qr_data->ds);
         if (error_status != QUIRC_SUCCESS) {
             JADE_LOGW("QUIRC error %s", quirc_strerror(error_status));
+            continue;
         } else if (data.data_type == QUIRC_DATA_TYPE_KANJI) {
             JADE_LOGW("QUIRC unexpected data type: %d", data.data_type);
+            continue;
         } else if (!data.payload_len) {
             JADE_LOGW("QUIRC empty string");
+            continue;
         } else if (data.payload_len >= sizeof(qr_data->data)) {
             JADE_LOGW("QUIRC data too long to handle: %u", data.payload_len);
             JADE_ASSERT(data.payload_len <= sizeof(data.payload));
-        } else {
-            // The payload appears to be a nul terminated string, but the
-            // 'payload_len' seems to be the string length not including that
-            // terminator.
-            // To avoid any confusion or grey areas, we copy the bytes,
-            // and then explicitly add the nul terminator ourselves.
-            memcpy(qr_data->data, data.payload, data.payload_len);
-            qr_data->data[data.payload_len] = '\0';
-            qr_data->len = data.payload_len;
-            SENSITIVE_POP(&data);
-            return true;
+            continue;
+        }
+
+        // Skip any payload already processed from this frame
+        const uint32_t hash = payload_hash(data.payload, data.payload_len);
+        bool duplicate = false;
+        for (size_t j = 0; j < num_seen && !duplicate; ++j) {
+            duplicate = seen[j].hash == hash && seen[j].len == data.payload_len;
+        }
+        if (duplicate) {
+            JADE_LOGD("Ignoring repeated QR code %d in image", i);
+            continue;
+        }
+        if (num_seen < QR_MAX_CODES_PER_FRAME) {
+            seen[num_seen].hash = hash;
+            seen[num_seen].len = data.payload_len;
+            ++num_seen;
+        }
+
+        // The payload appears to be a nul terminated string, but the
+        // 'payload_len' seems to be the string length not including that
+        // terminator.
+        // To avoid any confusion or grey areas, we copy the bytes,
+        // and then explicitly add the nul terminator ourselves.
+        memcpy(qr_data->data, data.payload, data.payload_len);
+        qr_data->data[data.payload_len] = '\0';
+        qr_data->len = data.payload_len;
+
+        // If we have an additional validation function, run that function now.
+        // If it fails (or is incomplete), clear the data and try any other codes.
+        accepted = !qr_data->is_valid || qr_data->is_valid(qr_data);
+        if (!accepted) {
+            qr_data->len = 0;
         }
     }
     SENSITIVE_POP(&data);
-    return false;
+    return accepted;
 }
 
 // Look for qr-codes, and if found extract any string data into the camera_data passed
@@ -88,20 +139,13 @@ static bool qr_recognize(
     memcpy(quirc_image, data, len);
     quirc_end(qr_data->q);
 
-    // If no QR data can be recognised/extracted, return false
+    // If no QR data can be recognised/extracted and validated, return false
+    // NOTE: any validation function is run against each code found in the image
     if (!qr_extract_payload(qr_data) || !qr_data->len) {
         qr_data->len = 0;
         return false;
     }
 
-    // If we have extracted data and we have an additional validation
-    // function, run that function now - clear the data and return false
-    // if it fails.  Otherwise all good.
-    if (qr_data->is_valid && !qr_data->is_valid(qr_data)) {
-        qr_data->len = 0;
-        return false;
-    }
-
     // Make the completed QR image capture count as 'activity' against the idle timer
     idletimer_register_activity(true);
 
@@ -109,7 +153,6 @@ static bool qr_recognize(
     return true;
 }
 
-
 static bool qr_recognize2(
     const size_t width, const size_t height, const uint8_t* data, const size_t len, void* ctx_qr_data)
 {
@@ -22,6 +22,8 @@ struct _qr_data_t {
     // An optional validation function - if included, scanning will only stop
     // and populate the string fields if the validation returns true.
     // If NULL, any successfully extracted string is sufficient.
+    // NOTE: where an image contains several distinct qr codes, this function is
+    // called for each in turn until one is accepted.
     qr_valid_fn_t is_valid;
 
     // Arbitrary context that may be required by the validation function.
@@ -11,6 +11,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <mbedtls/sha512.h>
+#include <sodium/crypto_stream_chacha20.h>
 #include <string.h>
 #include <wally_crypto.h>
 
@@ -21,6 +22,10 @@
 
 #define STRENGTHEN_MILLISECONDS 1000
 
+// The ChaCha20 DRBG is reseeded from the entropy pool after this much output, or this long
+#define DRBG_RESEED_BYTES (64 * 1024)
+#define DRBG_RESEED_INTERVAL_US (60 * 1000 * 1000)
+
 // these functions rely on cleanup being available
 #define hasherstart(ctx)                                                                                               \
     do {                                                                                                               \
@@ -46,6 +51,15 @@ static uint8_t entropy_state[SHA256_LEN];
 static uint32_t rnd_counter;
 static portMUX_TYPE rndmutex;
 
+// ChaCha20 'fast key erasure' DRBG state
+// NOTE: each key is only ever used once, so a fixed (zero) nonce is fine
+static const uint8_t drbg_nonce[crypto_stream_chacha20_ietf_NONCEBYTES] = { 0 };
+static uint8_t drbg_key[crypto_stream_chacha20_ietf_KEYBYTES];
+static size_t drbg_bytes_since_reseed;
+static int64_t drbg_reseed_time;
+static volatile bool drbg_reseed_pending = true;
+static portMUX_TYPE drbgmutex;
+
 static uint16_t esp32_get_temperature(void)
 {
     // taken from esp-idf components/esp32/test/test_tsens.c
@@ -131,19 +145,55 @@ void refeed_entropy(const uint8_t* additional, const size_t len)
     JADE_ASSERT(additional);
     JADE_ASSERT(len);
     get_random_internal(NULL, 0, additional, len);
+
+    // Have the DRBG pick up the new entropy when next used
+    drbg_reseed_pending = true;
+}
+
+// Mix fresh output from the entropy pool into the DRBG key
+static void drbg_reseed(void)
+{
+    uint8_t seed[crypto_stream_chacha20_ietf_KEYBYTES];
+    get_random_internal(seed, sizeof(seed), NULL, 0);
+
+    portENTER_CRITICAL(&drbgmutex);
+    for (size_t i = 0; i < sizeof(drbg_key); ++i) {
+        drbg_key[i] ^= seed[i];
+    }
+    drbg_bytes_since_reseed = 0;
+    drbg_reseed_time = esp_timer_get_time();
+    drbg_reseed_pending = false;
+    portEXIT_CRITICAL(&drbgmutex);
+
+    JADE_WALLY_VERIFY(wally_bzero(seed, sizeof(seed)));
 }
 
+// Random bytes are generated by a ChaCha20 DRBG, reseeded from the entropy pool on a byte-count
+// or time budget, or when new entropy is fed in.
+// The first keystream block of the current key yields the next key (which overwrites it, so past
+// output cannot be recovered) and a one-off key for this request, whose keystream is the output.
 void get_random(uint8_t* bytes_out, const size_t len)
 {
     JADE_ASSERT(bytes_out);
     JADE_ASSERT(len);
 
-    size_t filled = 0;
-    while (filled != len) {
-        const size_t towrite = len - filled > SHA256_LEN ? SHA256_LEN : len - filled;
-        get_random_internal(bytes_out + filled, towrite, NULL, 0);
-        filled += towrite;
+    if (drbg_reseed_pending || drbg_bytes_since_reseed >= DRBG_RESEED_BYTES
+        || esp_timer_get_time() - drbg_reseed_time >= DRBG_RESEED_INTERVAL_US) {
+        drbg_reseed();
     }
+
+    uint8_t keys[2 * crypto_stream_chacha20_ietf_KEYBYTES];
+    portENTER_CRITICAL(&drbgmutex);
+    crypto_stream_chacha20_ietf(keys, sizeof(keys), drbg_nonce, drbg_key);
+    memcpy(drbg_key, keys, sizeof(drbg_key));
+    drbg_bytes_since_reseed += len;
+    portEXIT_CRITICAL(&drbgmutex);
+
+    // Generate the output outside of the critical section
+    crypto_stream_chacha20_ietf(bytes_out, len, drbg_nonce, keys + sizeof(drbg_key));
+
+    // As with refeeding, can be called from any task so use wally_bzero() explicitly
+    JADE_WALLY_VERIFY(wally_bzero(keys, sizeof(keys)));
 }
 
 uint8_t get_uniform_random_byte(const uint8_t upper_bound)
@@ -260,6 +310,7 @@ void random_start_collecting(void)
     bootloader_random_disable();
 
     spinlock_initialize(&rndmutex);
+    spinlock_initialize(&drbgmutex);
 }
 
 void random_full_initialization(void)
@@ -5,9 +5,11 @@
 #include <wally_bip32.h>
 
 #include "bcur.h"
+#include "camera_exposure.h"
 #include "jade_assert.h"
 #include "jade_wally_verify.h"
 #include "keychain.h"
+#include "qrcode.h"
 #include "random.h"
 #include "storage.h"
 #include <sodium/crypto_verify_64.h>
@@ -18,6 +20,9 @@
 #include <cencoder.h>
 #include <ctype.h>
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
 void get_bip85_mnemonic(const uint32_t nwords, const uint32_t index, char** new_mnemonic);
 
 static const char TEST_MNEMONIC[] = "fish inner face ginger orchard permit useful method fence kidney chuckle party "
@@ -747,6 +752,244 @@ static bool test_bcur_icons(void)
     return true;
 }
 
+// Known-good qrcode encodings (chosen mask and hash of the module grid), to check any changes
+// to the encoder (eg. mask penalty scoring) continue to yield byte-identical qr codes.
+static const struct {
+    uint8_t version;
+    uint8_t ecc;
+    uint8_t mask;
+    uint32_t modules_hash;
+    const char* text;
+} QRCODE_REGRESSION_CASES[] = {
+    { 4, ECC_LOW, 1, 0x597d5c84, "UR:CRYPTO-PSBT/1-3/LPADAXCFAXHLCYYNAEYLDSHDRNSPKPFGMTSTYNTWNY" },
+    { 4, ECC_MEDIUM, 4, 0xdfbbc85b, "bc1qar0srrr7xfkvy5l643lydnw9re59gtzzwf5mdq" },
+    { 5, ECC_LOW, 0, 0xbb580d10, "BITCOIN:BC1QAR0SRRR7XFKVY5L643LYDNW9RE59GTZZWF5MDQ" },
+    { 6, ECC_LOW, 4, 0xfa3f7ea8,
+        "UR:CRYPTO-ACCOUNT/OEADCYEMREWYTYAOLNTAAHDEONAXLFAOYKAOCYKNNYAHNSAYCYTPSPYAOXAXHDCLAXAHFHPMLOYAB" },
+    { 6, ECC_QUARTILE, 2, 0x45a5bd05, "https://help.blockstream.com/hc/en-us/articles/19629901272345" },
+    { 8, ECC_LOW, 4, 0x78b8bfbc,
+        "xpub6BosfCnifzxcFwrSzQiqu2DBVTshkCXacvNsWGYJVVhhawA7d4R5WSWGFNbi8Aw6ZRc1brxMyWMzG3DSSSSoekkudhUd9yLb6qx3"
+        "9T9nMdj" },
+    { 10, ECC_HIGH, 4, 0x36b46e33, "The quick brown fox jumps over the lazy dog 0123456789" },
+    { 12, ECC_LOW, 2, 0x7d2c3a36,
+        "UR:CRYPTO-PSBT/12-34/LPCSBNCPCSSWAXHDDATPPAMHDAVSRHFMTDRYBYSEFPSKPYPRDPKSENNEWECFMNTBGWFNHDKIGPRMGLNBBNH"
+        "HHDDLEOTSKGWTOYWTHDHDNTVAWNGRWLMSJKDTPDEWTYEYATKNSKBTLTDWMHBDSKSPSNEHGDBSSRLRAMUEYL" },
+};
+
+static bool test_qrcode_regression(void)
+{
+    for (size_t i = 0; i < sizeof(QRCODE_REGRESSION_CASES) / sizeof(QRCODE_REGRESSION_CASES[0]); ++i) {
+        const uint8_t version = QRCODE_REGRESSION_CASES[i].version;
+        const uint8_t ecc = QRCODE_REGRESSION_CASES[i].ecc;
+        uint8_t modules[qrcode_getBufferSize(version)];
+
+        QRCode qrcode;
+        const int qret = qrcode_initText(&qrcode, modules, version, ecc, QRCODE_REGRESSION_CASES[i].text);
+        if (qret || qrcode.mask != QRCODE_REGRESSION_CASES[i].mask) {
+            FAIL();
+        }
+
+        // FNV-1a hash of the module grid
+        uint32_t hash = 2166136261;
+        for (size_t j = 0; j < sizeof(modules); ++j) {
+            hash = (hash ^ modules[j]) * 16777619;
+        }
+        if (hash != QRCODE_REGRESSION_CASES[i].modules_hash) {
+            FAIL();
+        }
+    }
+    return true;
+}
+
+// Feed 'num_frames' frames of the given mean brightness, and return the number of changes requested
+static size_t feed_exposure_frames(camera_exposure_state_t* state, const uint8_t mean, const size_t num_frames)
+{
+    size_t num_changes = 0;
+    for (size_t i = 0; i < num_frames; ++i) {
+        num_changes += camera_exposure_update(state, mean) != CAMERA_EXPOSURE_NO_CHANGE;
+    }
+    return num_changes;
+}
+
+// Test the camera exposure switching logic
+static bool test_camera_exposure(void)
+{
+    const uint8_t dark = CAMERA_EXPOSURE_DARK_MEAN - 1;
+    const uint8_t bright = CAMERA_EXPOSURE_BRIGHT_MEAN + 1;
+    const uint8_t good = (CAMERA_EXPOSURE_DARK_MEAN + CAMERA_EXPOSURE_BRIGHT_MEAN) / 2;
+
+    // Initialised from the sensor's current settings (clamped)
+    camera_exposure_state_t state;
+    camera_exposure_init(&state, 1, 2);
+    if (state.ae_level != 1 || state.gainceiling != 2) {
+        FAIL();
+    }
+
+    // No change until enough consecutive out-of-band frames, and a good frame resets the count
+    if (feed_exposure_frames(&state, dark, CAMERA_EXPOSURE_ADJUST_FRAMES - 1)
+        || feed_exposure_frames(&state, good, 1)
+        || feed_exposure_frames(&state, dark, CAMERA_EXPOSURE_ADJUST_FRAMES - 1)) {
+        FAIL();
+    }
+
+    // Alternating dark and bright frames never trigger a change
+    for (size_t i = 0; i < 4 * CAMERA_EXPOSURE_ADJUST_FRAMES; ++i) {
+        if (camera_exposure_update(&state, i % 2 ? dark : bright) != CAMERA_EXPOSURE_NO_CHANGE) {
+            FAIL();
+        }
+    }
+
+    // Consistently dark raises the ae-level to the maximum first, then the gain ceiling
+    if (feed_exposure_frames(&state, dark, CAMERA_EXPOSURE_ADJUST_FRAMES) != 1 || state.ae_level != 2
+        || state.gainceiling != 2) {
+        FAIL();
+    }
+    if (camera_exposure_update(&state, dark) != CAMERA_EXPOSURE_NO_CHANGE
+        || feed_exposure_frames(&state, dark, CAMERA_EXPOSURE_ADJUST_FRAMES - 1) != 1 || state.ae_level != 2
+        || state.gainceiling != 3) {
+        FAIL();
+    }
+
+    // ... up to the limits, after which no more changes are requested
+    feed_exposure_frames(&state, dark, 16 * CAMERA_EXPOSURE_ADJUST_FRAMES);
+    if (state.ae_level != CAMERA_AE_LEVEL_MAX || state.gainceiling != CAMERA_GAINCEILING_MAX
+        || feed_exposure_frames(&state, dark, 4 * CAMERA_EXPOSURE_ADJUST_FRAMES)) {
+        FAIL();
+    }
+
+    // Frames within the band leave the settings unchanged
+    if (feed_exposure_frames(&state, good, 4 * CAMERA_EXPOSURE_ADJUST_FRAMES)) {
+        FAIL();
+    }
+
+    // Consistently bright undoes the raised gain ceiling first, then lowers the ae-level
+    const size_t gain_steps = CAMERA_GAINCEILING_MAX - 2;
+    if (feed_exposure_frames(&state, bright, gain_steps * CAMERA_EXPOSURE_ADJUST_FRAMES) != gain_steps
+        || state.gainceiling != 2 || state.ae_level != CAMERA_AE_LEVEL_MAX) {
+        FAIL();
+    }
+    feed_exposure_frames(&state, bright, 16 * CAMERA_EXPOSURE_ADJUST_FRAMES);
+    if (state.gainceiling != 2 || state.ae_level != CAMERA_AE_LEVEL_MIN) {
+        FAIL();
+    }
+    return true;
+}
+
+// Reference (pixel-at-a-time) rendering of a qrcode pixel, as the original icon implementations
+static bool qrcode_reference_pixel(QRCode* qrcode, const uint8_t scale, const uint8_t orig_x, const uint8_t orig_y,
+    const uint16_t icon_size, const bool show_grid, const uint16_t x, const uint16_t y)
+{
+    bool paint = qrcode_getModule(qrcode, orig_x + x / scale, orig_y + y / scale);
+    if (show_grid) {
+        const bool gridline = (x == icon_size - 1) || (x % scale == 0) || (y == icon_size - 1) || (y % scale == 0);
+        paint = (paint != gridline);
+    }
+    return paint;
+}
+
+static bool icon_matches_reference(QRCode* qrcode, const Icon* icon, const uint8_t scale, const uint8_t orig_x,
+    const uint8_t orig_y, const bool show_grid)
+{
+    // NOTE: any bits in the final word beyond the icon pixels must be clear
+    const size_t num_pixels = icon->width * icon->height;
+    for (size_t pixel = 0; pixel < (num_pixels / 32 + 1) * 32; ++pixel) {
+        const bool expected = pixel < num_pixels
+            && qrcode_reference_pixel(qrcode, scale, orig_x, orig_y, icon->width, show_grid, pixel % icon->width,
+                pixel / icon->width);
+        if (((icon->data[pixel / 32] >> (pixel % 32)) & 1) != expected) {
+            JADE_LOGE("Icon pixel %u mismatch", pixel);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Test the word-at-a-time icon rendering matches a pixel-at-a-time reference rendering
+static bool test_qrcode_icons(void)
+{
+    for (uint8_t version = 1; version <= 6; ++version) {
+        uint8_t modules[qrcode_getBufferSize(version)];
+        QRCode qrcode;
+        const int qret = qrcode_initText(&qrcode, modules, version, ECC_LOW, "HELLO WORLD 0123456789");
+        if (qret) {
+            FAIL();
+        }
+
+        // Whole qrcode icons, at scales covering both table-driven and word-chunked expansion
+        const uint8_t scales[] = { 1, 3, 4, 7, 8, 9, 33 };
+        for (size_t i = 0; i < sizeof(scales); ++i) {
+            Icon icon = { 0 };
+            qrcode_toIcon(&qrcode, &icon, scales[i]);
+            const bool matches = icon_matches_reference(&qrcode, &icon, scales[i], 0, 0, false);
+            qrcode_freeIcon(&icon);
+            if (!matches) {
+                FAIL();
+            }
+        }
+
+        // Fragment icons, as used for the v1/v2 'qr-mnemonic' display, with and without grid-lines
+        if (version <= 2) {
+            const uint8_t fragments_per_side = version == 1 ? 3 : 5;
+            const uint8_t fragment_size = qrcode.size / fragments_per_side;
+            for (uint8_t grid = 0; grid < 2; ++grid) {
+                Icon* icons = NULL;
+                size_t num_icons = 0;
+                if (!qrcode_toFragmentsIcons(&qrcode, 105, grid, &icons, &num_icons)
+                    || num_icons != fragments_per_side * fragments_per_side) {
+                    FAIL();
+                }
+                bool matches = true;
+                for (size_t i = 0; i < num_icons; ++i) {
+                    const uint8_t scale = icons[i].width / fragment_size;
+                    matches = matches
+                        && icon_matches_reference(&qrcode, icons + i, scale, (i % fragments_per_side) * fragment_size,
+                            (i / fragments_per_side) * fragment_size, grid);
+                    qrcode_freeIcon(icons + i);
+                }
+                free(icons);
+                if (!matches) {
+                    FAIL();
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Test we can stream bcur fragment icons, rendered on demand, well past the 'pure' fragments
+static bool test_bcur_icon_stream(void)
+{
+    const uint8_t payload[8 * 8 * 8];
+    const uint8_t qr_version = 6;
+    Icon first_icon = { 0 };
+    bcur_icon_stream_t* stream = NULL;
+    size_t num_fragments = 0;
+    bcur_create_qr_icon_stream(
+        payload, sizeof(payload), "test-type", qr_version, &stream, &first_icon, &num_fragments);
+    if (!stream || !first_icon.data || num_fragments < 2) {
+        FAIL();
+    }
+
+    // Pull more icons than there are pure fragments, and check they are all the same size
+    for (size_t i = 0; i < 32; ++i) {
+        Icon icon = { 0 };
+        size_t retries = 0;
+        while (!bcur_icon_stream_next(stream, &icon)) {
+            if (++retries > 100) {
+                bcur_free_icon_stream(stream);
+                FAIL();
+            }
+            vTaskDelay(10 / portTICK_PERIOD_MS);
+        }
+        if (!icon.data || icon.width != first_icon.width || icon.height != first_icon.height) {
+            bcur_free_icon_stream(stream);
+            FAIL();
+        }
+    }
+    bcur_free_icon_stream(stream);
+    return true;
+}
+
 #ifdef CONFIG_ESP32_SPIRAM_SUPPORT
 // Test we can render a sequence of up to 1000 bcur fragments
 static bool test_bcur_large_payload_many_icons(void)
@@ -819,6 +1062,34 @@ bool debug_selfcheck(void)
         FAIL();
     }
 
+    // Test qrcode encoding is unchanged
+    if (!test_qrcode_regression()) {
+        FAIL();
+    }
+
+    // Test qrcode icon rendering
+    if (!test_qrcode_icons()) {
+        FAIL();
+    }
+
+    // Test camera exposure control switching
+    if (!test_camera_exposure()) {
+        FAIL();
+    }
+
+    // Test we can stream bcur fragment icons rendered on demand
+    if (!test_bcur_icon_stream()) {
+        FAIL();
+    }
+
+#ifdef CONFIG_DEBUG_MODE
+    // Test the icon stream restarts its encoder when fragments outgrow the qr
+    bool bcur_check_icon_stream_restart(void);
+    if (!bcur_check_icon_stream_restart()) {
+        FAIL();
+    }
+#endif
+
 #ifdef CONFIG_ESP32_SPIRAM_SUPPORT
     // Test we can render a large sequence of bcur fragments (smallest supported qr version)
     if (!test_bcur_large_payload_many_icons()) {
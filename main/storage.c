@@ -4,6 +4,8 @@
 
 #include <ctype.h>
 #include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include <nvs_flash.h>
 #include <string.h>
 #include <wally_crypto.h>
@@ -15,6 +17,7 @@ static const char* NVS_KEYS_PARTITION_LABEL = "nvs_key";
 
 static const char* DEFAULT_NAMESPACE = "PIN";
 static const char* MULTISIG_NAMESPACE = "MULTISIGS";
+static const char* MULTISIG_INDEX_NAMESPACE = "MULTISIGIDX";
 static const char* OTP_NAMESPACE = "OTP";
 static const char* HOTP_COUNTERS_NAMESPACE = "HOTPC";
 
@@ -24,6 +27,8 @@ static const char* BLOB_FIELD = "blob";
 static const char* KEY_FLAGS_FIELD = "keyflags";
 static const char* WALLET_ERASE_PIN = "walleterasepin";
 
+static const char* MULTISIG_INDEX_FIELD = "index";
+
 static const char* USER_PINSERVER_URL_A = "pinsvrurlA";
 static const char* USER_PINSERVER_URL_B = "pinsvrurlB";
 static const char* USER_PINSERVER_PUBKEY = "pinsvrpubkey";
@@ -42,101 +47,164 @@ static const char* QR_FLAGS_FIELD = "qrflags";
 static const size_t NUM_ALL_NVS_ENTRIES = 504;
 static const size_t NUM_ESP_RESERVED_ENTRIES = 126;
 
+// Long-lived nvs handles, one per namespace, opened on first use and kept open.
+typedef struct {
+    const char* name;
+    nvs_handle handle;
+    bool open;
+} storage_namespace_t;
+
+#define NUM_STORAGE_NAMESPACES 5
+static storage_namespace_t namespaces[NUM_STORAGE_NAMESPACES];
+
+// Protects the namespace handles
+static SemaphoreHandle_t storage_mutex = NULL;
+
+// Write-through RAM cache of small, frequently read settings - loaded once at init
+static struct {
+    network_type_t network_type;
+    uint16_t idle_timeout;
+    uint16_t qr_flags;
+    uint8_t brightness;
+    uint8_t click_event;
+    uint8_t ble_flags;
+    uint8_t key_flags;
+} settings;
+
+// Get the namespace record - opening the handle if not already open
+static storage_namespace_t* get_namespace(const char* ns)
+{
+    JADE_ASSERT(ns);
+    JADE_ASSERT(storage_mutex);
+
+    storage_namespace_t* nsp = NULL;
+    for (size_t i = 0; i < NUM_STORAGE_NAMESPACES && !nsp; ++i) {
+        if (namespaces[i].name == ns || !strcmp(namespaces[i].name, ns)) {
+            nsp = namespaces + i;
+        }
+    }
+    JADE_ASSERT_MSG(nsp, "Unknown storage namespace %s", ns);
+
+    JADE_SEMAPHORE_TAKE(storage_mutex);
+    if (!nsp->open) {
+        const esp_err_t err = nvs_open(nsp->name, NVS_READWRITE, &nsp->handle);
+        if (err == ESP_OK) {
+            nsp->open = true;
+        } else {
+            JADE_LOGE("nvs_open() for %s failed: %u", nsp->name, err);
+        }
+    }
+    JADE_SEMAPHORE_GIVE(storage_mutex);
+
+    return nsp->open ? nsp : NULL;
+}
+
+// Commit changes to nvs
+static bool commit_namespace(storage_namespace_t* nsp)
+{
+    JADE_ASSERT(nsp);
+
+    const esp_err_t err = nvs_commit(nsp->handle);
+    if (err != ESP_OK) {
+        JADE_LOGE("nvs_commit() for %s failed: %u", nsp->name, err);
+        return false;
+    }
+    return true;
+}
+
+// Close all namespace handles (eg. before erasing the nvs partition)
+static void close_namespaces(void)
+{
+    JADE_SEMAPHORE_TAKE(storage_mutex);
+    for (size_t i = 0; i < NUM_STORAGE_NAMESPACES; ++i) {
+        if (namespaces[i].open) {
+            nvs_close(namespaces[i].handle);
+            namespaces[i].open = false;
+        }
+    }
+    JADE_SEMAPHORE_GIVE(storage_mutex);
+}
+
 // Building block macros for the store/read/erase functions.
-// They all close the storage and return false on any error.
+// They all return false on any error.
 
-// Macro open nvs before a read or write
-#define STORAGE_OPEN(h, ns, rwflags)                                                                                   \
+// Macro to fetch the long-lived nvs handle for a namespace before a read or write
+#define STORAGE_OPEN(nsp, ns)                                                                                          \
     do {                                                                                                               \
-        const esp_err_t err = nvs_open(ns, rwflags, &h);                                                               \
-        if (err != ESP_OK) {                                                                                           \
-            JADE_LOGE("nvs_open() for %s failed: %u", ns, err);                                                        \
+        nsp = get_namespace(ns);                                                                                       \
+        if (!nsp) {                                                                                                    \
             return false;                                                                                              \
         }                                                                                                              \
     } while (false)
 
 // Macro to persist a known-length blob to nvs
-#define STORAGE_SET_BLOB(h, k, v, l)                                                                                   \
+#define STORAGE_SET_BLOB(nsp, k, v, l)                                                                                 \
     do {                                                                                                               \
-        const esp_err_t err = nvs_set_blob(h, k, v, l);                                                                \
+        const esp_err_t err = nvs_set_blob(nsp->handle, k, v, l);                                                      \
         if (err != ESP_OK) {                                                                                           \
             JADE_LOGE("nvs_set_blob() for %s failed: %u", k, err);                                                     \
-            nvs_close(h);                                                                                              \
             return false;                                                                                              \
         }                                                                                                              \
     } while (false)
 
 // Macro to persist a nul terminated string to nvs
-#define STORAGE_SET_STRING(h, k, v)                                                                                    \
+#define STORAGE_SET_STRING(nsp, k, v)                                                                                  \
     do {                                                                                                               \
-        const esp_err_t err = nvs_set_str(h, k, v);                                                                    \
+        const esp_err_t err = nvs_set_str(nsp->handle, k, v);                                                          \
         if (err != ESP_OK) {                                                                                           \
             JADE_LOGE("nvs_set_str() for %s failed: %u", k, err);                                                      \
-            nvs_close(h);                                                                                              \
             return false;                                                                                              \
         }                                                                                                              \
     } while (false)
 
 // Macro to fetch a variable-length blob from nvs
-#define STORAGE_GET_BLOB(h, k, v, l, pw)                                                                               \
+#define STORAGE_GET_BLOB(nsp, k, v, l, pw)                                                                             \
     do {                                                                                                               \
         *pw = l;                                                                                                       \
-        const esp_err_t err = nvs_get_blob(h, k, v, pw);                                                               \
+        const esp_err_t err = nvs_get_blob(nsp->handle, k, v, pw);                                                     \
         if (err != ESP_OK) {                                                                                           \
             if (err == ESP_ERR_NVS_NOT_FOUND) {                                                                        \
                 JADE_LOGI("nvs_get_blob() for %s - not found", k);                                                     \
             } else {                                                                                                   \
                 JADE_LOGE("nvs_get_blob() for %s failed: %u", k, err);                                                 \
             }                                                                                                          \
-            nvs_close(h);                                                                                              \
             return false;                                                                                              \
         }                                                                                                              \
     } while (false)
 
 // Macro to fetch a nul terminated string from nvs
-#define STORAGE_GET_STRING(h, k, v, l, pw)                                                                             \
+#define STORAGE_GET_STRING(nsp, k, v, l, pw)                                                                           \
     do {                                                                                                               \
         *pw = l;                                                                                                       \
-        const esp_err_t err = nvs_get_str(h, k, v, pw);                                                                \
+        const esp_err_t err = nvs_get_str(nsp->handle, k, v, pw);                                                      \
         if (err != ESP_OK) {                                                                                           \
             if (err == ESP_ERR_NVS_NOT_FOUND) {                                                                        \
                 JADE_LOGI("nvs_get_str() for %s - not found", k);                                                      \
             } else {                                                                                                   \
                 JADE_LOGE("nvs_get_str() for %s failed: %u", k, err);                                                  \
             }                                                                                                          \
-            nvs_close(h);                                                                                              \
             return false;                                                                                              \
         }                                                                                                              \
     } while (false)
 
 // Macro to erase an keyed entry from nvs
-#define STORAGE_ERASE(h, k)                                                                                            \
+#define STORAGE_ERASE(nsp, k)                                                                                          \
     do {                                                                                                               \
-        const esp_err_t err = nvs_erase_key(h, k);                                                                     \
+        const esp_err_t err = nvs_erase_key(nsp->handle, k);                                                           \
         if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {                                                           \
             JADE_LOGE("nvs_erase_key() for %s failed: %u", k, err);                                                    \
-            nvs_close(h);                                                                                              \
             return false;                                                                                              \
         }                                                                                                              \
     } while (false)
 
 // Macro to commit changes to nvs after one or more updates/erasures
-#define STORAGE_COMMIT(h)                                                                                              \
+#define STORAGE_COMMIT(nsp)                                                                                            \
     do {                                                                                                               \
-        const esp_err_t err = nvs_commit(h);                                                                           \
-        if (err != ESP_OK) {                                                                                           \
-            JADE_LOGE("nvs_commit() failed: %u", err);                                                                 \
-            nvs_close(h);                                                                                              \
+        if (!commit_namespace(nsp)) {                                                                                  \
             return false;                                                                                              \
         }                                                                                                              \
     } while (false)
 
-// Common code to close nvs after access
-#define STORAGE_CLOSE(h)                                                                                               \
-    do {                                                                                                               \
-        nvs_close(h);                                                                                                  \
-    } while (false)
-
 static bool store_blob(const char* ns, const char* name, const uint8_t* data, const size_t len)
 {
     JADE_ASSERT(ns);
@@ -144,11 +212,10 @@ static bool store_blob(const char* ns, const char* name, const uint8_t* data, co
     JADE_ASSERT(data);
     JADE_ASSERT(len > 0);
 
-    nvs_handle handle;
-    STORAGE_OPEN(handle, ns, NVS_READWRITE);
-    STORAGE_SET_BLOB(handle, name, data, len);
-    STORAGE_COMMIT(handle);
-    STORAGE_CLOSE(handle);
+    storage_namespace_t* nsp;
+    STORAGE_OPEN(nsp, ns);
+    STORAGE_SET_BLOB(nsp, name, data, len);
+    STORAGE_COMMIT(nsp);
     return true;
 }
 
@@ -160,10 +227,9 @@ static bool read_blob(const char* ns, const char* name, uint8_t* data, const siz
     JADE_ASSERT(len > 0);
     JADE_INIT_OUT_SIZE(written);
 
-    nvs_handle handle;
-    STORAGE_OPEN(handle, ns, NVS_READONLY);
-    STORAGE_GET_BLOB(handle, name, data, len, written);
-    STORAGE_CLOSE(handle);
+    storage_namespace_t* nsp;
+    STORAGE_OPEN(nsp, ns);
+    STORAGE_GET_BLOB(nsp, name, data, len, written);
     return true;
 }
 
@@ -186,11 +252,10 @@ static bool store_string(const char* ns, const char* name, const char* str)
     JADE_ASSERT(name);
     JADE_ASSERT(str);
 
-    nvs_handle handle;
-    STORAGE_OPEN(handle, ns, NVS_READWRITE);
-    STORAGE_SET_STRING(handle, name, str);
-    STORAGE_COMMIT(handle);
-    STORAGE_CLOSE(handle);
+    storage_namespace_t* nsp;
+    STORAGE_OPEN(nsp, ns);
+    STORAGE_SET_STRING(nsp, name, str);
+    STORAGE_COMMIT(nsp);
     return true;
 }
 
@@ -202,10 +267,9 @@ static bool read_string(const char* ns, const char* name, char* str, const size_
     JADE_ASSERT(len > 0);
     JADE_INIT_OUT_SIZE(written);
 
-    nvs_handle handle;
-    STORAGE_OPEN(handle, ns, NVS_READONLY);
-    STORAGE_GET_STRING(handle, name, str, len, written);
-    STORAGE_CLOSE(handle);
+    storage_namespace_t* nsp;
+    STORAGE_OPEN(nsp, ns);
+    STORAGE_GET_STRING(nsp, name, str, len, written);
     return true;
 }
 
@@ -214,11 +278,10 @@ static bool erase_key(const char* ns, const char* name)
     JADE_ASSERT(ns);
     JADE_ASSERT(name);
 
-    nvs_handle handle;
-    STORAGE_OPEN(handle, ns, NVS_READWRITE);
-    STORAGE_ERASE(handle, name);
-    STORAGE_COMMIT(handle);
-    STORAGE_CLOSE(handle);
+    storage_namespace_t* nsp;
+    STORAGE_OPEN(nsp, ns);
+    STORAGE_ERASE(nsp, name);
+    STORAGE_COMMIT(nsp);
     return true;
 }
 
@@ -314,8 +377,61 @@ static esp_err_t init_nvs_flash(void)
     return err;
 }
 
+// Load a setting into the RAM cache - only updated if a value of the expected length is read
+static void load_setting(const char* name, void* cached, const size_t len)
+{
+    JADE_ASSERT(cached);
+
+    uint8_t value[sizeof(uint32_t)];
+    JADE_ASSERT(len <= sizeof(value));
+    if (read_blob_fixed(DEFAULT_NAMESPACE, name, value, len)) {
+        memcpy(cached, value, len);
+    }
+}
+
+// Load the RAM cache of settings from nvs - any not present default to zero
+static void load_settings(void)
+{
+    memset(&settings, 0, sizeof(settings));
+    settings.network_type = NETWORK_TYPE_NONE;
+    load_setting(NETWORK_TYPE_FIELD, &settings.network_type, sizeof(settings.network_type));
+    load_setting(IDLE_TIMEOUT_FIELD, &settings.idle_timeout, sizeof(settings.idle_timeout));
+    load_setting(QR_FLAGS_FIELD, &settings.qr_flags, sizeof(settings.qr_flags));
+    load_setting(BRIGHTNESS_FIELD, &settings.brightness, sizeof(settings.brightness));
+    load_setting(CLICK_EVENT_FIELD, &settings.click_event, sizeof(settings.click_event));
+    load_setting(BLE_FLAGS_FIELD, &settings.ble_flags, sizeof(settings.ble_flags));
+    load_setting(KEY_FLAGS_FIELD, &settings.key_flags, sizeof(settings.key_flags));
+}
+
+// Write-through a setting to the RAM cache and to nvs - unchanged values are not rewritten
+static bool store_setting(const char* name, void* cached, const void* value, const size_t len)
+{
+    JADE_ASSERT(cached);
+    JADE_ASSERT(value);
+
+    if (!memcmp(cached, value, len)) {
+        return true;
+    }
+    if (!store_blob(DEFAULT_NAMESPACE, name, value, len)) {
+        return false;
+    }
+    memcpy(cached, value, len);
+    return true;
+}
+
 bool storage_init(void)
 {
+    if (!storage_mutex) {
+        storage_mutex = xSemaphoreCreateMutex();
+        JADE_ASSERT(storage_mutex);
+
+        namespaces[0].name = DEFAULT_NAMESPACE;
+        namespaces[1].name = MULTISIG_NAMESPACE;
+        namespaces[2].name = OTP_NAMESPACE;
+        namespaces[3].name = HOTP_COUNTERS_NAMESPACE;
+        namespaces[4].name = MULTISIG_INDEX_NAMESPACE;
+    }
+
     esp_err_t err = init_nvs_flash();
 
     if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -329,12 +445,23 @@ bool storage_init(void)
     }
 
     esp_log_level_set("nvs", ESP_LOG_ERROR);
-    return err == ESP_OK;
+    if (err != ESP_OK) {
+        return false;
+    }
+
+    // NOTE: namespace handles are opened on first use, and then held open
+    load_settings();
+    return true;
 }
 
 // Erase flash
 bool storage_erase(void)
 {
+    // Handles are invalidated by the erase, as is the cache of settings
+    close_namespaces();
+    memset(&settings, 0, sizeof(settings));
+    settings.network_type = NETWORK_TYPE_NONE;
+
     const esp_err_t err = nvs_flash_erase();
     if (err != ESP_OK) {
         JADE_LOGE("nvs_flash_erase() failed: %u", err);
@@ -477,17 +604,16 @@ bool storage_set_pinserver_details(const char* urlA, const char* urlB, const uin
     JADE_ASSERT(urlB);
 
     // Commit all values, or none
-    nvs_handle handle;
-    STORAGE_OPEN(handle, DEFAULT_NAMESPACE, NVS_READWRITE);
-    STORAGE_SET_STRING(handle, USER_PINSERVER_URL_A, urlA);
-    STORAGE_SET_STRING(handle, USER_PINSERVER_URL_B, urlB);
+    storage_namespace_t* nsp;
+    STORAGE_OPEN(nsp, DEFAULT_NAMESPACE);
+    STORAGE_SET_STRING(nsp, USER_PINSERVER_URL_A, urlA);
+    STORAGE_SET_STRING(nsp, USER_PINSERVER_URL_B, urlB);
 
     // Pubkey is optional (as just server public address may change)
     if (pubkey && pubkey_len > 0) {
-        STORAGE_SET_BLOB(handle, USER_PINSERVER_PUBKEY, pubkey, pubkey_len);
+        STORAGE_SET_BLOB(nsp, USER_PINSERVER_PUBKEY, pubkey, pubkey_len);
     }
-    STORAGE_COMMIT(handle);
-    STORAGE_CLOSE(handle);
+    STORAGE_COMMIT(nsp);
     return true;
 }
 
@@ -509,13 +635,12 @@ bool storage_get_pinserver_pubkey(uint8_t* pubkey, const size_t pubkey_len)
 bool storage_erase_pinserver_details(void)
 {
     // Erase all of the pinserver fields, or none of them
-    nvs_handle handle;
-    STORAGE_OPEN(handle, DEFAULT_NAMESPACE, NVS_READWRITE);
-    STORAGE_ERASE(handle, USER_PINSERVER_URL_A);
-    STORAGE_ERASE(handle, USER_PINSERVER_URL_B);
-    STORAGE_ERASE(handle, USER_PINSERVER_PUBKEY);
-    STORAGE_COMMIT(handle);
-    STORAGE_CLOSE(handle);
+    storage_namespace_t* nsp;
+    STORAGE_OPEN(nsp, DEFAULT_NAMESPACE);
+    STORAGE_ERASE(nsp, USER_PINSERVER_URL_A);
+    STORAGE_ERASE(nsp, USER_PINSERVER_URL_B);
+    STORAGE_ERASE(nsp, USER_PINSERVER_PUBKEY);
+    STORAGE_COMMIT(nsp);
     return true;
 }
 
@@ -528,84 +653,55 @@ bool storage_get_pinserver_cert(char* cert, const size_t len, size_t* written)
 
 bool storage_erase_pinserver_cert(void) { return erase_key(DEFAULT_NAMESPACE, USER_PINSERVER_CERT); }
 
+// Settings are served from the RAM cache, and written-through to nvs
 bool storage_set_network_type_restriction(network_type_t networktype)
 {
-    return store_blob(DEFAULT_NAMESPACE, NETWORK_TYPE_FIELD, (uint8_t*)&networktype, sizeof(networktype));
+    return store_setting(NETWORK_TYPE_FIELD, &settings.network_type, &networktype, sizeof(networktype));
 }
 
-network_type_t storage_get_network_type_restriction(void)
-{
-    network_type_t networktype = NETWORK_TYPE_NONE;
-    return read_blob_fixed(DEFAULT_NAMESPACE, NETWORK_TYPE_FIELD, (uint8_t*)&networktype, sizeof(networktype))
-        ? networktype
-        : NETWORK_TYPE_NONE;
-}
+network_type_t storage_get_network_type_restriction(void) { return settings.network_type; }
 
 bool storage_set_idle_timeout(uint16_t timeout)
 {
-    return store_blob(DEFAULT_NAMESPACE, IDLE_TIMEOUT_FIELD, (const uint8_t*)&timeout, sizeof(timeout));
+    return store_setting(IDLE_TIMEOUT_FIELD, &settings.idle_timeout, &timeout, sizeof(timeout));
 }
 
-uint16_t storage_get_idle_timeout(void)
-{
-    uint16_t timeout = 0;
-    return read_blob_fixed(DEFAULT_NAMESPACE, IDLE_TIMEOUT_FIELD, (uint8_t*)&timeout, sizeof(timeout)) ? timeout : 0;
-}
+uint16_t storage_get_idle_timeout(void) { return settings.idle_timeout; }
 
 bool storage_set_brightness(uint8_t brightness)
 {
-    return store_blob(DEFAULT_NAMESPACE, BRIGHTNESS_FIELD, &brightness, sizeof(brightness));
+    return store_setting(BRIGHTNESS_FIELD, &settings.brightness, &brightness, sizeof(brightness));
 }
 
-uint8_t storage_get_brightness(void)
-{
-    uint8_t brightness = 0;
-    return read_blob_fixed(DEFAULT_NAMESPACE, BRIGHTNESS_FIELD, &brightness, sizeof(brightness)) ? brightness : 0;
-}
+uint8_t storage_get_brightness(void) { return settings.brightness; }
 
 bool storage_set_click_event(uint8_t event)
 {
-    return store_blob(DEFAULT_NAMESPACE, CLICK_EVENT_FIELD, &event, sizeof(event));
+    return store_setting(CLICK_EVENT_FIELD, &settings.click_event, &event, sizeof(event));
 }
 
-uint8_t storage_get_click_event(void)
-{
-    uint8_t event = 0;
-    return read_blob_fixed(DEFAULT_NAMESPACE, CLICK_EVENT_FIELD, &event, sizeof(event)) ? event : 0;
-}
+uint8_t storage_get_click_event(void) { return settings.click_event; }
 
 bool storage_set_ble_flags(uint8_t flags)
 {
-    return store_blob(DEFAULT_NAMESPACE, BLE_FLAGS_FIELD, &flags, sizeof(flags));
+    return store_setting(BLE_FLAGS_FIELD, &settings.ble_flags, &flags, sizeof(flags));
 }
 
-uint8_t storage_get_ble_flags(void)
-{
-    uint8_t flags = 0;
-    return read_blob_fixed(DEFAULT_NAMESPACE, BLE_FLAGS_FIELD, &flags, sizeof(flags)) ? flags : 0;
-}
+uint8_t storage_get_ble_flags(void) { return settings.ble_flags; }
 
 bool storage_set_qr_flags(uint16_t flags)
 {
-    return store_blob(DEFAULT_NAMESPACE, QR_FLAGS_FIELD, (const uint8_t*)&flags, sizeof(flags));
+    return store_setting(QR_FLAGS_FIELD, &settings.qr_flags, &flags, sizeof(flags));
 }
 
-uint16_t storage_get_qr_flags(void)
-{
-    uint16_t flags = 0;
-    return read_blob_fixed(DEFAULT_NAMESPACE, QR_FLAGS_FIELD, (uint8_t*)&flags, sizeof(flags)) ? flags : 0;
-}
+uint16_t storage_get_qr_flags(void) { return settings.qr_flags; }
 
 bool storage_set_key_flags(uint8_t flags)
 {
-    return store_blob(DEFAULT_NAMESPACE, KEY_FLAGS_FIELD, &flags, sizeof(flags));
+    return store_setting(KEY_FLAGS_FIELD, &settings.key_flags, &flags, sizeof(flags));
 }
 
-uint8_t storage_get_key_flags(void)
-{
-    uint8_t flags = 0;
-    return read_blob_fixed(DEFAULT_NAMESPACE, KEY_FLAGS_FIELD, &flags, sizeof(flags)) ? flags : 0;
-}
+uint8_t storage_get_key_flags(void) { return settings.key_flags; }
 
 bool storage_set_wallet_erase_pin(const uint8_t* pin, const size_t pin_len)
 {
@@ -643,6 +739,19 @@ bool storage_get_all_multisig_registration_names(
 
 bool storage_erase_multisig_registration(const char* name) { return erase_key(MULTISIG_NAMESPACE, name); }
 
+// The compact index of multisig registrations, held in its own namespace
+bool storage_set_multisig_index(const uint8_t* index, const size_t index_len)
+{
+    return store_blob(MULTISIG_INDEX_NAMESPACE, MULTISIG_INDEX_FIELD, index, index_len);
+}
+
+bool storage_get_multisig_index(uint8_t* index, const size_t index_len, size_t* written)
+{
+    return read_blob(MULTISIG_INDEX_NAMESPACE, MULTISIG_INDEX_FIELD, index, index_len, written);
+}
+
+bool storage_erase_multisig_index(void) { return erase_key(MULTISIG_INDEX_NAMESPACE, MULTISIG_INDEX_FIELD); }
+
 // HOTP / TOTP
 bool storage_set_otp_data(const char* name, const uint8_t* data, const size_t data_len)
 {
@@ -90,6 +90,10 @@ bool storage_get_all_multisig_registration_names(
 
 bool storage_erase_multisig_registration(const char* name);
 
+bool storage_set_multisig_index(const uint8_t* index, size_t index_len);
+bool storage_get_multisig_index(uint8_t* index, size_t index_len, size_t* written);
+bool storage_erase_multisig_index(void);
+
 // HOTP / TOTP
 bool storage_set_otp_data(const char* name, const uint8_t* data, size_t data_len);
 bool storage_get_otp_data(const char* name, uint8_t* data, size_t data_len, size_t* written);
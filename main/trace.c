@@ -0,0 +1,180 @@
+#include "trace.h"
+#include "jade_assert.h"
+#include "utils/cbor_rpc.h"
+#include "utils/malloc_ext.h"
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <string.h>
+
+#ifdef CONFIG_DEBUG_MODE
+// Number of events held - the oldest are overwritten when full
+// NOTE: must be a power of two, so the ring index is unaffected by the write counter wrapping
+#define TRACE_RING_SIZE 1024
+
+// Maximum number of distinct tasks recorded - any more are reported as an 'unknown' task
+#define TRACE_MAX_TASKS 24
+
+typedef struct {
+    // NOTE: only the lower 32-bits of the timer are held - the reader unwraps as required
+    uint32_t ts_us;
+    const char* name;
+    uint8_t task;
+    uint8_t core;
+    uint8_t phase;
+} trace_event_t;
+
+static trace_event_t* trace_ring = NULL;
+static volatile uint32_t trace_next = 0;
+static volatile bool trace_recording = false;
+
+// Tasks seen, by index - entries are written before 'num_trace_tasks' is bumped,
+// so can be searched without taking the lock.
+static TaskHandle_t trace_tasks[TRACE_MAX_TASKS];
+static char trace_task_names[TRACE_MAX_TASKS][configMAX_TASK_NAME_LEN];
+static volatile size_t num_trace_tasks = 0;
+static portMUX_TYPE trace_tasks_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void trace_init(void)
+{
+    JADE_ASSERT(!trace_ring);
+
+    trace_ring = JADE_CALLOC_PREFER_SPIRAM(TRACE_RING_SIZE, sizeof(trace_event_t));
+    trace_recording = true;
+}
+
+static uint8_t get_task_index(void)
+{
+    const TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    for (size_t i = 0; i < num_trace_tasks; ++i) {
+        if (trace_tasks[i] == task) {
+            return i;
+        }
+    }
+
+    // First event from this task - add it
+    taskENTER_CRITICAL(&trace_tasks_lock);
+    size_t i = 0;
+    while (i < num_trace_tasks && trace_tasks[i] != task) {
+        ++i;
+    }
+    if (i == num_trace_tasks && i < TRACE_MAX_TASKS) {
+        trace_tasks[i] = task;
+        strlcpy(trace_task_names[i], pcTaskGetName(NULL), sizeof(trace_task_names[i]));
+        __atomic_store_n(&num_trace_tasks, i + 1, __ATOMIC_RELEASE);
+    }
+    taskEXIT_CRITICAL(&trace_tasks_lock);
+    return i;
+}
+
+void trace_event(const char* name, const trace_phase_t phase)
+{
+    if (!trace_recording) {
+        return;
+    }
+
+    const uint32_t slot = __atomic_fetch_add(&trace_next, 1, __ATOMIC_RELAXED);
+    trace_event_t* const event = &trace_ring[slot % TRACE_RING_SIZE];
+    event->ts_us = (uint32_t)esp_timer_get_time();
+    event->name = name;
+    event->task = get_task_index();
+    event->core = xPortGetCoreID();
+    event->phase = phase;
+}
+
+static size_t num_events_held(void) { return trace_next < TRACE_RING_SIZE ? trace_next : TRACE_RING_SIZE; }
+
+size_t trace_pause(void)
+{
+    JADE_ASSERT(trace_ring);
+
+    if (trace_recording) {
+        trace_recording = false;
+
+        // Let any event being written on the other core complete
+        vTaskDelay(1);
+    }
+    return num_events_held();
+}
+
+void trace_clear_and_resume(void)
+{
+    JADE_ASSERT(trace_ring);
+    JADE_ASSERT(!trace_recording);
+
+    trace_next = 0;
+    trace_recording = true;
+}
+
+static void add_event(CborEncoder* container, const trace_event_t* event)
+{
+    CborEncoder array_encoder;
+    CborError cberr = cbor_encoder_create_array(container, &array_encoder, 5);
+    JADE_ASSERT(cberr == CborNoError);
+
+    cberr = cbor_encode_uint(&array_encoder, event->ts_us);
+    JADE_ASSERT(cberr == CborNoError);
+    cberr = cbor_encode_uint(&array_encoder, event->task);
+    JADE_ASSERT(cberr == CborNoError);
+    cberr = cbor_encode_uint(&array_encoder, event->core);
+    JADE_ASSERT(cberr == CborNoError);
+    cberr = cbor_encode_text_stringz(&array_encoder, event->phase == TRACE_PHASE_BEGIN ? "B" : "E");
+    JADE_ASSERT(cberr == CborNoError);
+    cberr = cbor_encode_text_stringz(&array_encoder, event->name);
+    JADE_ASSERT(cberr == CborNoError);
+
+    cberr = cbor_encoder_close_container(container, &array_encoder);
+    JADE_ASSERT(cberr == CborNoError);
+}
+
+void trace_events_cb(const void* ctx, CborEncoder* container)
+{
+    JADE_ASSERT(ctx);
+    JADE_ASSERT(container);
+    JADE_ASSERT(!trace_recording);
+
+    const size_t index = *(const size_t*)ctx;
+    const size_t total = num_events_held();
+    JADE_ASSERT(index <= total);
+
+    const size_t num_events = total - index < TRACE_EVENTS_PER_PAGE ? total - index : TRACE_EVENTS_PER_PAGE;
+    const uint32_t oldest = trace_next - total;
+
+    CborEncoder map_encoder;
+    CborError cberr = cbor_encoder_create_map(container, &map_encoder, 4);
+    JADE_ASSERT(cberr == CborNoError);
+
+    add_uint_to_map(&map_encoder, "index", index);
+    add_uint_to_map(&map_encoder, "total", total);
+
+    // Task names, by the task index used in the events
+    const size_t num_tasks = num_trace_tasks;
+    cberr = cbor_encode_text_stringz(&map_encoder, "tasks");
+    JADE_ASSERT(cberr == CborNoError);
+    CborEncoder array_encoder;
+    cberr = cbor_encoder_create_array(&map_encoder, &array_encoder, num_tasks);
+    JADE_ASSERT(cberr == CborNoError);
+    for (size_t i = 0; i < num_tasks; ++i) {
+        cberr = cbor_encode_text_stringz(&array_encoder, trace_task_names[i]);
+        JADE_ASSERT(cberr == CborNoError);
+    }
+    cberr = cbor_encoder_close_container(&map_encoder, &array_encoder);
+    JADE_ASSERT(cberr == CborNoError);
+
+    // Each event is written as an array: [timestamp_us, task, core, phase, name]
+    cberr = cbor_encode_text_stringz(&map_encoder, "events");
+    JADE_ASSERT(cberr == CborNoError);
+    cberr = cbor_encoder_create_array(&map_encoder, &array_encoder, num_events);
+    JADE_ASSERT(cberr == CborNoError);
+    for (size_t i = 0; i < num_events; ++i) {
+        add_event(&array_encoder, &trace_ring[(oldest + index + i) % TRACE_RING_SIZE]);
+    }
+    cberr = cbor_encoder_close_container(&map_encoder, &array_encoder);
+    JADE_ASSERT(cberr == CborNoError);
+
+    cberr = cbor_encoder_close_container(container, &map_encoder);
+    JADE_ASSERT(cberr == CborNoError);
+}
+#endif // CONFIG_DEBUG_MODE
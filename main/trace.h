@@ -0,0 +1,44 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <sdkconfig.h>
+
+// Timeline tracing (debug builds only)
+// Begin/end events are written into a preallocated ring from any task, and can be fetched
+// with the 'debug_get_trace' message, and converted to Chrome trace json by jadepy.
+// Event names must be static strings, as they are not copied.
+#ifdef CONFIG_DEBUG_MODE
+#include <cbor.h>
+#include <stddef.h>
+
+// The number of events returned in each 'debug_get_trace' reply
+#define TRACE_EVENTS_PER_PAGE 48
+
+typedef enum { TRACE_PHASE_BEGIN, TRACE_PHASE_END } trace_phase_t;
+
+void trace_init(void);
+void trace_event(const char* name, trace_phase_t phase);
+
+// Stop recording (if not already stopped) so the events held can be fetched.
+// Returns the number of events held.
+size_t trace_pause(void);
+
+// Discard all events and restart recording
+void trace_clear_and_resume(void);
+
+// cbor encoder callback to write a page of (paused) events as a map
+// 'ctx' should point to the size_t index of the first event to write
+void trace_events_cb(const void* ctx, CborEncoder* container);
+
+#define JADE_TRACE_BEGIN(name) trace_event(name, TRACE_PHASE_BEGIN)
+#define JADE_TRACE_END(name) trace_event(name, TRACE_PHASE_END)
+#else
+#define JADE_TRACE_BEGIN(name)                                                                                         \
+    do {                                                                                                               \
+    } while (false)
+#define JADE_TRACE_END(name)                                                                                           \
+    do {                                                                                                               \
+    } while (false)
+#endif // CONFIG_DEBUG_MODE
+
+#endif /* TRACE_H_ */
@@ -50,6 +50,7 @@ typedef struct {
 
     gui_activity_t* activity;
     gui_view_node_t* pin_digit_nodes[PIN_SIZE];
+    wait_event_data_t* event_data;
 
     uint8_t selected_digit;
     uint8_t current_selected_value;
@@ -45,8 +45,7 @@ void make_setup_screen(gui_activity_t** activity_ptr, const char* device_name, c
     const int ret = snprintf(title, sizeof(title), "Setup %s", device_name);
     JADE_ASSERT(ret > 0 && ret < sizeof(title));
 
-    // NOTE: This 'dashboard' screen is created as an 'unmanaged' activity
-    gui_make_activity_ex(activity_ptr, true, title, false);
+    gui_make_activity(activity_ptr, true, title);
 
     gui_view_node_t* vsplit;
     gui_make_vsplit(&vsplit, GUI_SPLIT_RELATIVE, 3, 32, 52, 16);
@@ -142,17 +141,13 @@ void make_connect_qrmode_screen(gui_activity_t** activity_ptr, const char* devic
     add_buttons(vsplit, UI_COLUMN, btns, 3);
 }
 
-// NOTE: This 'dashboard' screen is created as an 'unmanaged' activity, so it is not placed
-// in the list of activities to be freed by 'set_current_activity_ex()' calls.
-// It must be freed by the caller.
 void make_welcome_back_screen(gui_activity_t** activity_ptr, const char* device_name, const char* firmware_version)
 {
     JADE_ASSERT(activity_ptr);
     JADE_ASSERT(device_name);
     JADE_ASSERT(firmware_version);
 
-    // NOTE: This 'dashboard' screen is created as an 'unmanaged' activity
-    gui_make_activity_ex(activity_ptr, true, device_name, false);
+    gui_make_activity(activity_ptr, true, device_name);
 
     gui_view_node_t* vsplit;
     gui_make_vsplit(&vsplit, GUI_SPLIT_RELATIVE, 3, 36, 32, 32);
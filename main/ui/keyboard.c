@@ -131,20 +131,37 @@ static void make_keyboard_screen(link_activity_t* kb_screen_activity, const char
     kb_screen_activity->next_button = btnShift; // If we have one
 }
 
-// NOTE: the kbs and textboxes arrays must be the same length, as given by arrays_len
-void make_keyboard_entry_activity(keyboard_entry_t* kb_entry, const char* title)
+// The keyboard screens are built once and cached (keyed by the keyboards shown), and are rebound to the
+// title and cleared of any previously entered text each time they are used.
+static struct {
+    gui_activity_cache_entry_t cache;
+    gui_view_node_t* textbox_nodes[NUM_KBS];
+} kb_screens;
+
+static uint32_t get_keyboards_cache_key(const keyboard_entry_t* kb_entry)
 {
     JADE_ASSERT(kb_entry);
-    JADE_ASSERT(kb_entry->num_kbs);
-    // title is optional
+    JADE_ASSERT(kb_entry->num_kbs <= NUM_KBS);
+
+    uint32_t key = kb_entry->num_kbs;
+    for (size_t i = 0; i < kb_entry->num_kbs; ++i) {
+        key = key * NUM_KBS + kb_entry->keyboards[i];
+    }
+    return key;
+}
+
+static void make_keyboard_screens(keyboard_entry_t* kb_entry, const char* title, const uint32_t key)
+{
+    JADE_ASSERT(kb_entry);
+    JADE_ASSERT(kb_entry->num_kbs <= GUI_ACTIVITY_CACHE_ENTRY_MAX_ACTIVITIES);
 
     if (kb_entry->num_kbs == 1) {
         // Single kb screen, no need for kb screen 'linking'
         link_activity_t kb_screen_act = {};
         const bool has_next_kb_btn = false;
         make_keyboard_screen(
-            &kb_screen_act, title, kb_entry->keyboards[0], has_next_kb_btn, &kb_entry->textbox_nodes[0]);
-        kb_entry->activity = kb_screen_act.activity;
+            &kb_screen_act, title, kb_entry->keyboards[0], has_next_kb_btn, &kb_screens.textbox_nodes[0]);
+        gui_activity_cache_add(&kb_screens.cache, key, kb_screen_act.activity);
     } else {
         // Chain the loop of kb screen activities
         link_activity_t kb_screen_act = {};
@@ -153,16 +170,38 @@ void make_keyboard_entry_activity(keyboard_entry_t* kb_entry, const char* title)
         const bool has_next_kb_btn = true;
         for (size_t i = 0; i < kb_entry->num_kbs; ++i) {
             make_keyboard_screen(
-                &kb_screen_act, title, kb_entry->keyboards[i], has_next_kb_btn, &kb_entry->textbox_nodes[i]);
+                &kb_screen_act, title, kb_entry->keyboards[i], has_next_kb_btn, &kb_screens.textbox_nodes[i]);
             gui_chain_activities(&kb_screen_act, &act_info);
+            gui_activity_cache_add(&kb_screens.cache, key, kb_screen_act.activity);
         }
 
         // Link the activities in a loop so last->next == first
         kb_screen_act.activity = act_info.first_activity;
         gui_chain_activities(&kb_screen_act, &act_info);
+    }
+}
 
-        kb_entry->activity = act_info.first_activity;
+// NOTE: the kbs and textboxes arrays must be the same length, as given by arrays_len
+void make_keyboard_entry_activity(keyboard_entry_t* kb_entry, const char* title)
+{
+    JADE_ASSERT(kb_entry);
+    JADE_ASSERT(kb_entry->num_kbs);
+    // title is optional
+
+    const uint32_t key = get_keyboards_cache_key(kb_entry);
+    if (gui_activity_cache_lookup(&kb_screens.cache, key)) {
+        // Reuse the cached screens - ensure no text from any prior use is shown
+        for (size_t i = 0; i < kb_entry->num_kbs; ++i) {
+            gui_set_activity_title(kb_screens.cache.activities[i], title ? title : "");
+            gui_update_text(kb_screens.textbox_nodes[i], "");
+        }
+    } else {
+        make_keyboard_screens(kb_entry, title, key);
     }
+    JADE_ASSERT(kb_screens.cache.num_activities == kb_entry->num_kbs);
+
+    kb_entry->activity = kb_screens.cache.activities[0];
+    memcpy(kb_entry->textbox_nodes, kb_screens.textbox_nodes, sizeof(kb_entry->textbox_nodes));
 
     kb_entry->current_kb = 0;
     kb_entry->strdata[0] = '\0';
@@ -240,6 +279,12 @@ void run_keyboard_entry_loop(keyboard_entry_t* kb_entry)
     esp_event_handler_instance_unregister(GUI_BUTTON_EVENT, ESP_EVENT_ANY_ID, ctx);
     free_wait_event_data(wait_data);
 
+    // Blank the textboxes, as the (possibly cached) screens outlive the entry - the typed text is
+    // only returned to the caller (who is responsible for wiping it).
+    for (size_t i = 0; i < kb_entry->num_kbs; ++i) {
+        gui_update_text(kb_entry->textbox_nodes[i], "");
+    }
+
     JADE_ASSERT(kb_entry->len <= kb_entry->max_allowed_len);
     JADE_ASSERT(kb_entry->strdata[kb_entry->len] == '\0' && strlen(kb_entry->strdata) == kb_entry->len);
 }
@@ -4,6 +4,8 @@
 #include "../ui.h"
 #include "../utils/malloc_ext.h"
 
+#include <string.h>
+
 static const char CHAR_BACKSPACE = '|';
 static const char PIN_CHARS[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', CHAR_BACKSPACE };
 static const uint32_t NUM_PIN_CHARS = sizeof(PIN_CHARS) / sizeof(PIN_CHARS[0]);
@@ -40,22 +42,28 @@ static void update_digit_node(pin_insert_t* pin_insert, uint8_t i)
     gui_update_text(pin_insert->pin_digit_nodes[i], str);
 }
 
-void make_pin_insert_activity(pin_insert_t* pin_insert, const char* title, const char* message)
-{
-    JADE_ASSERT(pin_insert);
+// The PIN entry activity is built once and cached, and is rebound to the title and message each time it is used
+static struct {
+    gui_activity_cache_entry_t cache;
+    gui_view_node_t* text_status;
+    gui_view_node_t* pin_digit_nodes[PIN_SIZE];
+    wait_event_data_t* event_data;
+} pin_screen;
 
-    gui_make_activity(&pin_insert->activity, true, title);
+static void make_pin_screen(const char* title, const char* message)
+{
+    gui_activity_t* act = NULL;
+    gui_make_activity(&act, true, title);
 
     gui_view_node_t* vsplit;
     gui_make_vsplit(&vsplit, GUI_SPLIT_RELATIVE, 2, 50, 50);
-    gui_set_parent(vsplit, pin_insert->activity->root_node);
+    gui_set_parent(vsplit, act->root_node);
 
     // first row, message
-    gui_view_node_t* text_status;
-    gui_make_text(&text_status, message, TFT_WHITE);
-    gui_set_parent(text_status, vsplit);
-    gui_set_padding(text_status, GUI_MARGIN_TWO_VALUES, 8, 4);
-    gui_set_align(text_status, GUI_ALIGN_LEFT, GUI_ALIGN_TOP);
+    gui_make_text(&pin_screen.text_status, message, TFT_WHITE);
+    gui_set_parent(pin_screen.text_status, vsplit);
+    gui_set_padding(pin_screen.text_status, GUI_MARGIN_TWO_VALUES, 8, 4);
+    gui_set_align(pin_screen.text_status, GUI_ALIGN_LEFT, GUI_ALIGN_TOP);
 
     // second row, pin spinners
     gui_view_node_t* hsplit;
@@ -63,22 +71,44 @@ void make_pin_insert_activity(pin_insert_t* pin_insert, const char* title, const
     gui_set_margins(hsplit, GUI_MARGIN_ALL_DIFFERENT, 0, 30, 12, 30);
     gui_set_parent(hsplit, vsplit);
 
-    pin_insert->current_selected_value = get_random_pin_digit();
-
     for (size_t i = 0; i < PIN_SIZE; ++i) {
-        pin_insert->pin[i] = 0xFF;
-        pin_insert->digit_status[i] = i == 0 ? SELECTED : EMPTY;
-
         gui_view_node_t* fill;
         gui_make_fill(&fill, TFT_BLACK);
         gui_set_parent(fill, hsplit);
 
-        gui_make_text_font(&pin_insert->pin_digit_nodes[i], "", TFT_WHITE, DEJAVU24_FONT);
-        gui_set_align(pin_insert->pin_digit_nodes[i], GUI_ALIGN_CENTER, GUI_ALIGN_MIDDLE);
-        gui_set_parent(pin_insert->pin_digit_nodes[i], fill);
+        gui_make_text_font(&pin_screen.pin_digit_nodes[i], "", TFT_WHITE, DEJAVU24_FONT);
+        gui_set_align(pin_screen.pin_digit_nodes[i], GUI_ALIGN_CENTER, GUI_ALIGN_MIDDLE);
+        gui_set_parent(pin_screen.pin_digit_nodes[i], fill);
+    }
 
-        update_digit_node(pin_insert, i);
+    // The event-data is reused each time the activity is shown, so is registered once here
+    pin_screen.event_data = gui_activity_make_wait_event_data(act);
+    gui_activity_register_event(act, GUI_EVENT, ESP_EVENT_ANY_ID, sync_wait_event_handler, pin_screen.event_data);
+
+    gui_activity_cache_add(&pin_screen.cache, 0, act);
+}
+
+void make_pin_insert_activity(pin_insert_t* pin_insert, const char* title, const char* message)
+{
+    JADE_ASSERT(pin_insert);
+    JADE_ASSERT(title);
+    JADE_ASSERT(message);
+
+    if (gui_activity_cache_lookup(&pin_screen.cache, 0)) {
+        // Reuse the cached activity, rebinding the text and discarding any stale events
+        gui_set_activity_title(pin_screen.cache.activities[0], title);
+        gui_update_text(pin_screen.text_status, message);
+        reset_wait_event_data(pin_screen.event_data);
+    } else {
+        make_pin_screen(title, message);
     }
+
+    pin_insert->activity = pin_screen.cache.activities[0];
+    pin_insert->event_data = pin_screen.event_data;
+    memcpy(pin_insert->pin_digit_nodes, pin_screen.pin_digit_nodes, sizeof(pin_insert->pin_digit_nodes));
+
+    // Reset the digits and the displayed values
+    clear_current_pin(pin_insert);
 }
 
 static bool next_selected_digit(pin_insert_t* pin_insert)
@@ -159,11 +189,12 @@ void run_pin_entry_loop(pin_insert_t* pin_insert)
 {
     JADE_ASSERT(pin_insert);
     JADE_ASSERT(pin_insert->activity);
+    JADE_ASSERT(pin_insert->event_data);
 
     int32_t ev_id;
     while (true) {
         // wait for a GUI event
-        gui_activity_wait_event(pin_insert->activity, GUI_EVENT, ESP_EVENT_ANY_ID, NULL, &ev_id, NULL, 0);
+        sync_wait_event(GUI_EVENT, ESP_EVENT_ANY_ID, pin_insert->event_data, NULL, &ev_id, NULL, 0);
 
         switch (ev_id) {
         case GUI_WHEEL_LEFT_EVENT:
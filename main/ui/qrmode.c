@@ -295,16 +295,14 @@ void make_qr_options_activity(
     add_buttons(vsplit, UI_ROW, btns, 2);
 }
 
-// NOTE: 'icons' passed in here must be heap-allocated as the gui element takes ownership
-void make_show_qr_activity(gui_activity_t** activity_ptr, const char* title, const char* label, Icon* icons,
-    const size_t num_icons, const size_t frames_per_qr_icon, const bool show_options_button)
+// Common layout for displaying (possibly animated) qr codes - returns the icon node
+static gui_view_node_t* make_show_qr_activity_layout(gui_activity_t** activity_ptr, const char* title,
+    const char* label, const Icon* first_icon, const bool show_options_button)
 {
     JADE_ASSERT(activity_ptr);
     JADE_ASSERT(title);
     JADE_ASSERT(label);
-    JADE_ASSERT(icons);
-    JADE_ASSERT(num_icons);
-    JADE_ASSERT(frames_per_qr_icon || num_icons == 1);
+    JADE_ASSERT(first_icon);
 
     gui_make_activity(activity_ptr, false, NULL);
 
@@ -352,12 +350,48 @@ void make_show_qr_activity(gui_activity_t** activity_ptr, const char* title, con
     gui_set_parent(bg_fill_node, hsplit);
 
     gui_view_node_t* icon_node;
-    gui_make_icon(&icon_node, icons, TFT_BLACK, &TFT_BLOCKSTREAM_QR_PALE);
+    gui_make_icon(&icon_node, first_icon, TFT_BLACK, &TFT_BLOCKSTREAM_QR_PALE);
     gui_set_align(icon_node, GUI_ALIGN_CENTER, GUI_ALIGN_MIDDLE);
     gui_set_parent(icon_node, bg_fill_node);
+
+    return icon_node;
+}
+
+// NOTE: 'icons' passed in here must be heap-allocated as the gui element takes ownership
+void make_show_qr_activity(gui_activity_t** activity_ptr, const char* title, const char* label, Icon* icons,
+    const size_t num_icons, const size_t frames_per_qr_icon, const bool show_options_button)
+{
+    JADE_ASSERT(activity_ptr);
+    JADE_ASSERT(title);
+    JADE_ASSERT(label);
+    JADE_ASSERT(icons);
+    JADE_ASSERT(num_icons);
+    JADE_ASSERT(frames_per_qr_icon || num_icons == 1);
+
+    gui_view_node_t* const icon_node
+        = make_show_qr_activity_layout(activity_ptr, title, label, icons, show_options_button);
     gui_set_icon_animation(icon_node, icons, num_icons, frames_per_qr_icon);
 }
 
+// As above, but icons are fetched on demand from the passed generator.
+// If 'frames_per_qr_icon' is zero only the first icon is displayed, and the generator is not polled.
+// NOTE: the gui element takes ownership of the generator ctx, freed with 'free_ctx' when the activity is freed
+void make_show_qr_stream_activity(gui_activity_t** activity_ptr, const char* title, const char* label,
+    const Icon* first_icon, gui_icon_generator_fn_t generator, void* ctx, free_callback_t free_ctx,
+    const size_t frames_per_qr_icon, const bool show_options_button)
+{
+    JADE_ASSERT(activity_ptr);
+    JADE_ASSERT(title);
+    JADE_ASSERT(label);
+    JADE_ASSERT(first_icon);
+    JADE_ASSERT(generator);
+    JADE_ASSERT(ctx);
+
+    gui_view_node_t* const icon_node
+        = make_show_qr_activity_layout(activity_ptr, title, label, first_icon, show_options_button);
+    gui_set_icon_generator(icon_node, generator, ctx, free_ctx, frames_per_qr_icon);
+}
+
 // NOTE: 'qr_icon' passed in here must be heap-allocated as the gui element takes ownership
 void make_show_qr_help_activity(gui_activity_t** activity_ptr, const char* url, Icon* qr_icon)
 {
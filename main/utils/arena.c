@@ -0,0 +1,121 @@
+#include "arena.h"
+#include "jade_assert.h"
+#include "jade_wally_verify.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utils/malloc_ext.h>
+#include <wally_core.h>
+
+#define ARENA_ALIGNMENT 8
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1))
+
+struct arena_chunk {
+    arena_chunk_t* next;
+    size_t size;
+    size_t used;
+    uint8_t data[] __attribute__((aligned(ARENA_ALIGNMENT)));
+};
+
+static arena_chunk_t* make_chunk(const arena_t* arena, const size_t size)
+{
+    arena_chunk_t* const chunk = (arena->flags & ARENA_PREFER_SPIRAM)
+        ? JADE_MALLOC_PREFER_SPIRAM(sizeof(arena_chunk_t) + size)
+        : JADE_MALLOC(sizeof(arena_chunk_t) + size);
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+void arena_init(arena_t* arena, const size_t chunk_size) { arena_init_ex(arena, chunk_size, 0); }
+
+void arena_init_ex(arena_t* arena, const size_t chunk_size, const uint8_t flags)
+{
+    JADE_ASSERT(arena);
+    JADE_ASSERT(chunk_size >= ARENA_ALIGNMENT);
+
+    arena->chunks = NULL;
+    arena->chunk_size = ARENA_ALIGN(chunk_size);
+    arena->flags = flags;
+}
+
+void* arena_alloc(arena_t* arena, const size_t size)
+{
+    JADE_ASSERT(arena);
+    JADE_ASSERT(arena->chunk_size);
+
+    const size_t aligned = ARENA_ALIGN(size ? size : 1);
+    arena_chunk_t* chunk = arena->chunks;
+
+    if (!chunk || chunk->size - chunk->used < aligned) {
+        if (aligned > arena->chunk_size / 4) {
+            // Large allocations get a chunk of their own, placed behind the current chunk
+            // so any space remaining in that is still available for subsequent allocations.
+            chunk = make_chunk(arena, aligned);
+            if (arena->chunks) {
+                chunk->next = arena->chunks->next;
+                arena->chunks->next = chunk;
+            } else {
+                arena->chunks = chunk;
+            }
+        } else {
+            chunk = make_chunk(arena, arena->chunk_size);
+            chunk->next = arena->chunks;
+            arena->chunks = chunk;
+        }
+    }
+
+    void* const ptr = chunk->data + chunk->used;
+    chunk->used += aligned;
+    JADE_ASSERT(chunk->used <= chunk->size);
+    return ptr;
+}
+
+void* arena_calloc(arena_t* arena, const size_t num, const size_t size)
+{
+    JADE_ASSERT(!size || num <= SIZE_MAX / size);
+    void* const ptr = arena_alloc(arena, num * size);
+    memset(ptr, 0, num * size);
+    return ptr;
+}
+
+char* arena_strdup(arena_t* arena, const char* str)
+{
+    JADE_ASSERT(str);
+    const size_t len = strlen(str) + 1;
+    char* const ptr = arena_alloc(arena, len);
+    memcpy(ptr, str, len);
+    return ptr;
+}
+
+bool arena_owns(const arena_t* arena, const void* ptr)
+{
+    JADE_ASSERT(arena);
+
+    // Walk the chunks (most recent first) - an arena typically holds only a few
+    const uint8_t* const p = ptr;
+    for (const arena_chunk_t* chunk = arena->chunks; p && chunk; chunk = chunk->next) {
+        if (p >= chunk->data && p < chunk->data + chunk->size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void arena_release(arena_t* arena)
+{
+    JADE_ASSERT(arena);
+
+    arena_chunk_t* chunk = arena->chunks;
+    while (chunk) {
+        arena_chunk_t* const next = chunk->next;
+        if (arena->flags & ARENA_WIPE_ON_RELEASE) {
+            JADE_WALLY_VERIFY(wally_bzero(chunk->data, chunk->used));
+        }
+        free(chunk);
+        chunk = next;
+    }
+    arena->chunks = NULL;
+}
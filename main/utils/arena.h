@@ -0,0 +1,35 @@
+#ifndef UTILS_ARENA_H_
+#define UTILS_ARENA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Simple 'bump' allocator - allocations are carved sequentially out of larger chunks of heap,
+// and are never individually freed.  The entire arena is released in one go by arena_release().
+// NOTE: not thread-safe - an arena should only be allocated from by one task at a time.
+typedef struct arena_chunk arena_chunk_t;
+
+typedef struct {
+    arena_chunk_t* chunks;
+    size_t chunk_size;
+    uint8_t flags;
+} arena_t;
+
+// Optional arena behaviours
+#define ARENA_PREFER_SPIRAM 0x01 // chunks allocated from spiram where available
+#define ARENA_WIPE_ON_RELEASE 0x02 // chunks zeroized before being freed
+
+void arena_init(arena_t* arena, size_t chunk_size);
+void arena_init_ex(arena_t* arena, size_t chunk_size, uint8_t flags);
+void* arena_alloc(arena_t* arena, size_t size);
+void* arena_calloc(arena_t* arena, size_t num, size_t size);
+char* arena_strdup(arena_t* arena, const char* str);
+
+// Whether the passed pointer was allocated from the arena (and so must not be passed to free())
+bool arena_owns(const arena_t* arena, const void* ptr);
+
+// Free all memory allocated from the arena - the arena can then be reused
+void arena_release(arena_t* arena);
+
+#endif /* UTILS_ARENA_H_ */
@@ -1,9 +1,11 @@
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include <freertos/task.h>
 
 #include "event.h"
 #include "jade_assert.h"
+#include "perf.h"
 #include "utils/malloc_ext.h"
 
 ESP_EVENT_DEFINE_BASE(JADE_EVENT);
@@ -51,6 +53,17 @@ void free_wait_event_data(wait_event_data_t* data)
     free(data);
 }
 
+// Discard any event already triggered but not yet awaited - eg. before reusing the event-data
+void reset_wait_event_data(wait_event_data_t* data)
+{
+    JADE_ASSERT(data);
+
+    xSemaphoreTake(data->triggered, 0);
+    data->trigger_event_base = NULL;
+    data->trigger_event_id = 0;
+    data->trigger_event_data = NULL;
+}
+
 // Handler called by the event loop if the event fires
 void sync_wait_event_handler(void* handler_arg, esp_event_base_t base, int32_t id, void* event_data)
 {
@@ -79,16 +92,20 @@ esp_err_t sync_wait_event(esp_event_base_t event_base, int32_t event_id, wait_ev
     wait_event_data->register_event_id = event_id;
 
     JADE_LOGD("Awaiting event %s/%lu (%p) (timeout = %lu)", event_base, event_id, wait_event_data, max_wait);
+    // NOTE: time spent awaiting events (eg. user input) is not counted as request processing time
+    const int64_t wait_start_us = esp_timer_get_time();
     if (!max_wait) {
         while (xSemaphoreTake(wait_event_data->triggered, portMAX_DELAY) != pdTRUE) {
             // wait for the event to be triggered
         }
     } else {
         if (xSemaphoreTake(wait_event_data->triggered, max_wait) != pdTRUE) {
+            perf_add_user_wait(esp_timer_get_time() - wait_start_us);
             JADE_LOGD("Event %s/%lu (%p) timed-out", event_base, event_id, wait_event_data);
             return ESP_NO_EVENT;
         }
     }
+    perf_add_user_wait(esp_timer_get_time() - wait_start_us);
 
     // ESP_OK means the event was fired, so copy the ids into the output params
     JADE_LOGD("Event %s/%lu (%p) received in waiting task", event_base, event_id, wait_event_data);
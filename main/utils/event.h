@@ -21,6 +21,7 @@ void sync_wait_event_handler(void* handler_arg, esp_event_base_t base, int32_t i
 
 wait_event_data_t* make_wait_event_data(void);
 void free_wait_event_data(wait_event_data_t* data);
+void reset_wait_event_data(wait_event_data_t* data);
 
 // This function waits for the passed event to be triggered.
 // NOTE: DOES NOT register the event handler - assumes it is already registered.
@@ -3,6 +3,7 @@
 #include "jade_wally_verify.h"
 #include "keychain.h"
 #include "sensitive.h"
+#include "trace.h"
 #include "utils/network.h"
 #include "utils/util.h"
 
@@ -362,8 +363,10 @@ static void wallet_get_privkey(const uint32_t* path, const size_t path_len, uint
 
     struct ext_key derived;
     SENSITIVE_PUSH(&derived, sizeof(derived));
+    JADE_TRACE_BEGIN("bip32_derive_priv");
     JADE_WALLY_VERIFY(bip32_key_from_parent_path(
         &(keychain_get()->xpriv), path, path_len, BIP32_FLAG_KEY_PRIVATE | BIP32_FLAG_SKIP_HASH, &derived));
+    JADE_TRACE_END("bip32_derive_priv");
 
     memcpy(output, derived.priv_key + 1, output_len);
     SENSITIVE_POP(&derived);
@@ -906,6 +909,7 @@ bool wallet_sign_tx_input_hash(const uint8_t* signature_hash, const size_t signa
     wallet_get_privkey(path, path_len, privkey, sizeof(privkey));
 
     // Generate signature as appropriate
+    JADE_TRACE_BEGIN("ec_sign");
     int wret;
     if (ae_host_entropy) {
         // Anti-Exfil signature
@@ -916,6 +920,7 @@ bool wallet_sign_tx_input_hash(const uint8_t* signature_hash, const size_t signa
         wret = wally_ec_sig_from_bytes(privkey, sizeof(privkey), signature_hash, signature_hash_len,
             EC_FLAG_ECDSA | EC_FLAG_GRIND_R, signature, sizeof(signature));
     }
+    JADE_TRACE_END("ec_sign");
     SENSITIVE_POP(privkey);
 
     if (wret != WALLY_OK) {
@@ -944,8 +949,10 @@ bool wallet_get_tx_input_hash(struct wally_tx* tx, const size_t index, const boo
 
     // Generate the btc signature hash to sign
     const size_t hash_flags = is_witness ? WALLY_TX_FLAG_USE_WITNESS : 0;
+    JADE_TRACE_BEGIN("tx_sighash");
     const int wret = wally_tx_get_btc_signature_hash(
         tx, index, script, script_len, satoshi, sighash, hash_flags, output, output_len);
+    JADE_TRACE_END("tx_sighash");
     if (wret != WALLY_OK) {
         JADE_LOGE("Failed to get btc signature hash, error %d", wret);
         return false;
@@ -964,8 +971,10 @@ bool wallet_get_elements_tx_input_hash(struct wally_tx* tx, const size_t index,
 
     // Generate the elements signature hash to sign
     const size_t hash_flags = is_witness ? WALLY_TX_FLAG_USE_WITNESS : 0;
+    JADE_TRACE_BEGIN("tx_sighash");
     const int wret = wally_tx_get_elements_signature_hash(
         tx, index, script, script_len, satoshi, satoshi_len, sighash, hash_flags, output, output_len);
+    JADE_TRACE_END("tx_sighash");
     if (wret != WALLY_OK) {
         JADE_LOGE("Failed to get elements signature hash, error %d", wret);
         return false;
@@ -1211,6 +1220,7 @@ bool wallet_sign_message_hash(const uint8_t* signature_hash, const size_t signat
     wallet_get_privkey(path, path_len, privkey, sizeof(privkey));
 
     // Generate signature as appropriate
+    JADE_TRACE_BEGIN("ec_sign");
     int wret;
     uint8_t signature[EC_SIGNATURE_RECOVERABLE_LEN];
     size_t signature_len = 0;
@@ -1225,6 +1235,7 @@ bool wallet_sign_message_hash(const uint8_t* signature_hash, const size_t signat
         wret = wally_ec_sig_from_bytes(privkey, sizeof(privkey), signature_hash, signature_hash_len,
             EC_FLAG_ECDSA | EC_FLAG_RECOVERABLE, signature, signature_len);
     }
+    JADE_TRACE_END("ec_sign");
     SENSITIVE_POP(privkey);
 
     if (wret != WALLY_OK) {
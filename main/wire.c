@@ -6,16 +6,22 @@
 #include <cbor.h>
 #include <esp_ota_ops.h>
 #include <esp_system.h>
+#include <esp_timer.h>
 
 #include "idletimer.h"
 #include "jade_assert.h"
 #include "keychain.h"
+#include "perf.h"
 #include "random.h"
+#include "trace.h"
 #include "utils/cbor_rpc.h"
 
 // 2s 'no activity' stale message timeout
 static const TickType_t TIMEOUT_TICKS = 2000 / portTICK_PERIOD_MS;
 
+// When the first data of the message currently being received arrived, per source
+static int64_t message_start_us[SOURCE_BLE + 1];
+
 // Macros for use in handle_data() as always called with fixed params
 #define SEND_REJECT_MSG(code, msg, rejectedlen)                                                                        \
     do {                                                                                                               \
@@ -78,6 +84,8 @@ static void handle_data_impl(
         } else {
             // Push to task queue for dashboard to handle
             if (jade_process_push_in_message(full_data_in, msg_len + 1)) {
+                perf_message_received(message_start_us[source]);
+
                 // Valid message arrival counts as 'activity' against idle timeout
                 // (but not as 'UI' activity - ie. keep jade on but do not stop the screen from turning off)
                 idletimer_register_activity(false);
@@ -133,12 +141,21 @@ void handle_data(uint8_t* full_data_in, size_t* read_ptr, const size_t new_data_
         memmove(data_in, data_in + initial_offset, new_data_len);
     }
 
+    // Note when the first data of a new message arrives
+    const jade_msg_source_t source = full_data_in[0];
+    JADE_ASSERT(source < sizeof(message_start_us) / sizeof(message_start_us[0]));
+    if (*read_ptr == 0) {
+        message_start_us[source] = esp_timer_get_time();
+    }
+
     // Append new bytes, and try to parse
     const size_t initial_offset = *read_ptr;
     *read_ptr += new_data_len;
     JADE_LOGD("Passing %u bytes to common handler", *read_ptr);
     const bool reject_if_no_msg = force_reject_if_no_msg || (*read_ptr == MAX_INPUT_MSG_SIZE);
+    JADE_TRACE_BEGIN("wire_frame");
     handle_data_impl(full_data_in, initial_offset, read_ptr, reject_if_no_msg, data_out);
+    JADE_TRACE_END("wire_frame");
 
     // Update caller's 'last processing time'
     *last_processing_time = time_now;
@@ -6,6 +6,7 @@ import copy
 import json
 import base64
 import random
+import zlib
 import logging
 import argparse
 import subprocess
@@ -155,7 +156,7 @@ PINSERVER_DEFAULT_URL = "https://jadepin.blockstream.com"
 PINSERVER_DEFAULT_ONION = "http://mrrxtq6tjpbnbm7vh5jt6mpjctn7ggyfy5wegvbeff3x7jrznqawlmid.onion"
 
 # The number of values expected back in version info
-NUM_VALUES_VERINFO = 19
+NUM_VALUES_VERINFO = 20
 
 TEST_MNEMONIC = 'fish inner face ginger orchard permit useful method fence \
 kidney chuckle party favorite sunset draw limb science crane oval letter \
@@ -743,7 +744,8 @@ def test_unexpected_method(jade):
                   ('protocol4', 'ota_complete'),
                   ('protocol5', 'tx_input'),
                   ('protocol6', 'get_signature'),
-                  ('protocol7', 'get_extended_data')]
+                  ('protocol7', 'get_extended_data'),
+                  ('protocol8', 'ota_resume')]
 
     for args in unexpected:
         request = jade.build_request(*args)
@@ -870,6 +872,9 @@ epTxUQUB5kM5nxkEtr2SNic6PJLPubcGMR6S2fmDZTzL9dHpU7ka",
                     {'fwsize': 1234, 'cmpsize': 1234}), 'Bad filesize parameters'),
                   (('badota6', 'ota',  # hash unexpected size
                     {'fwsize': 1234, 'cmpsize': 1111, 'cmphash': b'123'}), 'extract valid fw hash'),
+                  (('badota7', 'ota',  # zero window rejected
+                    {'fwsize': 1234, 'cmpsize': 1111, 'cmphash': bytes(32),
+                     'window': 0}), 'Invalid upload window size'),
                   (('badota_delta1', 'ota_delta'), ''),
                   (('badota_delta2', 'ota_delta', {'fwsize': 12345}), 'Bad filesize parameters'),
                   (('badota_delta3', 'ota_delta',
@@ -881,6 +886,9 @@ epTxUQUB5kM5nxkEtr2SNic6PJLPubcGMR6S2fmDZTzL9dHpU7ka",
                   (('badota_delta6', 'ota_delta',  # hash unexpected size
                       {'fwsize': 1234, 'cmpsize': 1111,
                        'patchsize': 1200, 'cmphash': b'123'}), 'extract valid fw hash'),
+                  (('badota_delta7', 'ota_delta',  # zero window rejected
+                      {'fwsize': 1234, 'cmpsize': 1111, 'patchsize': 1200,
+                       'cmphash': bytes(32), 'window': 0}), 'Invalid upload window size'),
 
                   (('badxpub1', 'get_xpub'), 'Expecting parameters map'),
                   (('badxpub2', 'get_xpub',
@@ -1719,6 +1727,88 @@ ddab03ecc4ae0b5e77c4fc0e5cf6c95a0100000000000f4240000000000000')
         _test_bad_params(jade, badinput, errormsg)
 
 
+# After an ota upload is abandoned, skip the replies to any chunks which were still in flight
+# (rejected by the dashboard as unexpected) until the reply to a marker message is received.
+def _ota_resync(jade, marker_id):
+    jade.write_request(jade.build_request(marker_id, 'get_version_info'))
+    while True:
+        # Long timeout, as the hw shows the upload error before returning to the dashboard
+        reply = jade.read_response(long_timeout=True)
+        if reply['id'] == marker_id:
+            assert 'error' not in reply
+            return
+        assert reply['error']['code'] == JadeError.PROTOCOL_ERROR
+
+
+# A (bogus) firmware image which compresses to several small chunks - it is
+# only rejected once the hw has decompressed enough of it to check the header.
+def _bogus_ota_firmware():
+    fw = bytes(256 * 1024)
+    return zlib.compress(fw, 9), len(fw), bytes(wally.sha256(fw))
+
+
+def test_ota_windowed(jadeapi, max_window):
+    fwcmp, fwlen, fwhash = _bogus_ota_firmware()
+    chunksize = 32
+    assert len(fwcmp) > max_window * chunksize
+
+    # A window larger than the hw supports is rejected up-front
+    try:
+        jadeapi.ota_update(fwcmp, fwlen, chunksize, fwhash, window=max_window + 1)
+        assert False, "Expected exception from oversized ota window"
+    except JadeError as err:
+        assert err.code == JadeError.BAD_PARAMETERS
+        assert err.message == 'Invalid upload window size'
+
+    # Windows of several chunks are accepted, and the in-flight chunks are processed
+    # in sequence until the image itself is rejected (rather than the chunks).
+    for window in [2, max_window]:
+        try:
+            jadeapi.ota_update(fwcmp, fwlen, chunksize, fwhash, window=window)
+            assert False, "Expected exception uploading bogus firmware"
+        except JadeError as err:
+            assert err.code == JadeError.INTERNAL_ERROR
+            assert err.message == 'Error uploading OTA data'
+            assert err.data in [b'ERROR_INVALIDFW', b'ERROR_DECOMPRESS']
+
+        _ota_resync(jadeapi.jade, f'ota_window_{window}')
+
+
+def _ota_resume_rpc(jade, reqid, params):
+    return jade.make_rpc_call(jade.build_request(reqid, 'ota_resume', params))
+
+
+def test_ota_resume(jade):
+    fwcmp, fwlen, fwhash = _bogus_ota_firmware()
+    for window in [None, 2]:
+        params = {'fwsize': fwlen, 'cmpsize': len(fwcmp), 'fwhash': fwhash}
+        if window:
+            params['window'] = window
+
+        reply = jade.make_rpc_call(jade.build_request('ota_start', 'ota', params))
+        assert reply['result'] is True
+
+        # Resume with matching params returns the offset reached (repeatedly)
+        for i in range(2):
+            reply = _ota_resume_rpc(jade, f'ota_resume{i}', params)
+            assert 'error' not in reply
+            assert reply['result'] == 0
+
+        # Resume with mismatched params is rejected, and the upload abandoned
+        mismatched = params.copy()
+        mismatched['cmpsize'] += 1
+        reply = _ota_resume_rpc(jade, 'ota_mismatch', mismatched)
+        error = reply['error']
+        assert error['code'] == JadeError.INTERNAL_ERROR
+        assert error['message'] == 'Error uploading OTA data'
+        assert error['data'] == b'ERROR_BADDATA'
+        _ota_resync(jade, f'ota_resume_{window}')
+
+        # Then there is no upload to resume
+        reply = _ota_resume_rpc(jade, 'ota_resume', params)
+        assert reply['error']['code'] == JadeError.PROTOCOL_ERROR
+
+
 def _set_wallet(jade, mnemonic=TEST_MNEMONIC, passphrase=None):
     # Set mnemonic
     request = jade.build_request("id_mnem", "debug_set_mnemonic",
@@ -2854,6 +2944,40 @@ NBVGY3TQOJQGEZDGNBVGY3TQOJQGEZDGNA&digits=8&algorithm=SHA512'
         assert rslt == expected
 
 
+def test_get_trace(jadeapi):
+    jadeapi.get_version_info()
+    trace = jadeapi.get_trace()
+    assert trace['tasks'] and trace['events']
+    for ts, task, core, phase, name in trace['events']:
+        assert task <= len(trace['tasks'])
+        assert phase in ['B', 'E']
+    names = {event[4] for event in trace['events']}
+    assert {'wire_frame', 'get_version_info', 'reply_send'} <= names
+
+    chrome = jadeapi.trace_to_chrome(trace)
+    assert any(event['name'] == 'get_version_info' and event['ph'] == 'E' for event in chrome['traceEvents'])
+
+    # Fetching the trace clears it
+    trace = jadeapi.get_trace()
+    assert 'get_version_info' not in {event[4] for event in trace['events']}
+
+
+def test_get_perf_stats(jadeapi):
+    rslt = jadeapi.get_perf_stats()
+    assert rslt.keys() == {'uptime_ms', 'methods', 'heap', 'stack_hwm', 'ringbuffers'}
+    assert 0 < len(rslt['methods']) <= 12
+    for stats in rslt['methods'].values():
+        assert stats['calls'] > 0
+        assert len(stats['compute_hist']) == 7
+        assert sum(stats['compute_hist']) == stats['calls']
+    assert rslt['heap']['dram_min_free'] <= rslt['heap']['dram_free']
+    assert len(rslt['stack_hwm']) > 0
+    assert rslt['ringbuffers']['shared_in']['peak'] > 0
+
+    # Check the pretty-printer copes with the reply
+    assert jadeapi.format_perf_stats(rslt)
+
+
 def run_api_tests(jadeapi, isble, qemu, authuser=False):
 
     rslt = jadeapi.clean_reset()
@@ -2893,6 +3017,11 @@ def run_api_tests(jadeapi, isble, qemu, authuser=False):
     assert startinfo['JADE_STATE'] == 'READY'
     jadeapi.logout()
     assert jadeapi.get_version_info()['JADE_STATE'] in ['LOCKED', 'UNINIT']
+    try:
+        jadeapi.get_perf_stats()
+        assert False, "Expected exception fetching perf stats when locked"
+    except JadeError as err:
+        assert err.code == JadeError.HW_LOCKED
     rslt = jadeapi.set_mnemonic(TEST_MNEMONIC)
     assert jadeapi.get_version_info()['JADE_STATE'] == "READY"
 
@@ -2956,6 +3085,9 @@ def run_api_tests(jadeapi, isble, qemu, authuser=False):
     test_totp(jadeapi)
     test_totp_ex(jadeapi)
 
+    # Perf telemetry
+    test_get_perf_stats(jadeapi)
+
     # restore the mnemonic
     rslt = jadeapi.set_mnemonic(TEST_MNEMONIC)
     assert rslt is True
@@ -3000,6 +3132,9 @@ def run_interface_tests(jadeapi,
         logger.info('selfcheck time: ' + str(time_ms) + 'ms')
         assert qemu or time_ms < 82500
 
+        # Check the timeline trace holds the messages just handled
+        test_get_trace(jadeapi)
+
         # Test good pinserver handshake, and also 'bad sig' pinserver
         test_handshake(jadeapi.jade)
         test_handshake_bad_sig(jadeapi.jade)
@@ -3033,6 +3168,8 @@ def run_interface_tests(jadeapi,
         test_unexpected_method(jadeapi.jade)
         test_bad_params(jadeapi.jade)
         test_bad_params_liquid(jadeapi.jade, has_psram, has_ble)
+        test_ota_windowed(jadeapi, startinfo['JADE_OTA_MAX_WINDOW'])
+        test_ota_resume(jadeapi.jade)
 
     time.sleep(5)  # Lets idle tasks clean up
     endinfo = jadeapi.get_version_info()
@@ -3097,6 +3234,32 @@ def mixed_sources_test(jade1, jade2):
     assert rslt == expected
 
 
+# Test that an ota upload started over one connection cannot be resumed over the other
+def mixed_sources_ota_resume_test(jade1, jade2):
+    jade1.set_mnemonic(TEST_MNEMONIC)
+
+    fwcmp, fwlen, fwhash = _bogus_ota_firmware()
+    params = {'fwsize': fwlen, 'cmpsize': len(fwcmp), 'fwhash': fwhash}
+    reply = jade1.jade.make_rpc_call(jade1.jade.build_request('ota_start', 'ota', params))
+    assert reply['result'] is True
+
+    # jade2 is rejected, and the upload is unaffected
+    reply = _ota_resume_rpc(jade2.jade, 'ota_other', params)
+    error = reply['error']
+    assert error['code'] == JadeError.PROTOCOL_ERROR
+    assert error['message'] == 'Upload in progress from another source'
+
+    # jade1 can still resume the upload
+    reply = _ota_resume_rpc(jade1.jade, 'ota_resume', params)
+    assert 'error' not in reply
+    assert reply['result'] == 0
+
+    # Abandon the upload by sending unexpected data
+    reply = _ota_resume_rpc(jade1.jade, 'ota_abandon', {})
+    assert reply['error']['message'] == 'Error uploading OTA data'
+    _ota_resync(jade1.jade, 'ota_mixed')
+
+
 # Run all selected tests over all selected backends (serial/ble)
 def run_all_jade_tests(info, args):
     logger.info("Running Jade tests over selected backend interfaces")
@@ -3122,6 +3285,7 @@ def run_all_jade_tests(info, args):
                     with JadeAPI.create_serial(args.serialport,
                                                timeout=args.serialtimeout) as jadeserial:
                         mixed_sources_test(jadeserial, jade)
+                        mixed_sources_ota_resume_test(jadeserial, jade)
         else:
             msg = "Skipping BLE tests - not enabled on the hardware"
             logger.warning(msg)
@@ -184,7 +184,8 @@ def ota(jade, verinfo, fwcompressed, fwlength, fwhash, patchlen=None):
     print('Please approve the firmware update on the Jade device')
     try:
         result = jade.ota_update(fwcompressed, fwlength, chunksize, fwhash,
-                                 patchlen=patchlen, cb=_log_progress)
+                                 patchlen=patchlen, cb=_log_progress,
+                                 window=verinfo.get('JADE_OTA_MAX_WINDOW'))
         assert result is True
         print(f'Total OTA time: {time.time() - start_time}s')
     except JadeError as err: